@@ -0,0 +1,113 @@
+package com.codeminders.hidapi.bench;
+
+import java.io.IOException;
+import java.util.concurrent.TimeUnit;
+
+import org.openjdk.jmh.annotations.Benchmark;
+import org.openjdk.jmh.annotations.BenchmarkMode;
+import org.openjdk.jmh.annotations.Fork;
+import org.openjdk.jmh.annotations.Measurement;
+import org.openjdk.jmh.annotations.Mode;
+import org.openjdk.jmh.annotations.OutputTimeUnit;
+import org.openjdk.jmh.annotations.Scope;
+import org.openjdk.jmh.annotations.Setup;
+import org.openjdk.jmh.annotations.State;
+import org.openjdk.jmh.annotations.TearDown;
+import org.openjdk.jmh.annotations.Warmup;
+
+import com.codeminders.hidapi.HIDDevice;
+import com.codeminders.hidapi.HIDManager;
+
+/**
+ * The fixed cost of crossing into the native library: a call which does
+ * next to nothing, the string getters, and the calls which end in an
+ * exception.
+ */
+@BenchmarkMode(Mode.AverageTime)
+@OutputTimeUnit(TimeUnit.NANOSECONDS)
+@Warmup(iterations = 3, time = 1)
+@Measurement(iterations = 5, time = 1)
+@Fork(1)
+@State(Scope.Thread)
+public class CallBenchmark
+{
+    private HIDManager manager;
+    private HIDDevice device;
+    private HIDDevice closed;
+
+    private final byte[] empty = new byte[0];
+    private final byte[] buf = new byte[64];
+
+    @Setup
+    public void setUp() throws IOException
+    {
+        MockBackend.setUp(2, 64);
+        manager = HIDManager.getInstance();
+        device = manager.openByPath("mock:0");
+        closed = manager.openByPath("mock:1");
+        closed.close();
+    }
+
+    @TearDown
+    public void tearDown() throws IOException
+    {
+        device.close();
+    }
+
+    /* Reads a counter; the baseline for the other calls. */
+    @Benchmark
+    public long droppedCount() throws IOException
+    {
+        return device.getDroppedCount();
+    }
+
+    @Benchmark
+    public String manufacturerString() throws IOException
+    {
+        return device.getManufacturerString();
+    }
+
+    @Benchmark
+    public String productString() throws IOException
+    {
+        return device.getProductString();
+    }
+
+    @Benchmark
+    public String serialNumberString() throws IOException
+    {
+        return device.getSerialNumberString();
+    }
+
+    @Benchmark
+    public String indexedString() throws IOException
+    {
+        return device.getIndexedString(1);
+    }
+
+    /* Fails in the JNI layer, before the backend is called. */
+    @Benchmark
+    public Object readClosed()
+    {
+        try
+        {
+            return closed.read(buf);
+        } catch(IOException e)
+        {
+            return e;
+        }
+    }
+
+    /* Fails in the backend; the message comes from hid_error(). */
+    @Benchmark
+    public Object writeFailed()
+    {
+        try
+        {
+            return device.write(empty);
+        } catch(IOException e)
+        {
+            return e;
+        }
+    }
+}
@@ -0,0 +1,61 @@
+package com.codeminders.hidapi.bench;
+
+import java.io.IOException;
+import java.util.concurrent.TimeUnit;
+
+import org.openjdk.jmh.annotations.Benchmark;
+import org.openjdk.jmh.annotations.BenchmarkMode;
+import org.openjdk.jmh.annotations.Fork;
+import org.openjdk.jmh.annotations.Measurement;
+import org.openjdk.jmh.annotations.Mode;
+import org.openjdk.jmh.annotations.OutputTimeUnit;
+import org.openjdk.jmh.annotations.Param;
+import org.openjdk.jmh.annotations.Scope;
+import org.openjdk.jmh.annotations.Setup;
+import org.openjdk.jmh.annotations.State;
+import org.openjdk.jmh.annotations.Warmup;
+
+import com.codeminders.hidapi.HIDDevice;
+import com.codeminders.hidapi.HIDDeviceInfo;
+import com.codeminders.hidapi.HIDManager;
+
+/**
+ * Listing devices, which builds a HIDDeviceInfo and its strings for each
+ * device, and opening one of them.
+ */
+@BenchmarkMode(Mode.AverageTime)
+@OutputTimeUnit(TimeUnit.MICROSECONDS)
+@Warmup(iterations = 3, time = 1)
+@Measurement(iterations = 5, time = 1)
+@Fork(1)
+@State(Scope.Thread)
+public class EnumerationBenchmark
+{
+    @Param({"1", "16", "256"})
+    public int devices;
+
+    private HIDManager manager;
+    private HIDDeviceInfo info;
+
+    @Setup
+    public void setUp() throws IOException
+    {
+        MockBackend.setUp(devices, 64);
+        manager = HIDManager.getInstance();
+        info = manager.listDevices()[0];
+    }
+
+    @Benchmark
+    public HIDDeviceInfo[] listDevices() throws IOException
+    {
+        return manager.listDevices();
+    }
+
+    @Benchmark
+    public HIDDevice openClose() throws IOException
+    {
+        HIDDevice device = info.open();
+        device.close();
+        return device;
+    }
+}
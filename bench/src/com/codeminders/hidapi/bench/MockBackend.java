@@ -0,0 +1,40 @@
+package com.codeminders.hidapi.bench;
+
+/**
+ * Loads the in-memory HID implementation in <code>mock/</code> in place
+ * of the real one, so the benchmarks need no devices and give the same
+ * results on every run. The library is named by the system property
+ * <code>hidapi.mock.library</code>, which the <code>bench</code> target
+ * in build.xml sets.
+ */
+final class MockBackend
+{
+    private static boolean loaded = false;
+
+    private MockBackend()
+    {
+    }
+
+    /**
+     * Load the library once and set up the devices. Must be called
+     * before the first use of <code>HIDManager</code>.
+     *
+     * @param devices the number of devices listDevices() returns
+     * @param reportSize the size of every Input report
+     */
+    static synchronized void setUp(int devices, int reportSize)
+    {
+        if(!loaded)
+        {
+            String library = System.getProperty("hidapi.mock.library");
+            if(library == null)
+                throw new IllegalStateException("hidapi.mock.library is not set");
+            System.load(library);
+            loaded = true;
+        }
+        configure(devices, reportSize, 0);
+    }
+
+    /* In mock/mock-control.cpp. A rate of 0 has a report always ready. */
+    private static native void configure(int devices, int reportSize, int rate);
+}
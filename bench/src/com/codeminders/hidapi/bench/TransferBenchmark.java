@@ -0,0 +1,132 @@
+package com.codeminders.hidapi.bench;
+
+import java.io.IOException;
+import java.nio.ByteBuffer;
+import java.util.concurrent.TimeUnit;
+
+import org.openjdk.jmh.annotations.Benchmark;
+import org.openjdk.jmh.annotations.BenchmarkMode;
+import org.openjdk.jmh.annotations.Fork;
+import org.openjdk.jmh.annotations.Measurement;
+import org.openjdk.jmh.annotations.Mode;
+import org.openjdk.jmh.annotations.OutputTimeUnit;
+import org.openjdk.jmh.annotations.Param;
+import org.openjdk.jmh.annotations.Scope;
+import org.openjdk.jmh.annotations.Setup;
+import org.openjdk.jmh.annotations.State;
+import org.openjdk.jmh.annotations.TearDown;
+import org.openjdk.jmh.annotations.Warmup;
+
+import com.codeminders.hidapi.HIDDevice;
+import com.codeminders.hidapi.HIDManager;
+
+/**
+ * Moving reports through arrays, heap buffers and direct buffers. The
+ * mock device always has an Input report ready, so a read is the cost
+ * of the copy and the crossing.
+ */
+@BenchmarkMode(Mode.AverageTime)
+@OutputTimeUnit(TimeUnit.NANOSECONDS)
+@Warmup(iterations = 3, time = 1)
+@Measurement(iterations = 5, time = 1)
+@Fork(1)
+@State(Scope.Thread)
+public class TransferBenchmark
+{
+    private static final int MANY = 16;
+
+    @Param({"8", "64", "1024"})
+    public int reportSize;
+
+    private HIDDevice device;
+
+    private byte[] array;
+    private byte[] region;
+    private ByteBuffer heap;
+    private ByteBuffer direct;
+    private ByteBuffer many;
+
+    @Setup
+    public void setUp() throws IOException
+    {
+        MockBackend.setUp(1, reportSize);
+        device = HIDManager.getInstance().openByPath("mock:0");
+
+        array = new byte[reportSize];
+        region = new byte[reportSize + 16];
+        heap = ByteBuffer.allocate(reportSize);
+        direct = ByteBuffer.allocateDirect(reportSize);
+        many = ByteBuffer.allocateDirect(MANY * (reportSize + 2));
+    }
+
+    @TearDown
+    public void tearDown() throws IOException
+    {
+        device.close();
+    }
+
+    @Benchmark
+    public int readArray() throws IOException
+    {
+        return device.read(array);
+    }
+
+    @Benchmark
+    public int readArrayRegion() throws IOException
+    {
+        return device.read(region, 8, reportSize);
+    }
+
+    @Benchmark
+    public int readHeapBuffer() throws IOException
+    {
+        heap.clear();
+        return device.read(heap);
+    }
+
+    @Benchmark
+    public int readDirectBuffer() throws IOException
+    {
+        direct.clear();
+        return device.read(direct);
+    }
+
+    @Benchmark
+    public int readMany() throws IOException
+    {
+        many.clear();
+        return device.readMany(many, MANY, 0);
+    }
+
+    @Benchmark
+    public int writeArray() throws IOException
+    {
+        return device.write(array);
+    }
+
+    @Benchmark
+    public int writeHeapBuffer() throws IOException
+    {
+        heap.clear();
+        return device.write(heap);
+    }
+
+    @Benchmark
+    public int writeDirectBuffer() throws IOException
+    {
+        direct.clear();
+        return device.write(direct);
+    }
+
+    @Benchmark
+    public int sendFeatureReport() throws IOException
+    {
+        return device.sendFeatureReport(array);
+    }
+
+    @Benchmark
+    public int getFeatureReport() throws IOException
+    {
+        return device.getFeatureReport(array);
+    }
+}
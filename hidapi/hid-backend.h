@@ -0,0 +1,189 @@
+/*******************************************************
+ HIDAPI - Multi-Platform library for
+ communication with HID devices.
+
+ Building several implementations into one library.
+
+ At the discretion of the user of this library,
+ this software may be licensed under the terms of the
+ GNU Public License v3, a BSD-Style license, or the
+ original HIDAPI license as outlined in the LICENSE.txt,
+ LICENSE-gpl3.txt, LICENSE-bsd.txt, and LICENSE-orig.txt
+ files located at the root of the source distribution.
+ These files may also be found in the public source
+ code repository located at:
+        http://github.com/signal11/hidapi .
+********************************************************/
+
+/* An implementation includes this in place of hidapi.h. Built as is,
+   it defines the hidapi.h functions, as before.
+
+   Built with -DHID_BACKEND=name, every function it defines is renamed
+   from hid_xxx to hid_name_xxx, and HID_BACKEND_TABLE() at its end
+   gathers them in hid_name_backend. linux/hid-backends.c then defines
+   the hidapi.h functions, and calls the implementation which made the
+   device, or the one selected with hid_set_backend().
+
+   For that, the implementation's struct hid_device_, struct
+   hid_reactor_ and struct hid_hotplug_ start with HID_BACKEND_HEADER,
+   which HID_BACKEND_INIT() sets when one is made. */
+
+#ifndef HID_BACKEND_H__
+#define HID_BACKEND_H__
+
+#ifdef HID_BACKEND
+
+#define HID_BACKEND_PASTE_(backend, name) hid_##backend##_##name
+#define HID_BACKEND_PASTE(backend, name) HID_BACKEND_PASTE_(backend, name)
+#define HID_BACKEND_NAME(name) HID_BACKEND_PASTE(HID_BACKEND, name)
+
+/* The structures are different in each implementation. */
+#define hid_device_ HID_BACKEND_NAME(device_)
+#define hid_reactor_ HID_BACKEND_NAME(reactor_)
+#define hid_hotplug_ HID_BACKEND_NAME(hotplug_)
+
+#define hid_init HID_BACKEND_NAME(init)
+#define hid_exit HID_BACKEND_NAME(exit)
+#define hid_set_io_engine HID_BACKEND_NAME(set_io_engine)
+#define hid_set_backend HID_BACKEND_NAME(set_backend)
+#define hid_get_backend HID_BACKEND_NAME(get_backend)
+#define hid_enumerate_backend HID_BACKEND_NAME(enumerate_backend)
+#define hid_open_path_backend HID_BACKEND_NAME(open_path_backend)
+#define hid_get_device_backend HID_BACKEND_NAME(get_device_backend)
+#define hid_enumerate HID_BACKEND_NAME(enumerate)
+#define hid_free_enumeration HID_BACKEND_NAME(free_enumeration)
+#define hid_open HID_BACKEND_NAME(open)
+#define hid_open_path HID_BACKEND_NAME(open_path)
+#define hid_write HID_BACKEND_NAME(write)
+#define hid_read_timeout HID_BACKEND_NAME(read_timeout)
+#define hid_read HID_BACKEND_NAME(read)
+#define hid_read_timestamped HID_BACKEND_NAME(read_timestamped)
+#define hid_read_sequenced HID_BACKEND_NAME(read_sequenced)
+#define hid_get_dropped_count HID_BACKEND_NAME(get_dropped_count)
+#define hid_get_stats HID_BACKEND_NAME(get_stats)
+#define hid_get_latency_histogram HID_BACKEND_NAME(get_latency_histogram)
+#define hid_read_many HID_BACKEND_NAME(read_many)
+#define hid_get_poll_fd HID_BACKEND_NAME(get_poll_fd)
+#define hid_reactor_create HID_BACKEND_NAME(reactor_create)
+#define hid_reactor_create_backend HID_BACKEND_NAME(reactor_create_backend)
+#define hid_reactor_add HID_BACKEND_NAME(reactor_add)
+#define hid_reactor_remove HID_BACKEND_NAME(reactor_remove)
+#define hid_reactor_wait HID_BACKEND_NAME(reactor_wait)
+#define hid_reactor_destroy HID_BACKEND_NAME(reactor_destroy)
+#define hid_hotplug_create HID_BACKEND_NAME(hotplug_create)
+#define hid_hotplug_wait HID_BACKEND_NAME(hotplug_wait)
+#define hid_hotplug_destroy HID_BACKEND_NAME(hotplug_destroy)
+#define hid_set_nonblocking HID_BACKEND_NAME(set_nonblocking)
+#define hid_set_input_queue HID_BACKEND_NAME(set_input_queue)
+#define hid_set_input_transfers HID_BACKEND_NAME(set_input_transfers)
+#define hid_set_input_ring HID_BACKEND_NAME(set_input_ring)
+#define hid_input_ring_wait HID_BACKEND_NAME(input_ring_wait)
+#define hid_input_ring_read HID_BACKEND_NAME(input_ring_read)
+#define hid_send_feature_report HID_BACKEND_NAME(send_feature_report)
+#define hid_get_feature_report HID_BACKEND_NAME(get_feature_report)
+#define hid_close HID_BACKEND_NAME(close)
+#define hid_get_manufacturer_string HID_BACKEND_NAME(get_manufacturer_string)
+#define hid_get_product_string HID_BACKEND_NAME(get_product_string)
+#define hid_get_serial_number_string HID_BACKEND_NAME(get_serial_number_string)
+#define hid_get_indexed_string HID_BACKEND_NAME(get_indexed_string)
+#define hid_error HID_BACKEND_NAME(error)
+
+#endif
+
+#include "hidapi.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* The functions of one implementation. Seen from hid-backends.c, the
+   devices, reactors and hotplug monitors are its own struct
+   hid_device_, struct hid_reactor_ and struct hid_hotplug_, which are
+   HID_BACKEND_HEADER alone. */
+struct hid_backend {
+	const char *name;
+
+	int (*init)(void);
+	int (*exit)(void);
+	int (*set_io_engine)(int engine);
+	struct hid_device_info *(*enumerate)(unsigned short vendor_id, unsigned short product_id);
+	void (*free_enumeration)(struct hid_device_info *devs);
+	hid_device *(*open)(unsigned short vendor_id, unsigned short product_id, const wchar_t *serial_number);
+	hid_device *(*open_path)(const char *path);
+	int (*write)(hid_device *device, const unsigned char *data, size_t length);
+	int (*read_timeout)(hid_device *dev, unsigned char *data, size_t length, int milliseconds);
+	int (*read)(hid_device *device, unsigned char *data, size_t length);
+	int (*read_timestamped)(hid_device *device, unsigned char *data, size_t length, unsigned long long *timestamp, int milliseconds);
+	int (*read_sequenced)(hid_device *device, unsigned char *data, size_t length, unsigned long long *sequence, unsigned long long *timestamp, int milliseconds);
+	int (*get_dropped_count)(hid_device *device, unsigned long long *count);
+	int (*get_stats)(hid_device *device, struct hid_device_stats *stats);
+	int (*get_latency_histogram)(hid_device *device, int kind, struct hid_histogram *histogram, int reset);
+	int (*read_many)(hid_device *device, unsigned char *data, size_t *length, int max_reports, int milliseconds);
+	int (*get_poll_fd)(hid_device *device);
+	hid_reactor *(*reactor_create)(void);
+	int (*reactor_add)(hid_reactor *reactor, hid_device *device);
+	int (*reactor_remove)(hid_reactor *reactor, hid_device *device);
+	int (*reactor_wait)(hid_reactor *reactor, hid_device **ready, int max_ready, int milliseconds);
+	void (*reactor_destroy)(hid_reactor *reactor);
+	hid_hotplug *(*hotplug_create)(unsigned short vendor_id, unsigned short product_id);
+	int (*hotplug_wait)(hid_hotplug *hotplug, struct hid_device_info **device, int milliseconds);
+	void (*hotplug_destroy)(hid_hotplug *hotplug);
+	int (*set_nonblocking)(hid_device *device, int nonblock);
+	int (*set_input_queue)(hid_device *device, int capacity, int policy);
+	int (*set_input_transfers)(hid_device *device, int count);
+	int (*set_input_ring)(hid_device *device, struct hid_input_ring *ring, size_t size);
+	int (*input_ring_wait)(hid_device *device, int milliseconds);
+	int (*input_ring_read)(hid_device *device, unsigned char *data, size_t length, unsigned long long *timestamp, int milliseconds);
+	int (*send_feature_report)(hid_device *device, const unsigned char *data, size_t length);
+	int (*get_feature_report)(hid_device *device, unsigned char *data, size_t length);
+	void (*close)(hid_device *device);
+	int (*get_manufacturer_string)(hid_device *device, wchar_t *string, size_t maxlen);
+	int (*get_product_string)(hid_device *device, wchar_t *string, size_t maxlen);
+	int (*get_serial_number_string)(hid_device *device, wchar_t *string, size_t maxlen);
+	int (*get_indexed_string)(hid_device *device, int string_index, wchar_t *string, size_t maxlen);
+	const wchar_t *(*error)(hid_device *device);
+};
+
+extern const struct hid_backend hid_hidraw_backend;
+extern const struct hid_backend hid_libusb_backend;
+extern const struct hid_backend hid_mock_backend;
+
+#ifdef HID_BACKEND
+
+#define HID_BACKEND_HEADER const struct hid_backend *backend;
+#define HID_BACKEND_INIT(p) ((p)->backend = &HID_BACKEND_NAME(backend))
+
+#define HID_BACKEND_STRING_(backend) #backend
+#define HID_BACKEND_STRING(backend) HID_BACKEND_STRING_(backend)
+
+#define HID_BACKEND_TABLE() \
+	const struct hid_backend HID_BACKEND_NAME(backend) = { \
+		HID_BACKEND_STRING(HID_BACKEND), \
+		hid_init, hid_exit, hid_set_io_engine, \
+		hid_enumerate, hid_free_enumeration, hid_open, hid_open_path, \
+		hid_write, hid_read_timeout, hid_read, hid_read_timestamped, \
+		hid_read_sequenced, hid_get_dropped_count, hid_get_stats, \
+		hid_get_latency_histogram, hid_read_many, hid_get_poll_fd, \
+		hid_reactor_create, hid_reactor_add, hid_reactor_remove, \
+		hid_reactor_wait, hid_reactor_destroy, hid_hotplug_create, \
+		hid_hotplug_wait, hid_hotplug_destroy, hid_set_nonblocking, \
+		hid_set_input_queue, hid_set_input_transfers, hid_set_input_ring, \
+		hid_input_ring_wait, hid_input_ring_read, hid_send_feature_report, \
+		hid_get_feature_report, hid_close, hid_get_manufacturer_string, \
+		hid_get_product_string, hid_get_serial_number_string, \
+		hid_get_indexed_string, hid_error, \
+	}
+
+#else
+
+#define HID_BACKEND_HEADER
+#define HID_BACKEND_INIT(p) ((void) 0)
+#define HID_BACKEND_TABLE() extern int hid_backend_unused__
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
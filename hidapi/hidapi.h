@@ -39,11 +39,32 @@
 
 #define HID_API_EXPORT_CALL HID_API_EXPORT HID_API_CALL /**< API export and call macro*/
 
+/** The maximum number of Input transfers a device can keep in
+    flight. See hid_set_input_transfers(). */
+#define HID_MAX_INPUT_TRANSFERS 8
+
+/** Values below twice this many nanoseconds each have a bucket of
+    their own in a latency histogram; above, every power of two is
+    split into this many buckets. See hid_histogram. */
+#define HID_HISTOGRAM_SUB_BUCKETS 32
+
+/** The number of buckets in a latency histogram, covering values up to
+    2^40 ns (about 18 minutes). See hid_histogram. */
+#define HID_HISTOGRAM_BUCKETS 1152
+
+/** The length of a record marking the end of the record area in an
+    input ring: the next record is at its start. See hid_input_record. */
+#define HID_INPUT_RING_WRAP 0xffffffffu
+
 #ifdef __cplusplus
 extern "C" {
 #endif
         struct hid_device_;
         typedef struct hid_device_ hid_device; /**< opaque hidapi structure */
+        struct hid_reactor_;
+        typedef struct hid_reactor_ hid_reactor; /**< opaque reactor structure, see hid_reactor_create() */
+        struct hid_hotplug_;
+        typedef struct hid_hotplug_ hid_hotplug; /**< opaque hotplug monitor structure, see hid_hotplug_create() */
 
         /** hidapi info structure */
         struct hid_device_info {
@@ -73,12 +94,164 @@ extern "C" {
                 in all cases, and valid on the Windows implementation
                 only if the device contains more than one interface. */
             int interface_number;
+            /** The implementation which found the device, see
+                hid_get_backend(). It is not to be freed. */
+            const char *backend;
 
             /** Pointer to the next device */
             struct hid_device_info *next;
         };
 
 
+        /** What to do with an Input report that arrives while the
+            input queue is full. See hid_set_input_queue(). */
+        enum hid_queue_policy {
+            /** Discard the oldest queued report (the default). */
+            HID_QUEUE_DROP_OLDEST = 0,
+            /** Discard the report that just arrived. */
+            HID_QUEUE_DROP_NEWEST = 1,
+            /** Replace a queued report having the same Report ID (first
+                byte) in place, so only the latest value of each report
+                is kept. Otherwise discard the oldest report. A device
+                without Report IDs, as read from its report descriptor
+                at open, has a single report, so only its latest report
+                is queued. */
+            HID_QUEUE_KEEP_LATEST = 2,
+            /** Start small and double the queue as needed until it
+                reaches its capacity, then discard the oldest report. */
+            HID_QUEUE_GROW = 3
+        };
+
+        /** How the Linux/hidraw implementation reads devices. See
+            hid_set_io_engine(). */
+        enum hid_io_engine {
+            /** poll() and read() on each device when it is read (the
+                default). */
+            HID_IO_ENGINE_DEFAULT = 0,
+            /** One io_uring, shared by all devices, keeps reads posted
+                on every device and queues the reports that arrive.
+                Experimental. */
+            HID_IO_ENGINE_IO_URING = 1
+        };
+
+        /** What happened to a device. See hid_hotplug_wait(). */
+        enum hid_hotplug_event {
+            /** The device was connected. */
+            HID_HOTPLUG_ARRIVED = 1,
+            /** The device was disconnected. */
+            HID_HOTPLUG_LEFT = 2
+        };
+
+        /** Header of an input ring, a single-producer/single-consumer
+            ring of Input reports in memory supplied by the application.
+            See hid_set_input_ring(). The records follow the header.
+
+            Positions are byte counts which wrap around at 2^32; the
+            record at position p starts at offset (p & (capacity - 1))
+            in the record area. The ring is empty when head equals
+            tail. Consumers load tail with acquire and store head with
+            release ordering; hid_input_ring_read() shows how. */
+        struct hid_input_ring {
+            /** Position of the next record to read. Written by the
+                consumer only. */
+            unsigned int head;
+            unsigned char reserved1[60];
+            /** Position after the last record written. Written by the
+                library only. */
+            unsigned int tail;
+            unsigned char reserved2[60];
+            /** Size of the record area in bytes, a power of two. */
+            unsigned int capacity;
+            /** Nonzero while the consumer sleeps in
+                hid_input_ring_wait(). */
+            unsigned int waiting;
+            /** Futex word the consumer sleeps on. */
+            unsigned int wakeup;
+            /** Number of reports dropped because the ring was full. */
+            unsigned int dropped;
+            /** Nonzero once no more records will be written, because
+                reading from the device failed or the ring was
+                detached. */
+            unsigned int failed;
+            unsigned char reserved3[44];
+        };
+
+        /** The latencies a device keeps histograms of. See
+            hid_get_latency_histogram(). */
+        enum hid_latency {
+            /** From an Input report's arrival until it is read. Only
+                recorded by the libusb backend and the hidraw io_uring
+                engine, which know when reports arrive, and not for
+                reports taken from an input ring. */
+            HID_LATENCY_INPUT = 0,
+            /** The duration of successful hid_write() calls. */
+            HID_LATENCY_WRITE = 1,
+            /** The duration of successful hid_send_feature_report()
+                and hid_get_feature_report() calls. */
+            HID_LATENCY_FEATURE = 2
+        };
+
+        /** A log-linear histogram of latencies in nanoseconds, see
+            hid_get_latency_histogram(). A value v below
+            2 * #HID_HISTOGRAM_SUB_BUCKETS is counted in bucket v.
+            Above, with e the number of low bits of v beyond its 6
+            most significant ones, it is counted in bucket
+            e * #HID_HISTOGRAM_SUB_BUCKETS + (v >> e); so bucket i
+            covers the values from (i - e * 32) << e, with
+            e = i / 32 - 1, up to the next bucket's. Values are within
+            about 3% of their bucket's lower bound. Larger values than
+            the histogram covers go in the last bucket. */
+        struct hid_histogram {
+            /** The number of values recorded, the sum of counts. */
+            unsigned long long count;
+            /** The sum of the values recorded. */
+            unsigned long long total;
+            /** The largest value recorded. */
+            unsigned long long max;
+            unsigned long long counts[HID_HISTOGRAM_BUCKETS];
+        };
+
+        /** Counters kept for an open device, see hid_get_stats(). */
+        struct hid_device_stats {
+            /** Input reports received from the device. */
+            unsigned long long reports_received;
+            /** Bytes of Input reports received. */
+            unsigned long long bytes_in;
+            /** Bytes of Output reports written with hid_write(). */
+            unsigned long long bytes_out;
+            /** Input reports dropped, see hid_get_dropped_count(). */
+            unsigned long long reports_dropped;
+            /** The most Input reports that have been queued at once. */
+            unsigned long long queue_high_water;
+            /** Times a reader waiting for an Input report woke up. */
+            unsigned long long read_wakeups;
+            /** Reads that returned 0 because their timeout expired. */
+            unsigned long long read_timeouts;
+            /** Successful hid_write() calls. */
+            unsigned long long writes;
+            /** Total time spent in successful hid_write() calls, in
+                nanoseconds. */
+            unsigned long long write_time_total;
+            /** Longest time spent in a successful hid_write() call, in
+                nanoseconds. */
+            unsigned long long write_time_max;
+            /** Input transfers or reads and writes that failed,
+                including when the device was disconnected. */
+            unsigned long long transfer_errors;
+        };
+
+        /** A record in an input ring. The report data follows it,
+            padded to a multiple of 8 bytes. */
+        struct hid_input_record {
+            /** Length of the report in bytes, or #HID_INPUT_RING_WRAP. */
+            unsigned int length;
+            /** The low 32 bits of the report's sequence number, see
+                hid_read_sequenced(). */
+            unsigned int sequence;
+            /** When the report arrived, in CLOCK_MONOTONIC nanoseconds. */
+            unsigned long long timestamp;
+        };
+
         /** @brief Initialize the HIDAPI library.
 
             This function initializes the HIDAPI library. Calling it is not
@@ -108,6 +281,126 @@ extern "C" {
         */
         int HID_API_EXPORT HID_API_CALL hid_exit(void);
 
+        /** @brief Select how devices opened from now on are read.
+
+            With #HID_IO_ENGINE_IO_URING the Linux/hidraw implementation
+            keeps reads posted on every device in one io_uring (a
+            multishot read from Linux 6.7 on, several reads before),
+            which a single thread services for all devices,
+            and hid_read() takes reports from a queue of up to 16 per
+            device, discarding the oldest when it is full. If the
+            kernel has no usable io_uring this function returns -1 and
+            the current engine is kept, and a device the engine can't
+            take on falls back to poll() and read(). Devices already
+            open are not affected.
+
+            The io_uring engine is experimental: it has not been
+            measured against the default engine on hidraw devices yet.
+
+            The other implementations only accept
+            #HID_IO_ENGINE_DEFAULT.
+
+            @ingroup API
+            @param engine One of the #hid_io_engine values.
+
+            @returns
+                This function returns 0 on success and -1 if the engine
+                is not available.
+        */
+        int HID_API_EXPORT HID_API_CALL hid_set_io_engine(int engine);
+
+        /** @brief Select the implementation used from now on.
+
+            The Linux library holds three: "hidraw", which uses the
+            kernel's hidraw driver, "libusb", which uses libusb-1.0,
+            and "mock", which keeps a fixed set of devices in memory
+            for tests and benchmarks (see mock/hid.c). It starts with
+            the one named by the HIDAPI_BACKEND environment variable,
+            or "libusb".
+
+            hid_enumerate(), hid_open(), hid_open_path(),
+            hid_reactor_create() and hid_hotplug_create() use the
+            implementation selected when they are called. A device, a
+            reactor or a hotplug monitor keeps the one it was made by,
+            so devices of several implementations can be open at once,
+            but a reactor only takes devices of its own.
+
+            The other platforms have a single implementation and only
+            accept its name, see hid_get_backend().
+
+            @ingroup API
+            @param name The name of the implementation.
+
+            @returns
+                This function returns 0 on success and -1 if there is
+                no such implementation.
+        */
+        int HID_API_EXPORT HID_API_CALL hid_set_backend(const char *name);
+
+        /** @brief Get the name of the implementation selected.
+
+            @ingroup API
+
+            @returns
+                "hidraw", "libusb" or "mock" on Linux, "mac" or
+                "windows" elsewhere. See hid_set_backend().
+        */
+        HID_API_EXPORT const char * HID_API_CALL hid_get_backend(void);
+
+        /** @brief Enumerate the HID Devices of one implementation.
+
+            Like hid_enumerate(), but through the implementation
+            named, whichever is selected. See hid_set_backend().
+
+            @ingroup API
+            @param backend The name of the implementation, or NULL
+                for the one selected.
+            @param vendor_id The Vendor ID (VID) of the types of device
+                to open.
+            @param product_id The Product ID (PID) of the types of
+                device to open.
+            @param devs Set to the list of devices found, which is
+                NULL if there are none, and which must be freed with
+                hid_free_enumeration().
+
+            @returns
+                This function returns 0 on success and -1 if there is
+                no such implementation.
+        */
+        int HID_API_EXPORT HID_API_CALL hid_enumerate_backend(const char *backend, unsigned short vendor_id, unsigned short product_id, struct hid_device_info **devs);
+
+        /** @brief Open a HID device by its path name, through one
+            implementation.
+
+            Like hid_open_path(), but through the implementation
+            named, whichever is selected. A path is only meaningful to
+            the implementation which found the device, so pass the
+            backend of its hid_device_info.
+
+            @ingroup API
+            @param backend The name of the implementation, or NULL
+                for the one selected.
+            @param path The path name of the device to open
+
+            @returns
+                This function returns a pointer to a #hid_device object
+                on success or NULL on failure, or if there is no such
+                implementation.
+        */
+        HID_API_EXPORT hid_device * HID_API_CALL hid_open_path_backend(const char *backend, const char *path);
+
+        /** @brief Get the name of the implementation a device was
+            opened by.
+
+            @ingroup API
+            @param device A device handle returned from hid_open().
+
+            @returns
+                The name of the implementation, as hid_get_backend()
+                returns it.
+        */
+        HID_API_EXPORT const char * HID_API_CALL hid_get_device_backend(hid_device *device);
+
         /** @brief Enumerate the HID Devices.
 
             This function returns a linked list of all the HID devices
@@ -239,6 +532,320 @@ extern "C" {
         */
         int  HID_API_EXPORT HID_API_CALL hid_read(hid_device *device, unsigned char *data, size_t length);
 
+        /** @brief Read an Input report and the time it arrived.
+
+            Like hid_read_timeout(), and also returns when the report
+            arrived, as CLOCK_MONOTONIC nanoseconds on Linux. With
+            libusb and the io_uring engine this is when the transfer or
+            read completed; with plain hidraw it is when the report was
+            read, since the kernel doesn't record the arrival time.
+
+            @ingroup API
+            @param device A device handle returned from hid_open().
+            @param data A buffer to put the read data into.
+            @param length The number of bytes to read. For devices with
+                multiple reports, make sure to read an extra byte for
+                the report number.
+            @param timestamp Set to the arrival time of the report, if
+                one was read.
+            @param milliseconds timeout in milliseconds or -1 for blocking wait.
+
+            @returns
+                This function returns the actual number of bytes read,
+                0 if the timeout expired and -1 on error or if the
+                platform doesn't record arrival times.
+        */
+        int HID_API_EXPORT HID_API_CALL hid_read_timestamped(hid_device *device, unsigned char *data, size_t length, unsigned long long *timestamp, int milliseconds);
+
+        /** @brief Read an Input report and its sequence number.
+
+            Like hid_read_timestamped(), and also returns the report's
+            sequence number. Every report the backend receives is
+            numbered, from 0 when the device is opened, whether it is
+            queued, written to an input ring or dropped, so a gap
+            between the numbers of two reports read in turn is the
+            number of reports lost in between. hid_get_dropped_count()
+            gives the total.
+
+            With #HID_QUEUE_KEEP_LATEST, a report that replaces a
+            queued one takes its place in the queue, so numbers may
+            come out of order. With plain hidraw, reports are numbered
+            as they are read; the kernel drops reports when its own
+            queue is full without telling anyone.
+
+            @ingroup API
+            @param device A device handle returned from hid_open().
+            @param data A buffer to put the read data into.
+            @param length The number of bytes to read. For devices with
+                multiple reports, make sure to read an extra byte for
+                the report number.
+            @param sequence Set to the sequence number of the report,
+                if one was read. May be NULL.
+            @param timestamp Set to the arrival time of the report, if
+                one was read. May be NULL.
+            @param milliseconds timeout in milliseconds or -1 for blocking wait.
+
+            @returns
+                This function returns the actual number of bytes read,
+                0 if the timeout expired and -1 on error or if the
+                platform doesn't number reports.
+        */
+        int HID_API_EXPORT HID_API_CALL hid_read_sequenced(hid_device *device, unsigned char *data, size_t length, unsigned long long *sequence, unsigned long long *timestamp, int milliseconds);
+
+        /** @brief Get the number of Input reports a device has dropped.
+
+            Counts the reports received but never returned because the
+            queue was full, according to its overflow policy (see
+            hid_set_input_queue()), or because an input ring was full.
+
+            @ingroup API
+            @param device A device handle returned from hid_open().
+            @param count Set to the number of reports dropped since the
+                device was opened.
+
+            @returns
+                This function returns 0 on success and -1 if the
+                platform doesn't count dropped reports.
+        */
+        int HID_API_EXPORT HID_API_CALL hid_get_dropped_count(hid_device *device, unsigned long long *count);
+
+        /** @brief Get a device's performance counters.
+
+            The counters start at 0 when the device is opened. Each one
+            is updated atomically, but they are read one at a time, so
+            a snapshot taken while reports arrive may be slightly
+            inconsistent across counters.
+
+            Plain hidraw has no queue of its own, so queue_high_water
+            stays 0 there unless the io_uring engine is used.
+
+            @ingroup API
+            @param device A device handle returned from hid_open().
+            @param stats Set to the device's counters.
+
+            @returns
+                This function returns 0 on success and -1 if the
+                platform doesn't keep counters.
+        */
+        int HID_API_EXPORT HID_API_CALL hid_get_stats(hid_device *device, struct hid_device_stats *stats);
+
+        /** @brief Get one of a device's latency histograms.
+
+            Recording a latency takes a few atomic increments and no
+            allocation, so histograms are always kept. They start empty
+            when the device is opened.
+
+            @ingroup API
+            @param device A device handle returned from hid_open().
+            @param kind Which latency, one of enum hid_latency.
+            @param histogram Set to the histogram.
+            @param reset Nonzero to empty the histogram as it is
+                copied. Each value recorded meanwhile is either in the
+                copy or left for the next one.
+
+            @returns
+                This function returns 0 on success and -1 if @p kind is
+                invalid or the platform doesn't keep histograms.
+        */
+        int HID_API_EXPORT HID_API_CALL hid_get_latency_histogram(hid_device *device, int kind, struct hid_histogram *histogram, int reset);
+
+        /** @brief Read all queued Input reports from a HID device.
+
+            Waits up to @p milliseconds for the first Input report, like
+            hid_read_timeout(), and then takes every further report that
+            has already arrived without blocking again. The reports are
+            packed into @p data one after another, each preceded by its
+            length as a 16-bit little-endian value. Draining stops when
+            @p max_reports reports have been stored, when no more reports
+            are queued, or when the next report might not fit.
+
+            @ingroup API
+            @param device A device handle returned from hid_open().
+            @param data A buffer to put the length-prefixed reports into.
+            @param length On entry, the size of @p data in bytes. On
+                return, the number of bytes stored in @p data.
+            @param max_reports The maximum number of reports to return.
+                Must be at least 1.
+            @param milliseconds timeout in milliseconds for the first
+                report or -1 for blocking wait.
+
+            @returns
+                This function returns the number of reports stored, 0 if
+                the timeout expired and -1 on error.
+        */
+        int HID_API_EXPORT HID_API_CALL hid_read_many(hid_device *device, unsigned char *data, size_t *length, int max_reports, int milliseconds);
+
+        /** @brief Get a file descriptor to wait on for Input reports.
+
+            The descriptor becomes readable when Input reports are
+            available to read from the device, and also once the device
+            has been disconnected. It can be added to an existing
+            poll(), select() or epoll loop, which then calls
+            hid_read_timeout() with a timeout of 0 when it fires. Only
+            wait on the descriptor; do not read from it or close it. It
+            stays valid until hid_close().
+
+            With the hidraw implementation this is the hidraw device
+            itself, or an eventfd which is readable while reports are
+            queued if the device is read by the io_uring engine (see
+            hid_set_io_engine()). With the libusb implementation it is an
+            eventfd which is readable while reports are queued. The other
+            implementations return -1.
+
+            @ingroup API
+            @param device A device handle returned from hid_open().
+
+            @returns
+                This function returns a file descriptor on success and
+                -1 on error.
+        */
+        int HID_API_EXPORT HID_API_CALL hid_get_poll_fd(hid_device *device);
+
+        /** @brief Create a reactor to wait on many devices at once.
+
+            A reactor lets one thread wait for Input reports from any
+            number of devices, instead of blocking a thread per device
+            in hid_read(). Add devices with hid_reactor_add() and wait
+            with hid_reactor_wait(), then read from the devices it
+            returns, typically with a timeout of 0.
+
+            Only the Linux implementations support reactors; the others
+            return NULL.
+
+            @ingroup API
+
+            @returns
+                This function returns a pointer to a #hid_reactor object
+                on success or NULL on failure.
+        */
+        hid_reactor * HID_API_EXPORT HID_API_CALL hid_reactor_create(void);
+
+        /** @brief Create a reactor of one implementation.
+
+            Like hid_reactor_create(), but through the implementation
+            named, whichever is selected. A reactor only takes devices
+            of its own implementation, so pass the
+            hid_get_device_backend() of the devices to wait on.
+
+            @ingroup API
+            @param backend The name of the implementation, or NULL
+                for the one selected.
+
+            @returns
+                This function returns a pointer to a #hid_reactor object
+                on success or NULL on failure, or if there is no such
+                implementation.
+        */
+        hid_reactor * HID_API_EXPORT HID_API_CALL hid_reactor_create_backend(const char *backend);
+
+        /** @brief Add a device to a reactor.
+
+            A device must be removed with hid_reactor_remove() before
+            it is closed, and must be of the reactor's implementation
+            (see hid_reactor_create_backend()). A device read by the
+            io_uring engine (see
+            hid_set_io_engine()) can only be in one reactor at a time.
+
+            @ingroup API
+            @param reactor A reactor returned from hid_reactor_create().
+            @param device A device handle returned from hid_open().
+
+            @returns
+                This function returns 0 on success and -1 on error.
+        */
+        int HID_API_EXPORT HID_API_CALL hid_reactor_add(hid_reactor *reactor, hid_device *device);
+
+        /** @brief Remove a device from a reactor.
+
+            @ingroup API
+            @param reactor A reactor returned from hid_reactor_create().
+            @param device A device handle added with hid_reactor_add().
+
+            @returns
+                This function returns 0 on success and -1 on error.
+        */
+        int HID_API_EXPORT HID_API_CALL hid_reactor_remove(hid_reactor *reactor, hid_device *device);
+
+        /** @brief Wait for devices in a reactor to become readable.
+
+            A device is returned while it has Input reports to read, or
+            once it has been disconnected, in which case reading from it
+            returns -1. Devices which are not read stay ready and are
+            returned again by the next call.
+
+            @ingroup API
+            @param reactor A reactor returned from hid_reactor_create().
+            @param ready An array to put the ready devices into.
+            @param max_ready The number of entries in @p ready.
+            @param milliseconds timeout in milliseconds or -1 for
+                blocking wait.
+
+            @returns
+                This function returns the number of devices stored in
+                @p ready, 0 if the timeout expired or the wait was
+                interrupted by a signal, and -1 on error.
+        */
+        int HID_API_EXPORT HID_API_CALL hid_reactor_wait(hid_reactor *reactor, hid_device **ready, int max_ready, int milliseconds);
+
+        /** @brief Destroy a reactor.
+
+            The devices in it are not closed.
+
+            @ingroup API
+            @param reactor A reactor returned from hid_reactor_create().
+        */
+        void HID_API_EXPORT HID_API_CALL hid_reactor_destroy(hid_reactor *reactor);
+
+        /** @brief Create a hotplug monitor.
+
+            A hotplug monitor reports the HID devices which are
+            connected and disconnected from then on, so an application
+            need not call hid_enumerate() over and over to notice
+            them. Devices present when it is created are not reported,
+            but their disconnection is.
+
+            On Linux/hidraw it listens to udev for hidraw nodes. On
+            Linux/libusb it registers with libusb's hotplug support,
+            and fails if libusb has none; libusb reports a USB device
+            once, so each of its HID interfaces is reported in turn.
+            The other platforms return NULL.
+
+            @ingroup API
+            @param vendor_id The Vendor ID (VID) of the devices to
+                report, as for hid_enumerate().
+            @param product_id The Product ID (PID) of the devices to
+                report, as for hid_enumerate().
+
+            @returns
+                This function returns a pointer to a #hid_hotplug
+                object on success or NULL on failure.
+        */
+        hid_hotplug * HID_API_EXPORT HID_API_CALL hid_hotplug_create(unsigned short vendor_id, unsigned short product_id);
+
+        /** @brief Wait for a device to be connected or disconnected.
+
+            @ingroup API
+            @param hotplug A monitor returned from hid_hotplug_create().
+            @param device Set to the device, a list of one to be freed
+                with hid_free_enumeration(). A device which left is
+                described as it was when it arrived.
+            @param milliseconds timeout in milliseconds or -1 for
+                blocking wait.
+
+            @returns
+                This function returns #HID_HOTPLUG_ARRIVED or
+                #HID_HOTPLUG_LEFT, 0 if the timeout expired or the wait
+                was interrupted by a signal, and -1 on error.
+        */
+        int HID_API_EXPORT HID_API_CALL hid_hotplug_wait(hid_hotplug *hotplug, struct hid_device_info **device, int milliseconds);
+
+        /** @brief Destroy a hotplug monitor.
+
+            @ingroup API
+            @param hotplug A monitor returned from hid_hotplug_create().
+        */
+        void HID_API_EXPORT HID_API_CALL hid_hotplug_destroy(hid_hotplug *hotplug);
+
         /** @brief Set the device handle to be non-blocking.
 
             In non-blocking mode calls to hid_read() will return
@@ -259,6 +866,120 @@ extern "C" {
         */
         int  HID_API_EXPORT HID_API_CALL hid_set_nonblocking(hid_device *device, int nonblock);
 
+        /** @brief Configure the queue of received Input reports.
+
+            Input reports are queued by the library until they are
+            read. This sets how many reports the queue holds and what
+            happens to new reports once it is full. The default is a
+            capacity of 30 with #HID_QUEUE_DROP_OLDEST. Reports already
+            queued are kept, except for the oldest ones if the queue
+            shrinks below the number queued.
+
+            Only the libusb implementation queues reports itself; the
+            other implementations return -1.
+
+            @ingroup API
+            @param device A device handle returned from hid_open().
+            @param capacity The maximum number of queued reports. Must
+                be at least 1.
+            @param policy One of the #hid_queue_policy values.
+
+            @returns
+                This function returns 0 on success and -1 on error.
+        */
+        int HID_API_EXPORT HID_API_CALL hid_set_input_queue(hid_device *device, int capacity, int policy);
+
+        /** @brief Set the number of Input transfers kept in flight.
+
+            The libusb implementation reads Input reports with
+            interrupt transfers. With one transfer, the endpoint is not
+            polled between its completion and resubmission, so a
+            device which sends reports back to back may have to hold
+            one. More transfers, each with its own buffer, close that
+            gap. Reports are still queued in the order they arrived.
+            The default is 1.
+
+            Only the libusb implementation supports this; the other
+            implementations return -1.
+
+            @ingroup API
+            @param device A device handle returned from hid_open().
+            @param count The number of transfers, from 1 to
+                #HID_MAX_INPUT_TRANSFERS.
+
+            @returns
+                This function returns 0 on success and -1 on error.
+        */
+        int HID_API_EXPORT HID_API_CALL hid_set_input_transfers(hid_device *device, int count);
+
+        /** @brief Deliver Input reports into a ring in shared memory.
+
+            From now on every Input report is written, with its length
+            and arrival time, into the ring at @p ring instead of the
+            input queue, and reports already queued are moved there. A
+            consumer takes them out with plain memory reads and only
+            needs a system call, hid_input_ring_wait(), to sleep while
+            the ring is empty. Reports which don't fit are dropped and
+            counted. See struct hid_input_ring for the layout.
+
+            hid_read() and the other read functions fail while a ring
+            is attached; wait with hid_input_ring_wait() rather than
+            hid_get_poll_fd() or a reactor. The ring must stay valid
+            until it is detached or the device is closed. Detaching
+            it sets its failed flag.
+
+            The Linux implementations support this; the others return
+            -1.
+
+            @ingroup API
+            @param device A device handle returned from hid_open().
+            @param ring Memory for the ring, aligned to 8 bytes, or
+                NULL to detach the current ring.
+            @param size The size of the memory at @p ring in bytes. The
+                record area is the largest power of two that fits
+                after the header, and should hold several reports.
+
+            @returns
+                This function returns 0 on success and -1 on error.
+        */
+        int HID_API_EXPORT HID_API_CALL hid_set_input_ring(hid_device *device, struct hid_input_ring *ring, size_t size);
+
+        /** @brief Wait until the input ring has a record.
+
+            @ingroup API
+            @param device A device handle returned from hid_open().
+            @param milliseconds timeout in milliseconds or -1 for
+                blocking wait.
+
+            @returns
+                This function returns 1 if a record is available, 0 if
+                the timeout expired and -1 if no ring is attached or
+                no more records will be written to it.
+        */
+        int HID_API_EXPORT HID_API_CALL hid_input_ring_wait(hid_device *device, int milliseconds);
+
+        /** @brief Read an Input report from the input ring.
+
+            The consumer side of the ring in C. Only one thread may
+            consume a ring.
+
+            @ingroup API
+            @param device A device handle returned from hid_open().
+            @param data A buffer to put the report into, truncated if
+                it doesn't fit.
+            @param length The size of @p data in bytes.
+            @param timestamp Set to the arrival time of the report in
+                CLOCK_MONOTONIC nanoseconds, unless NULL.
+            @param milliseconds timeout in milliseconds or -1 for
+                blocking wait.
+
+            @returns
+                This function returns the number of bytes copied to
+                @p data, 0 if the timeout expired and -1 on error,
+                like hid_read_timeout().
+        */
+        int HID_API_EXPORT HID_API_CALL hid_input_ring_read(hid_device *device, unsigned char *data, size_t length, unsigned long long *timestamp, int milliseconds);
+
         /** @brief Send a Feature report to the device.
 
             Feature reports are sent over the Control endpoint as a
@@ -0,0 +1,563 @@
+/*******************************************************
+ HIDAPI - Multi-Platform library for
+ communication with HID devices.
+
+ hidbench - measures a HID device through one of the
+ HIDAPI implementations and prints the results as JSON.
+
+ At the discretion of the user of this library,
+ this software may be licensed under the terms of the
+ GNU Public License v3, a BSD-Style license, or the
+ original HIDAPI license as outlined in the LICENSE.txt,
+ LICENSE-gpl3.txt, LICENSE-bsd.txt, and LICENSE-orig.txt
+ files located at the root of the source distribution.
+ These files may also be found in the public source
+ code repository located at:
+        http://github.com/signal11/hidapi .
+********************************************************/
+
+/* On Linux, -b selects the implementation, see hid_set_backend(), and
+   the output names it so results can be compared.
+
+   Paths differ between implementations (/dev/hidraw3 against
+   0001:0004:00), so to run the same device through several, pick it
+   with -d VID:PID. Nothing is sent to the device unless -w is given, since
+   an Output report may make a device do something.
+
+   With -m, it instead reads many devices at once from one thread, through
+   a reactor and hid_read_many(), and reports what each report cost in CPU
+   time and system calls; -E selects the engine which reads them, see
+   hid_set_io_engine(). */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wchar.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#ifdef __linux__
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+#include <algorithm>
+#include <vector>
+#include "hidapi.h"
+
+#define MAX_REPORT_SIZE 4096
+#define ROUND_TRIP_TIMEOUT_MS 1000
+#define DRAIN_MAX_REPORTS 256
+
+static unsigned long long now_ns()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long long) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/* Latencies of one operation, in nanoseconds. */
+struct samples {
+	std::vector<unsigned long long> values;
+	int failures;
+
+	samples() : failures(0) {}
+};
+
+/* Members follow "backend", so each one starts with a comma. */
+static void begin_member(const char *name)
+{
+	printf(",\n  \"%s\": ", name);
+}
+
+static void print_string(const char *s)
+{
+	putchar('"');
+	for (; *s; s++) {
+		if (*s == '"' || *s == '\\')
+			printf("\\%c", *s);
+		else if ((unsigned char) *s < 0x20)
+			printf("\\u%04x", *s);
+		else
+			putchar(*s);
+	}
+	putchar('"');
+}
+
+/* Nearest rank, on sorted values. */
+static double percentile_us(const std::vector<unsigned long long> &v, double p)
+{
+	size_t rank = (size_t) (p / 100 * v.size() + 0.999999);
+	if (rank < 1)
+		rank = 1;
+	return v[rank - 1] / 1000.0;
+}
+
+/* Starts an object and leaves it open, so callers can add members. */
+static void print_latency(const char *name, samples &s)
+{
+	std::vector<unsigned long long> &v = s.values;
+	begin_member(name);
+	printf("{\"samples\": %u, \"failures\": %d", (unsigned) v.size(), s.failures);
+	if (!v.empty()) {
+		unsigned long long total = 0;
+		for (size_t i = 0; i < v.size(); i++)
+			total += v[i];
+		std::sort(v.begin(), v.end());
+		printf(", \"min_us\": %.3f, \"mean_us\": %.3f, \"p50_us\": %.3f, \"p90_us\": %.3f, \"p99_us\": %.3f, \"max_us\": %.3f",
+			v.front() / 1000.0, total / 1000.0 / v.size(),
+			percentile_us(v, 50), percentile_us(v, 90), percentile_us(v, 99),
+			v.back() / 1000.0);
+	}
+}
+
+static void bench_enumerate(int iterations)
+{
+	samples s;
+	int devices = 0;
+	for (int i = 0; i < iterations; i++) {
+		unsigned long long start = now_ns();
+		struct hid_device_info *devs = hid_enumerate(0x0, 0x0);
+		s.values.push_back(now_ns() - start);
+
+		devices = 0;
+		for (struct hid_device_info *cur = devs; cur; cur = cur->next)
+			devices++;
+		hid_free_enumeration(devs);
+	}
+	print_latency("enumerate", s);
+	printf(", \"devices\": %d}", devices);
+}
+
+static void bench_open_close(const char *path, int iterations)
+{
+	samples open_s, close_s;
+	for (int i = 0; i < iterations; i++) {
+		unsigned long long start = now_ns();
+		hid_device *dev = hid_open_path(path);
+		unsigned long long opened = now_ns();
+		if (!dev) {
+			open_s.failures++;
+			continue;
+		}
+		hid_close(dev);
+		open_s.values.push_back(opened - start);
+		close_s.values.push_back(now_ns() - opened);
+	}
+	print_latency("open", open_s);
+	printf("}");
+	print_latency("close", close_s);
+	printf("}");
+}
+
+/* Takes whatever the device sends for a number of seconds. */
+static void bench_read(hid_device *dev, int size, int seconds)
+{
+	unsigned char buf[MAX_REPORT_SIZE];
+	unsigned long long reports = 0, bytes = 0, timeouts = 0;
+	unsigned long long dropped_before = 0, dropped_after = 0;
+	int errors = 0;
+
+	hid_get_dropped_count(dev, &dropped_before);
+	unsigned long long start = now_ns();
+	unsigned long long end = start + seconds * 1000000000ULL;
+	unsigned long long t;
+	while ((t = now_ns()) < end) {
+		int res = hid_read_timeout(dev, buf, size, 100);
+		if (res > 0) {
+			reports++;
+			bytes += res;
+		}
+		else if (res == 0)
+			timeouts++;
+		else if (++errors > 10)
+			break;
+	}
+	t = now_ns();
+	hid_get_dropped_count(dev, &dropped_after);
+
+	double elapsed = (t - start) / 1e9;
+	begin_member("read");
+	printf("{\"seconds\": %.3f, \"reports\": %llu, \"bytes\": %llu, \"reports_per_s\": %.1f, \"mb_per_s\": %.3f, \"timeouts\": %llu, \"errors\": %d, \"dropped\": %llu}",
+		elapsed, reports, bytes, reports / elapsed, bytes / elapsed / 1e6,
+		timeouts, errors, dropped_after - dropped_before);
+}
+
+static void bench_write(hid_device *dev, const unsigned char *report, int size, int iterations)
+{
+	samples s;
+	unsigned long long bytes = 0;
+	unsigned long long start = now_ns();
+	for (int i = 0; i < iterations; i++) {
+		unsigned long long t = now_ns();
+		int res = hid_write(dev, report, size);
+		if (res < 0) {
+			s.failures++;
+			continue;
+		}
+		s.values.push_back(now_ns() - t);
+		bytes += res;
+	}
+	double elapsed = (now_ns() - start) / 1e9;
+	print_latency("write", s);
+	printf(", \"bytes\": %llu, \"reports_per_s\": %.1f, \"mb_per_s\": %.3f}",
+		bytes, s.values.size() / elapsed, bytes / elapsed / 1e6);
+}
+
+/* Only meaningful for a device which answers each Output report with an
+   Input report, such as a loopback firmware or a virtual device. */
+static void bench_round_trip(hid_device *dev, const unsigned char *report, int size, int iterations)
+{
+	unsigned char buf[MAX_REPORT_SIZE];
+	samples s;
+	for (int i = 0; i < iterations; i++) {
+		/* Throw away reports which were sent before the write. A
+		   device which never stops sending can't be measured. */
+		for (int j = 0; j < DRAIN_MAX_REPORTS; j++)
+			if (hid_read_timeout(dev, buf, sizeof(buf), 0) <= 0)
+				break;
+
+		unsigned long long start = now_ns();
+		if (hid_write(dev, report, size) < 0 ||
+		    hid_read_timeout(dev, buf, sizeof(buf), ROUND_TRIP_TIMEOUT_MS) <= 0) {
+			s.failures++;
+			continue;
+		}
+		s.values.push_back(now_ns() - start);
+	}
+	print_latency("round_trip", s);
+	printf("}");
+}
+
+static void bench_feature(hid_device *dev, unsigned char report_id, int size, int iterations, bool send)
+{
+	unsigned char buf[MAX_REPORT_SIZE];
+	samples get_s, send_s;
+	for (int i = 0; i < iterations; i++) {
+		memset(buf, 0, size);
+		buf[0] = report_id;
+		unsigned long long start = now_ns();
+		if (hid_get_feature_report(dev, buf, size) < 0)
+			get_s.failures++;
+		else
+			get_s.values.push_back(now_ns() - start);
+	}
+	print_latency("get_feature_report", get_s);
+	printf("}");
+	if (!send)
+		return;
+
+	/* Sends back what was read, so the device's state stays the same. */
+	memset(buf, 0, size);
+	buf[0] = report_id;
+	int len = hid_get_feature_report(dev, buf, size);
+	if (len < 0)
+		len = size;
+	for (int i = 0; i < iterations; i++) {
+		unsigned long long start = now_ns();
+		if (hid_send_feature_report(dev, buf, len) < 0)
+			send_s.failures++;
+		else
+			send_s.values.push_back(now_ns() - start);
+	}
+	print_latency("send_feature_report", send_s);
+	printf("}");
+}
+
+/* Opens a counter of the system calls made by the process, through the
+   raw_syscalls:sys_enter tracepoint, or returns -1 if tracefs or
+   perf_event_open() is unavailable. It counts the threads started after
+   it, so it is opened before the library starts any. */
+static int open_syscall_counter()
+{
+#ifdef __linux__
+	static const char *id_paths[] = {
+		"/sys/kernel/tracing/events/raw_syscalls/sys_enter/id",
+		"/sys/kernel/debug/tracing/events/raw_syscalls/sys_enter/id"
+	};
+	unsigned long long id;
+	for (size_t i = 0; i < sizeof(id_paths) / sizeof(id_paths[0]); i++) {
+		FILE *f = fopen(id_paths[i], "r");
+		if (!f)
+			continue;
+		int found = fscanf(f, "%llu", &id);
+		fclose(f);
+		if (found != 1)
+			continue;
+
+		struct perf_event_attr attr;
+		memset(&attr, 0, sizeof(attr));
+		attr.type = PERF_TYPE_TRACEPOINT;
+		attr.size = sizeof(attr);
+		attr.config = id;
+		attr.inherit = 1;
+		return syscall(__NR_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC);
+	}
+#endif
+	return -1;
+}
+
+static unsigned long long read_counter(int fd)
+{
+	unsigned long long value = 0;
+	if (fd >= 0 && read(fd, &value, sizeof(value)) != sizeof(value))
+		value = 0;
+	return value;
+}
+
+static double cpu_s(const struct rusage *r)
+{
+	return r->ru_utime.tv_sec + r->ru_utime.tv_usec / 1e6 +
+		r->ru_stime.tv_sec + r->ru_stime.tv_usec / 1e6;
+}
+
+/* Reads every device for a number of seconds from one thread, which
+   waits on a reactor and drains the ready devices with hid_read_many(). */
+static void bench_read_many(std::vector<hid_device *> &devs, int size, int seconds, int syscall_fd)
+{
+	std::vector<unsigned char> buf(DRAIN_MAX_REPORTS * (size + 2));
+	std::vector<hid_device *> ready(devs.size());
+	std::vector<hid_device *> added;
+	unsigned long long reports = 0, bytes = 0, syscalls;
+	unsigned long long dropped = 0, dropped_before = 0, dropped_after;
+	int errors = 0;
+	struct rusage ru_start, ru_end;
+
+	begin_member("read_many");
+	hid_reactor *reactor = hid_reactor_create();
+	if (!reactor) {
+		printf("{\"devices\": %u, \"error\": \"no reactor\"}", (unsigned) devs.size());
+		return;
+	}
+	for (size_t i = 0; i < devs.size(); i++) {
+		if (hid_reactor_add(reactor, devs[i]) == 0)
+			added.push_back(devs[i]);
+		else
+			errors++;
+		if (hid_get_dropped_count(devs[i], &dropped_after) == 0)
+			dropped_before += dropped_after;
+	}
+
+	getrusage(RUSAGE_SELF, &ru_start);
+	syscalls = read_counter(syscall_fd);
+	unsigned long long start = now_ns();
+	unsigned long long end = start + seconds * 1000000000ULL;
+	while (now_ns() < end && !added.empty()) {
+		int n = hid_reactor_wait(reactor, &ready[0], ready.size(), 100);
+		if (n < 0) {
+			errors++;
+			break;
+		}
+		for (int i = 0; i < n; i++) {
+			size_t len = buf.size();
+			int res = hid_read_many(ready[i], &buf[0], &len, DRAIN_MAX_REPORTS, 0);
+			if (res > 0) {
+				reports += res;
+				bytes += len - 2 * res;
+			}
+			else if (res < 0) {
+				/* Disconnected, it would stay ready. */
+				errors++;
+				hid_reactor_remove(reactor, ready[i]);
+				added.erase(std::find(added.begin(), added.end(), ready[i]));
+			}
+		}
+	}
+	unsigned long long t = now_ns();
+	syscalls = read_counter(syscall_fd) - syscalls;
+	getrusage(RUSAGE_SELF, &ru_end);
+
+	for (size_t i = 0; i < added.size(); i++)
+		hid_reactor_remove(reactor, added[i]);
+	hid_reactor_destroy(reactor);
+	for (size_t i = 0; i < devs.size(); i++) {
+		if (hid_get_dropped_count(devs[i], &dropped_after) == 0)
+			dropped += dropped_after;
+	}
+	dropped -= dropped_before;
+
+	double elapsed = (t - start) / 1e9;
+	double cpu = cpu_s(&ru_end) - cpu_s(&ru_start);
+	long switches = (ru_end.ru_nvcsw - ru_start.ru_nvcsw) + (ru_end.ru_nivcsw - ru_start.ru_nivcsw);
+	printf("{\"devices\": %u, \"seconds\": %.3f, \"reports\": %llu, \"bytes\": %llu, \"reports_per_s\": %.1f",
+		(unsigned) devs.size(), elapsed, reports, bytes, reports / elapsed);
+	printf(", \"cpu_percent\": %.1f, \"cpu_us_per_report\": %.3f",
+		100 * cpu / elapsed, reports? 1e6 * cpu / reports: 0.0);
+	printf(", \"syscalls_per_report\": ");
+	if (syscall_fd >= 0 && reports)
+		printf("%.3f", (double) syscalls / reports);
+	else
+		printf("null");
+	printf(", \"context_switches_per_s\": %.0f, \"errors\": %d, \"dropped\": %llu}",
+		switches / elapsed, errors, dropped);
+}
+
+static char *find_path(unsigned short vendor_id, unsigned short product_id)
+{
+	char *path = NULL;
+	struct hid_device_info *devs = hid_enumerate(vendor_id, product_id);
+	if (devs)
+		path = strdup(devs->path);
+	hid_free_enumeration(devs);
+	return path;
+}
+
+static int bench_many(unsigned short vendor_id, unsigned short product_id, int count,
+                      int size, int seconds, int enumerations, const char *engine, int syscall_fd)
+{
+	std::vector<hid_device *> devs;
+	/* hid_enumerate() only takes a PID of 0 along with a VID of 0. */
+	struct hid_device_info *infos = hid_enumerate(product_id? vendor_id: 0, product_id);
+	for (struct hid_device_info *cur = infos; cur && (int) devs.size() < count; cur = cur->next) {
+		if (vendor_id && cur->vendor_id != vendor_id)
+			continue;
+		hid_device *dev = hid_open_path(cur->path);
+		if (dev)
+			devs.push_back(dev);
+		else
+			fprintf(stderr, "unable to open %s\n", cur->path);
+	}
+	hid_free_enumeration(infos);
+	if (devs.empty()) {
+		fprintf(stderr, "no device %04x:%04x\n", vendor_id, product_id);
+		hid_exit();
+		return 1;
+	}
+
+	printf("{\n  \"backend\": \"%s\",\n  \"io_engine\": \"%s\"", hid_get_backend(), engine);
+	printf(",\n  \"report_size\": %d", size);
+	if (enumerations > 0)
+		bench_enumerate(enumerations);
+	bench_read_many(devs, size, seconds, syscall_fd);
+	printf("\n}\n");
+
+	for (size_t i = 0; i < devs.size(); i++)
+		hid_close(devs[i]);
+	if (syscall_fd >= 0)
+		close(syscall_fd);
+	hid_exit();
+	return 0;
+}
+
+static void usage(const char *name)
+{
+	fprintf(stderr,
+		"usage: %s (-d VID:PID | -p PATH) [options]\n"
+		"  -b NAME     the implementation: hidraw, libusb or mock\n"
+		"  -E ENGINE   how hidraw devices are read: default or io_uring\n"
+		"  -d VID:PID  the first device with these IDs, in hex\n"
+		"  -m COUNT    read up to COUNT devices with the IDs of -d (0 takes\n"
+		"              any) together, instead of timing one\n"
+		"  -p PATH     a device path, as hid_enumerate() gives it\n"
+		"  -n COUNT    samples for each latency (default 100)\n"
+		"  -e COUNT    enumerations (default 20)\n"
+		"  -t SECONDS  how long to read Input reports, 0 to skip (default 5)\n"
+		"  -s SIZE     report size, with the report ID (default 64)\n"
+		"  -r ID       report ID of Output and Feature reports (default 0)\n"
+		"  -w          write Output reports, and time write-to-read round trips\n"
+		"  -f          time getting the Feature report; with -w, sending it too\n",
+		name);
+	exit(2);
+}
+
+int main(int argc, char* argv[])
+{
+	const char *path = NULL;
+	const char *backend = NULL;
+	const char *engine = NULL;
+	char *found = NULL;
+	unsigned int vendor_id = 0, product_id = 0;
+	bool by_id = false, output = false, feature = false;
+	int iterations = 100, enumerations = 20, seconds = 5, size = 64, report_id = 0;
+	int many = 0, syscall_fd = -1;
+	int c;
+
+	while ((c = getopt(argc, argv, "b:E:d:m:p:n:e:t:s:r:wf")) != -1) {
+		switch (c) {
+		case 'b': backend = optarg; break;
+		case 'E': engine = optarg; break;
+		case 'd':
+			if (sscanf(optarg, "%x:%x", &vendor_id, &product_id) != 2)
+				usage(argv[0]);
+			by_id = true;
+			break;
+		case 'm': many = atoi(optarg); break;
+		case 'p': path = optarg; break;
+		case 'n': iterations = atoi(optarg); break;
+		case 'e': enumerations = atoi(optarg); break;
+		case 't': seconds = atoi(optarg); break;
+		case 's': size = atoi(optarg); break;
+		case 'r': report_id = strtol(optarg, NULL, 0); break;
+		case 'w': output = true; break;
+		case 'f': feature = true; break;
+		default: usage(argv[0]);
+		}
+	}
+	if ((path == NULL) == !by_id || size < 1 || size > MAX_REPORT_SIZE ||
+	    iterations < 1 || enumerations < 0 || seconds < 0 ||
+	    many < 0 || (many > 0 && (!by_id || seconds < 1)) ||
+	    (engine && strcmp(engine, "default") && strcmp(engine, "io_uring")))
+		usage(argv[0]);
+
+	if (many > 0)
+		syscall_fd = open_syscall_counter();
+	if (backend && hid_set_backend(backend) < 0) {
+		fprintf(stderr, "no implementation %s\n", backend);
+		return 1;
+	}
+	if (engine && hid_set_io_engine(strcmp(engine, "io_uring")?
+	        HID_IO_ENGINE_DEFAULT: HID_IO_ENGINE_IO_URING) < 0) {
+		fprintf(stderr, "no engine %s\n", engine);
+		return 1;
+	}
+	if (hid_init() < 0) {
+		fprintf(stderr, "hid_init() failed\n");
+		return 1;
+	}
+	if (many > 0)
+		return bench_many(vendor_id, product_id, many, size, seconds, enumerations,
+			engine? engine: "default", syscall_fd);
+	if (by_id) {
+		found = find_path(vendor_id, product_id);
+		if (!found) {
+			fprintf(stderr, "no device %04x:%04x\n", vendor_id, product_id);
+			return 1;
+		}
+		path = found;
+	}
+
+	printf("{\n  \"backend\": \"%s\",\n  \"path\": ", hid_get_backend());
+	print_string(path);
+	printf(",\n  \"report_size\": %d", size);
+
+	if (enumerations > 0)
+		bench_enumerate(enumerations);
+	bench_open_close(path, iterations);
+
+	hid_device *dev = hid_open_path(path);
+	if (!dev) {
+		printf("\n}\n");
+		fprintf(stderr, "unable to open %s\n", path);
+		return 1;
+	}
+
+	unsigned char report[MAX_REPORT_SIZE];
+	memset(report, 0, size);
+	report[0] = report_id;
+
+	if (seconds > 0)
+		bench_read(dev, size, seconds);
+	if (output) {
+		bench_write(dev, report, size, iterations);
+		bench_round_trip(dev, report, size, iterations);
+	}
+	if (feature)
+		bench_feature(dev, report_id, size, iterations, output);
+	printf("\n}\n");
+
+	hid_close(dev);
+	free(found);
+	hid_exit();
+	return 0;
+}
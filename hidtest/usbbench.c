@@ -0,0 +1,196 @@
+/*******************************************************
+ HIDAPI - Multi-Platform library for
+ communication with HID devices.
+
+ usbbench - measures hid-libusb.c on a simulated USB bus
+ and prints the results as JSON.
+
+ At the discretion of the user of this library,
+ this software may be licensed under the terms of the
+ GNU Public License v3, a BSD-Style license, or the
+ original HIDAPI license as outlined in the LICENSE.txt,
+ LICENSE-gpl3.txt, LICENSE-bsd.txt, and LICENSE-orig.txt
+ files located at the root of the source distribution.
+ These files may also be found in the public source
+ code repository located at:
+        http://github.com/signal11/hidapi .
+********************************************************/
+
+/* Built with usbsim.c in place of libusb, see linux/Makefile. It opens
+   every device on the bus, lets them send Input reports for a while and
+   reports how many reached the library and what that cost the process.
+
+   Only the calls hid-libusb.c has always had are used, so it builds
+   against any revision of it, to compare one with another. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include "hidapi.h"
+#include "usbsim.h"
+
+#define MAX_DEVICES 1024
+#define MAX_REPORT_SIZE 1024
+
+struct reader {
+	hid_device *dev;
+	pthread_t thread;
+	unsigned long long reports;
+};
+
+static int report_size = 64;
+static volatile int stop;
+
+static double now_s(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static double cpu_s(const struct rusage *r)
+{
+	return r->ru_utime.tv_sec + r->ru_utime.tv_usec / 1e6 +
+		r->ru_stime.tv_sec + r->ru_stime.tv_usec / 1e6;
+}
+
+static void *read_reports(void *param)
+{
+	struct reader *r = param;
+	unsigned char buf[MAX_REPORT_SIZE];
+
+	while (!stop) {
+		if (hid_read_timeout(r->dev, buf, report_size, 100) > 0)
+			__atomic_add_fetch(&r->reports, 1, __ATOMIC_RELAXED);
+	}
+	return NULL;
+}
+
+static unsigned long long reports_read(struct reader *readers, int count)
+{
+	unsigned long long total = 0;
+	int i;
+
+	for (i = 0; i < count; i++)
+		total += __atomic_load_n(&readers[i].reports, __ATOMIC_RELAXED);
+	return total;
+}
+
+static void usage(const char *name)
+{
+	fprintf(stderr,
+		"usage: %s [options]\n"
+		"  -n COUNT    devices on the bus (default 1)\n"
+		"  -i US       time between two bus frames in microseconds, or 0\n"
+		"              to complete transfers as fast as they are submitted\n"
+		"              (default 1000)\n"
+		"  -b COUNT    Input reports each device sends per frame (default 1)\n"
+		"  -s SIZE     report size (default 64)\n"
+		"  -t SECONDS  how long to measure (default 2)\n"
+		"  -r          read the reports, with a thread per device; without\n"
+		"              it they fill the queues, which then drop the oldest\n",
+		name);
+	exit(2);
+}
+
+int main(int argc, char* argv[])
+{
+	struct hid_device_info *devs, *cur;
+	struct reader *readers;
+	struct rusage ru_start, ru_end;
+	double t, open_s, close_s, elapsed, cpu;
+	unsigned long long reports, read;
+	long switches;
+	int num_devices = 1, interval_us = 1000, burst = 1, seconds = 2;
+	int reading = 0, opened = 0;
+	int c, i;
+
+	while ((c = getopt(argc, argv, "n:i:b:s:t:r")) != -1) {
+		switch (c) {
+		case 'n': num_devices = atoi(optarg); break;
+		case 'i': interval_us = atoi(optarg); break;
+		case 'b': burst = atoi(optarg); break;
+		case 's': report_size = atoi(optarg); break;
+		case 't': seconds = atoi(optarg); break;
+		case 'r': reading = 1; break;
+		default: usage(argv[0]);
+		}
+	}
+	if (num_devices > MAX_DEVICES || report_size > MAX_REPORT_SIZE || seconds < 1 ||
+	    usbsim_configure(num_devices, interval_us, burst, report_size) < 0)
+		usage(argv[0]);
+
+	if (hid_init() < 0) {
+		fprintf(stderr, "hid_init() failed\n");
+		return 1;
+	}
+
+	readers = calloc(num_devices, sizeof(struct reader));
+	devs = hid_enumerate(0x0, 0x0);
+	t = now_s();
+	for (cur = devs; cur && opened < num_devices; cur = cur->next) {
+		readers[opened].dev = hid_open_path(cur->path);
+		if (!readers[opened].dev) {
+			fprintf(stderr, "unable to open %s\n", cur->path);
+			return 1;
+		}
+		opened++;
+	}
+	open_s = now_s() - t;
+	hid_free_enumeration(devs);
+
+	if (reading) {
+		for (i = 0; i < opened; i++)
+			pthread_create(&readers[i].thread, NULL, read_reports, &readers[i]);
+	}
+
+	/* The first frames include starting up. */
+	usleep(100000);
+	getrusage(RUSAGE_SELF, &ru_start);
+	reports = usbsim_reports();
+	read = reports_read(readers, opened);
+	t = now_s();
+	sleep(seconds);
+	getrusage(RUSAGE_SELF, &ru_end);
+	reports = usbsim_reports() - reports;
+	read = reports_read(readers, opened) - read;
+	elapsed = now_s() - t;
+
+	stop = 1;
+	if (reading) {
+		for (i = 0; i < opened; i++)
+			pthread_join(readers[i].thread, NULL);
+	}
+
+	t = now_s();
+	for (i = 0; i < opened; i++)
+		hid_close(readers[i].dev);
+	close_s = now_s() - t;
+	hid_exit();
+
+	cpu = cpu_s(&ru_end) - cpu_s(&ru_start);
+	switches = (ru_end.ru_nvcsw - ru_start.ru_nvcsw) + (ru_end.ru_nivcsw - ru_start.ru_nivcsw);
+
+	printf("{\n  \"devices\": %d,\n  \"interval_us\": %d,\n  \"burst\": %d,\n  \"report_size\": %d",
+		opened, interval_us, burst, report_size);
+	printf(",\n  \"open_ms\": %.3f", open_s * 1e3);
+	printf(",\n  \"reports_per_s\": %.0f", reports / elapsed);
+	/* The share of what the bus offered which the library took */
+	if (interval_us > 0)
+		printf(",\n  \"bus_percent\": %.1f",
+			100.0 * reports / elapsed / ((double) opened * burst * 1e6 / interval_us));
+	if (reading)
+		printf(",\n  \"read_per_s\": %.0f", read / elapsed);
+	printf(",\n  \"cpu_percent\": %.1f", 100 * cpu / elapsed);
+	printf(",\n  \"cpu_us_per_report\": %.3f", reports? 1e6 * cpu / reports: 0.0);
+	printf(",\n  \"context_switches_per_s\": %.0f", switches / elapsed);
+	printf(",\n  \"close_ms\": %.3f\n}\n", close_s * 1e3);
+
+	free(readers);
+	return 0;
+}
@@ -0,0 +1,524 @@
+/*******************************************************
+ HIDAPI - Multi-Platform library for
+ communication with HID devices.
+
+ usbsim - a simulated USB bus behind the libusb API, so
+ hid-libusb.c can be measured without hardware.
+
+ At the discretion of the user of this library,
+ this software may be licensed under the terms of the
+ GNU Public License v3, a BSD-Style license, or the
+ original HIDAPI license as outlined in the LICENSE.txt,
+ LICENSE-gpl3.txt, LICENSE-bsd.txt, and LICENSE-orig.txt
+ files located at the root of the source distribution.
+ These files may also be found in the public source
+ code repository located at:
+        http://github.com/signal11/hidapi .
+********************************************************/
+
+/* Linked in place of libusb, this defines the calls hid-libusb.c makes,
+   on a bus of identical HID devices. Only the parts which decide how
+   hid-libusb.c performs are modelled:
+
+   - Each frame, every device completes up to its burst of interrupt IN
+     transfers; a transfer submitted again during the frame can complete
+     again in it.
+   - Transfers complete only while a thread handles events, and only one
+     thread at a time does: the others wait until it is done and return,
+     as in libusb_wait_for_event(). Releasing the event lock, after each
+     batch of completions, wakes them all, as libusb does.
+   - A cancelled transfer completes at the next event handling.
+
+   Control and interrupt OUT transfers succeed at once, and the report
+   descriptor has no Report IDs. There are no strings and no hotplug. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+
+/* Declared with enum parameters by older versions of libusb.h and int
+   ones by newer; hidden so the definition below fits either. */
+#define libusb_hotplug_register_callback libusb_hotplug_register_callback_declared
+#include <libusb.h>
+#undef libusb_hotplug_register_callback
+
+#include "usbsim.h"
+
+#define MAX_DEVICES 1024
+#define VENDOR_ID 0x1209
+#define IN_ENDPOINT 0x81
+#define OUT_ENDPOINT 0x01
+
+struct libusb_context {
+	int unused;
+};
+
+struct libusb_device {
+	int index;
+	/* Reports it may still send in this frame */
+	int budget;
+	unsigned long long sequence;
+};
+
+struct libusb_device_handle {
+	struct libusb_device *dev;
+};
+
+static int num_devices = 1;
+static int interval_ns = 1000000;
+static int burst = 1;
+static int report_size = 64;
+
+static struct libusb_device devices[MAX_DEVICES];
+static struct libusb_context context;
+
+static struct libusb_endpoint_descriptor endpoints[2];
+static struct libusb_interface_descriptor altsetting;
+static struct libusb_interface interface;
+static struct libusb_config_descriptor config;
+
+/* Protects everything below. */
+static pthread_mutex_t bus_mutex = PTHREAD_MUTEX_INITIALIZER;
+/* Signaled when a transfer is submitted or cancelled, or the handler
+   is interrupted. */
+static pthread_cond_t bus_cond = PTHREAD_COND_INITIALIZER;
+/* Broadcast when the event lock is released. */
+static pthread_cond_t waiters_cond = PTHREAD_COND_INITIALIZER;
+
+/* Submitted, and completed or cancelled but not yet called back. */
+static struct libusb_transfer **submitted, **completed;
+static int num_submitted, num_completed, max_transfers;
+
+static int events_locked;
+static int interrupted;
+static struct timespec next_frame;
+
+static unsigned long long reports;
+
+int usbsim_configure(int devices_, int interval_us, int burst_, int report_size_)
+{
+	if (devices_ < 1 || devices_ > MAX_DEVICES || interval_us < 0 ||
+	    burst_ < 1 || report_size_ < 1 || report_size_ > 1024)
+		return -1;
+	num_devices = devices_;
+	interval_ns = interval_us * 1000;
+	burst = burst_;
+	report_size = report_size_;
+	return 0;
+}
+
+unsigned long long usbsim_reports(void)
+{
+	return __atomic_load_n(&reports, __ATOMIC_RELAXED);
+}
+
+static void add_ns(struct timespec *ts, long long ns)
+{
+	ns += ts->tv_nsec;
+	ts->tv_sec += ns / 1000000000;
+	ts->tv_nsec = ns % 1000000000;
+}
+
+static int before(const struct timespec *a, const struct timespec *b)
+{
+	return a->tv_sec < b->tv_sec ||
+		(a->tv_sec == b->tv_sec && a->tv_nsec < b->tv_nsec);
+}
+
+/* Makes room for one more transfer. A transfer is on at most one of
+   the lists, so both hold max_transfers. */
+static int reserve(void)
+{
+	struct libusb_transfer **list;
+	int max;
+
+	if (num_submitted + num_completed < max_transfers)
+		return 0;
+	max = max_transfers? 2 * max_transfers: 64;
+	list = realloc(submitted, max * sizeof(*list));
+	if (!list)
+		return LIBUSB_ERROR_NO_MEM;
+	submitted = list;
+	list = realloc(completed, max * sizeof(*list));
+	if (!list)
+		return LIBUSB_ERROR_NO_MEM;
+	completed = list;
+	max_transfers = max;
+	return 0;
+}
+
+/* Starts a frame if one is due, and moves the transfers which complete
+   in it to the completed list. */
+static void run_frame(void)
+{
+	struct timespec now;
+	int i;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	if (interval_ns == 0 || !before(&now, &next_frame)) {
+		for (i = 0; i < num_devices; i++)
+			devices[i].budget = burst;
+		add_ns(&next_frame, interval_ns);
+		/* Don't try to catch up after a long stall. */
+		if (before(&next_frame, &now)) {
+			next_frame = now;
+			add_ns(&next_frame, interval_ns);
+		}
+	}
+
+	for (i = 0; i < num_submitted; ) {
+		struct libusb_transfer *transfer = submitted[i];
+		struct libusb_device *dev = transfer->dev_handle->dev;
+		if (transfer->endpoint == IN_ENDPOINT && dev->budget > 0) {
+			int len = transfer->length < report_size? transfer->length: report_size;
+			int j;
+			for (j = 0; j < len; j++)
+				transfer->buffer[j] = (dev->sequence + j) & 0xff;
+			dev->sequence++;
+			dev->budget--;
+			transfer->status = LIBUSB_TRANSFER_COMPLETED;
+			transfer->actual_length = len;
+			submitted[i] = submitted[--num_submitted];
+			completed[num_completed++] = transfer;
+		}
+		else
+			i++;
+	}
+}
+
+int libusb_init(libusb_context **ctx)
+{
+	struct libusb_endpoint_descriptor *in = &endpoints[0], *out = &endpoints[1];
+	int i;
+
+	memset(devices, 0, sizeof(devices));
+	for (i = 0; i < num_devices; i++)
+		devices[i].index = i;
+
+	memset(endpoints, 0, sizeof(endpoints));
+	in->bEndpointAddress = IN_ENDPOINT;
+	in->bmAttributes = LIBUSB_TRANSFER_TYPE_INTERRUPT;
+	in->wMaxPacketSize = report_size;
+	out->bEndpointAddress = OUT_ENDPOINT;
+	out->bmAttributes = LIBUSB_TRANSFER_TYPE_INTERRUPT;
+	out->wMaxPacketSize = report_size;
+
+	memset(&altsetting, 0, sizeof(altsetting));
+	altsetting.bInterfaceNumber = 0;
+	altsetting.bInterfaceClass = LIBUSB_CLASS_HID;
+	altsetting.bNumEndpoints = 2;
+	altsetting.endpoint = endpoints;
+	memset(&interface, 0, sizeof(interface));
+	interface.altsetting = &altsetting;
+	interface.num_altsetting = 1;
+	memset(&config, 0, sizeof(config));
+	config.bNumInterfaces = 1;
+	config.interface = &interface;
+
+	clock_gettime(CLOCK_MONOTONIC, &next_frame);
+	if (ctx)
+		*ctx = &context;
+	return 0;
+}
+
+void libusb_exit(libusb_context *ctx)
+{
+	pthread_mutex_lock(&bus_mutex);
+	free(submitted);
+	free(completed);
+	submitted = completed = NULL;
+	num_submitted = num_completed = max_transfers = 0;
+	pthread_mutex_unlock(&bus_mutex);
+}
+
+ssize_t libusb_get_device_list(libusb_context *ctx, libusb_device ***list)
+{
+	int i;
+
+	*list = calloc(num_devices + 1, sizeof(libusb_device *));
+	if (!*list)
+		return LIBUSB_ERROR_NO_MEM;
+	for (i = 0; i < num_devices; i++)
+		(*list)[i] = &devices[i];
+	return num_devices;
+}
+
+void libusb_free_device_list(libusb_device **list, int unref_devices)
+{
+	free(list);
+}
+
+libusb_device *libusb_ref_device(libusb_device *dev)
+{
+	return dev;
+}
+
+void libusb_unref_device(libusb_device *dev)
+{
+}
+
+int libusb_get_device_descriptor(libusb_device *dev, struct libusb_device_descriptor *desc)
+{
+	memset(desc, 0, sizeof(*desc));
+	desc->bDeviceClass = LIBUSB_CLASS_PER_INTERFACE;
+	desc->idVendor = VENDOR_ID;
+	desc->idProduct = dev->index + 1;
+	desc->bcdDevice = 0x0100;
+	return 0;
+}
+
+int libusb_get_active_config_descriptor(libusb_device *dev, struct libusb_config_descriptor **desc)
+{
+	*desc = &config;
+	return 0;
+}
+
+int libusb_get_config_descriptor(libusb_device *dev, uint8_t index, struct libusb_config_descriptor **desc)
+{
+	*desc = &config;
+	return 0;
+}
+
+void libusb_free_config_descriptor(struct libusb_config_descriptor *desc)
+{
+}
+
+/* 127 devices to a bus, as on a real one. */
+uint8_t libusb_get_bus_number(libusb_device *dev)
+{
+	return 1 + dev->index / 127;
+}
+
+uint8_t libusb_get_device_address(libusb_device *dev)
+{
+	return 1 + dev->index % 127;
+}
+
+int libusb_open(libusb_device *dev, libusb_device_handle **handle)
+{
+	*handle = calloc(1, sizeof(libusb_device_handle));
+	if (!*handle)
+		return LIBUSB_ERROR_NO_MEM;
+	(*handle)->dev = dev;
+	return 0;
+}
+
+void libusb_close(libusb_device_handle *handle)
+{
+	free(handle);
+}
+
+int libusb_kernel_driver_active(libusb_device_handle *handle, int interface_number)
+{
+	return 0;
+}
+
+int libusb_detach_kernel_driver(libusb_device_handle *handle, int interface_number)
+{
+	return 0;
+}
+
+int libusb_attach_kernel_driver(libusb_device_handle *handle, int interface_number)
+{
+	return 0;
+}
+
+int libusb_claim_interface(libusb_device_handle *handle, int interface_number)
+{
+	return 0;
+}
+
+int libusb_release_interface(libusb_device_handle *handle, int interface_number)
+{
+	return 0;
+}
+
+int libusb_control_transfer(libusb_device_handle *handle, uint8_t request_type,
+	uint8_t request, uint16_t value, uint16_t index, unsigned char *data,
+	uint16_t length, unsigned int timeout)
+{
+	/* Vendor page, report_size bytes of Input, Output and Feature. */
+	const unsigned char descriptor[] = {
+		0x06, 0x00, 0xff, 0x09, 0x01, 0xa1, 0x01, 0x15, 0x00,
+		0x26, 0xff, 0x00, 0x75, 0x08,
+		0x96, report_size & 0xff, report_size >> 8,
+		0x09, 0x01, 0x81, 0x02, 0x09, 0x01, 0x91, 0x02,
+		0x09, 0x01, 0xb1, 0x02, 0xc0,
+	};
+
+	if ((request_type & LIBUSB_ENDPOINT_DIR_MASK) == LIBUSB_ENDPOINT_IN) {
+		if (request == LIBUSB_REQUEST_GET_DESCRIPTOR && (value >> 8) == LIBUSB_DT_REPORT) {
+			if (length > sizeof(descriptor))
+				length = sizeof(descriptor);
+			memcpy(data, descriptor, length);
+			return length;
+		}
+		/* No strings, or other descriptors */
+		if (request == LIBUSB_REQUEST_GET_DESCRIPTOR)
+			return LIBUSB_ERROR_PIPE;
+		/* A Feature report of zeros, after its number */
+		memset(data + 1, 0, length > 1? length - 1: 0);
+	}
+	return length;
+}
+
+int libusb_interrupt_transfer(libusb_device_handle *handle, unsigned char endpoint,
+	unsigned char *data, int length, int *transferred, unsigned int timeout)
+{
+	*transferred = length;
+	return 0;
+}
+
+struct libusb_transfer *libusb_alloc_transfer(int iso_packets)
+{
+	return calloc(1, sizeof(struct libusb_transfer));
+}
+
+void libusb_free_transfer(struct libusb_transfer *transfer)
+{
+	free(transfer);
+}
+
+int libusb_submit_transfer(struct libusb_transfer *transfer)
+{
+	int res;
+
+	pthread_mutex_lock(&bus_mutex);
+	res = reserve();
+	if (res == 0) {
+		submitted[num_submitted++] = transfer;
+		if (interval_ns == 0)
+			pthread_cond_signal(&bus_cond);
+	}
+	pthread_mutex_unlock(&bus_mutex);
+	return res;
+}
+
+int libusb_cancel_transfer(struct libusb_transfer *transfer)
+{
+	int res = LIBUSB_ERROR_NOT_FOUND;
+	int i;
+
+	pthread_mutex_lock(&bus_mutex);
+	for (i = 0; i < num_submitted; i++) {
+		if (submitted[i] == transfer) {
+			submitted[i] = submitted[--num_submitted];
+			transfer->status = LIBUSB_TRANSFER_CANCELLED;
+			transfer->actual_length = 0;
+			completed[num_completed++] = transfer;
+			pthread_cond_signal(&bus_cond);
+			res = 0;
+			break;
+		}
+	}
+	pthread_mutex_unlock(&bus_mutex);
+	return res;
+}
+
+void libusb_interrupt_event_handler(libusb_context *ctx)
+{
+	pthread_mutex_lock(&bus_mutex);
+	interrupted = 1;
+	pthread_cond_signal(&bus_cond);
+	pthread_mutex_unlock(&bus_mutex);
+}
+
+int libusb_handle_events_timeout_completed(libusb_context *ctx, struct timeval *tv, int *done)
+{
+	struct libusb_transfer **batch;
+	struct timespec deadline;
+	int count, i;
+
+	clock_gettime(CLOCK_REALTIME, &deadline);
+	add_ns(&deadline, tv->tv_sec * 1000000000LL + tv->tv_usec * 1000LL);
+
+	pthread_mutex_lock(&bus_mutex);
+	if (events_locked) {
+		/* Another thread is handling events. */
+		pthread_cond_timedwait(&waiters_cond, &bus_mutex, &deadline);
+		pthread_mutex_unlock(&bus_mutex);
+		return 0;
+	}
+	events_locked = 1;
+
+	for (;;) {
+		struct timespec now, wake;
+		run_frame();
+		if (num_completed > 0 || interrupted || (done && *done))
+			break;
+
+		/* Sleep until the next frame, or the deadline if sooner. */
+		clock_gettime(CLOCK_REALTIME, &now);
+		if (!before(&now, &deadline))
+			break;
+		if (interval_ns == 0 && num_submitted > 0)
+			continue;
+		wake = now;
+		if (interval_ns > 0) {
+			struct timespec mono;
+			clock_gettime(CLOCK_MONOTONIC, &mono);
+			add_ns(&wake, (next_frame.tv_sec - mono.tv_sec) * 1000000000LL +
+				next_frame.tv_nsec - mono.tv_nsec);
+		}
+		if (interval_ns == 0 || before(&deadline, &wake))
+			wake = deadline;
+		if (pthread_cond_timedwait(&bus_cond, &bus_mutex, &wake) == EINVAL)
+			break;
+	}
+	interrupted = 0;
+
+	/* The lists may move while the callbacks submit again. */
+	count = num_completed;
+	batch = count? malloc(count * sizeof(*batch)): NULL;
+	if (batch) {
+		memcpy(batch, completed, count * sizeof(*batch));
+		num_completed = 0;
+	}
+	else
+		count = 0;
+	pthread_mutex_unlock(&bus_mutex);
+
+	/* Called back without the lock, since they submit again. */
+	for (i = 0; i < count; i++) {
+		if (batch[i]->status == LIBUSB_TRANSFER_COMPLETED)
+			__atomic_add_fetch(&reports, 1, __ATOMIC_RELAXED);
+		batch[i]->callback(batch[i]);
+	}
+	free(batch);
+
+	pthread_mutex_lock(&bus_mutex);
+	events_locked = 0;
+	pthread_cond_broadcast(&waiters_cond);
+	pthread_mutex_unlock(&bus_mutex);
+	return 0;
+}
+
+int libusb_handle_events_completed(libusb_context *ctx, int *done)
+{
+	struct timeval tv = { 60, 0 };
+	return libusb_handle_events_timeout_completed(ctx, &tv, done);
+}
+
+int libusb_handle_events(libusb_context *ctx)
+{
+	return libusb_handle_events_completed(ctx, NULL);
+}
+
+int libusb_has_capability(uint32_t capability)
+{
+	return 0;
+}
+
+int libusb_hotplug_register_callback(libusb_context *ctx, int events, int flags,
+	int vendor_id, int product_id, int dev_class, libusb_hotplug_callback_fn fn,
+	void *user_data, libusb_hotplug_callback_handle *handle)
+{
+	return LIBUSB_ERROR_NOT_SUPPORTED;
+}
+
+void libusb_hotplug_deregister_callback(libusb_context *ctx, libusb_hotplug_callback_handle handle)
+{
+}
@@ -0,0 +1,40 @@
+/*******************************************************
+ HIDAPI - Multi-Platform library for
+ communication with HID devices.
+
+ usbsim - a simulated USB bus behind the libusb API.
+
+ At the discretion of the user of this library,
+ this software may be licensed under the terms of the
+ GNU Public License v3, a BSD-Style license, or the
+ original HIDAPI license as outlined in the LICENSE.txt,
+ LICENSE-gpl3.txt, LICENSE-bsd.txt, and LICENSE-orig.txt
+ files located at the root of the source distribution.
+ These files may also be found in the public source
+ code repository located at:
+        http://github.com/signal11/hidapi .
+********************************************************/
+
+#ifndef USBSIM_H__
+#define USBSIM_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Sets up the bus, before hid_init(): the number of HID devices on it
+   (1209:0001, 1209:0002...), the time between two frames in
+   microseconds, the number of Input reports each device sends per
+   frame and their size. With an interval of 0, a frame starts each time
+   the library handles events, so the bus is never what limits it. */
+int usbsim_configure(int devices, int interval_us, int burst, int report_size);
+
+/* The number of Input reports which reached the library, that is the
+   interrupt IN transfers which completed. */
+unsigned long long usbsim_reports(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
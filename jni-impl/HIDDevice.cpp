@@ -8,25 +8,35 @@
 
 #define MAX_BUFFER_SIZE 2014
 
+/* Reports are staged on the stack by the region natives. 4096 is the
+   largest report hidraw or libusb will deliver, so reads never need
+   more; only a larger write falls back to the heap. */
+#define REPORT_STACK_SIZE 4096
+
 static hid_device* getPeer(JNIEnv *env, jobject self)
 {
-    jclass cls = env->FindClass(DEV_CLASS);
-    assert(cls!=NULL);
-    if (cls == NULL) 
-        return NULL;
-    jfieldID fid = env->GetFieldID(cls, "peer", "J");
-    return (hid_device*)(env->GetLongField(self, fid));
+    return (hid_device*)(env->GetLongField(self, jcache.devicePeer));
 }
 
 static void setPeer(JNIEnv *env, jobject self, hid_device *peer)
 {
-    jclass cls = env->FindClass(DEV_CLASS);
-    assert(cls!=NULL);
-    if (cls == NULL) 
-        return; //TODO: exception will be raised by FindClass
-    jfieldID fid = env->GetFieldID(cls, "peer", "J");
     jlong peerj = (jlong)peer;
-    env->SetLongField(self, fid, peerj);     
+    env->SetLongField(self, jcache.devicePeer, peerj);     
+}
+
+/* Returns the address of byte 'offset' of a direct buffer, or NULL with
+   an exception pending if the JVM does not give access to the memory. */
+static unsigned char* getDirectAddress(JNIEnv *env, jobject buf, jint offset)
+{
+    unsigned char *addr = (unsigned char*) env->GetDirectBufferAddress(buf);
+    if(!addr)
+    {
+        jclass cls = env->FindClass("java/lang/IllegalArgumentException");
+        if(cls)
+            env->ThrowNew(cls, "buffer is not a direct buffer");
+        return NULL;
+    }
+    return addr + offset;
 }
 
 JNIEXPORT void JNICALL Java_com_codeminders_hidapi_HIDDevice_close
@@ -38,8 +48,19 @@ JNIEXPORT void JNICALL Java_com_codeminders_hidapi_HIDDevice_close
         throwIOException(env, peer);
         return; /* not an error, freed previously */ 
     }
+
+    /* Unregisters the MBean; the device is freed even if that fails. */
+    env->CallVoidMethod(self, jcache.deviceClosing);
+    jthrowable failed = env->ExceptionOccurred();
+    if(failed)
+        env->ExceptionClear();
+
+    stopInputDispatch(env, peer);
     hid_close(peer);
     setPeer(env, self, NULL);
+
+    if(failed)
+        env->Throw(failed);
 }
 
 JNIEXPORT jint JNICALL Java_com_codeminders_hidapi_HIDDevice_write
@@ -52,10 +73,12 @@ JNIEXPORT jint JNICALL Java_com_codeminders_hidapi_HIDDevice_write
         return 0; /* not an error, freed previously */ 
     }
 
+    jobject event = beginEvent(env, HID_EVENT_WRITE);
     jsize bufsize = env->GetArrayLength(data);
     jbyte *buf = env->GetByteArrayElements(data, NULL);
     int res = hid_write(peer, (const unsigned char*) buf, bufsize);
     env->ReleaseByteArrayElements(data, buf, JNI_ABORT);
+    endWriteEvent(env, event, self, res);
     if(res==-1)
     {
         throwIOException(env, peer);
@@ -74,10 +97,12 @@ JNIEXPORT jint JNICALL Java_com_codeminders_hidapi_HIDDevice_read
         return 0; /* not an error, freed previously */ 
     }
 
+    jobject event = beginEvent(env, HID_EVENT_READ);
     jsize bufsize = env->GetArrayLength(data);
     jbyte *buf = env->GetByteArrayElements(data, NULL);
     int read = hid_read(peer, (unsigned char*) buf, bufsize);
     env->ReleaseByteArrayElements(data, buf, read==-1?JNI_ABORT:0);
+    endReadEvent(env, event, self, read, read > 0 ? 1 : 0, -1);
     if(read==-1)
     {
         throwIOException(env, peer);
@@ -96,10 +121,12 @@ JNIEXPORT jint JNICALL Java_com_codeminders_hidapi_HIDDevice_readTimeout
         return 0; /* not an error, freed previously */ 
     }
     
+    jobject event = beginEvent(env, HID_EVENT_READ);
     jsize bufsize = env->GetArrayLength(data);
     jbyte *buf = env->GetByteArrayElements(data, NULL);
     int read = hid_read_timeout(peer, (unsigned char*) buf, bufsize, milliseconds);
     env->ReleaseByteArrayElements(data, buf, read==-1?JNI_ABORT:0);
+    endReadEvent(env, event, self, read, read > 0 ? 1 : 0, milliseconds);
     if(read == 0) /* time out */
     {
         return 0;
@@ -112,6 +139,200 @@ JNIEXPORT jint JNICALL Java_com_codeminders_hidapi_HIDDevice_readTimeout
     return read;
 }
 
+JNIEXPORT jint JNICALL Java_com_codeminders_hidapi_HIDDevice_writeRegion
+  (JNIEnv *env, jobject self, jbyteArray data, jint off, jint len)
+{
+    hid_device *peer = getPeer(env, self);
+    if(!peer) 
+    {
+        throwIOException(env, peer);
+        return 0; /* not an error, freed previously */ 
+    }
+
+    jbyte stackbuf[REPORT_STACK_SIZE];
+    jbyte *buf = len <= REPORT_STACK_SIZE ? stackbuf : (jbyte*) malloc(len);
+    if(!buf)
+    {
+        jclass cls = env->FindClass("java/lang/OutOfMemoryError");
+        if(cls)
+            env->ThrowNew(cls, "no memory for the report");
+        return 0;
+    }
+    env->GetByteArrayRegion(data, off, len, buf);
+    int res = hid_write(peer, (const unsigned char*) buf, len);
+    if(buf != stackbuf)
+        free(buf);
+    if(res==-1)
+    {
+        throwIOException(env, peer);
+        return 0;
+    }
+    return res;
+}
+
+/* Reads a report into a native buffer and copies only the bytes
+   received into data[off..]. With blocking, hid_read() is used, which
+   honors the mode set with enableBlocking()/disableBlocking(), and
+   milliseconds is ignored. */
+static jint readRegion(JNIEnv *env, jobject self, jbyteArray data, jint off, jint len, bool blocking, jint milliseconds)
+{
+    hid_device *peer = getPeer(env, self);
+    if(!peer) 
+    {
+        throwIOException(env, peer);
+        return 0; /* not an error, freed previously */ 
+    }
+
+    jbyte buf[REPORT_STACK_SIZE];
+    if(len > REPORT_STACK_SIZE)
+        len = REPORT_STACK_SIZE;
+    int read = blocking
+        ? hid_read(peer, (unsigned char*) buf, len)
+        : hid_read_timeout(peer, (unsigned char*) buf, len, milliseconds);
+    if(read > 0)
+        env->SetByteArrayRegion(data, off, read, buf);
+    if(read==-1)
+    {
+        throwIOException(env, peer);
+        return 0;
+    }
+    return read;
+}
+
+JNIEXPORT jint JNICALL Java_com_codeminders_hidapi_HIDDevice_readRegion
+  (JNIEnv *env, jobject self, jbyteArray data, jint off, jint len)
+{
+    return readRegion(env, self, data, off, len, true, 0);
+}
+
+JNIEXPORT jint JNICALL Java_com_codeminders_hidapi_HIDDevice_readTimeoutRegion
+  (JNIEnv *env, jobject self, jbyteArray data, jint off, jint len, jint milliseconds)
+{
+    return readRegion(env, self, data, off, len, false, milliseconds);
+}
+
+JNIEXPORT jint JNICALL Java_com_codeminders_hidapi_HIDDevice_readSequencedNative
+  (JNIEnv *env, jobject self, jbyteArray data, jlongArray sequence, jlongArray timestamp, jint milliseconds)
+{
+    hid_device *peer = getPeer(env, self);
+    if(!peer) 
+    {
+        throwIOException(env, peer);
+        return 0; /* not an error, freed previously */ 
+    }
+
+    jsize len = env->GetArrayLength(data);
+    jbyte buf[REPORT_STACK_SIZE];
+    if(len > REPORT_STACK_SIZE)
+        len = REPORT_STACK_SIZE;
+    unsigned long long seq = 0, ts = 0;
+    int read = hid_read_sequenced(peer, (unsigned char*) buf, len, &seq, &ts, milliseconds);
+    if(read > 0)
+    {
+        jlong seqj = (jlong) seq, tsj = (jlong) ts;
+        env->SetByteArrayRegion(data, 0, read, buf);
+        if(sequence)
+            env->SetLongArrayRegion(sequence, 0, 1, &seqj);
+        if(timestamp)
+            env->SetLongArrayRegion(timestamp, 0, 1, &tsj);
+    }
+    if(read==-1)
+    {
+        throwIOException(env, peer);
+        return 0;
+    }
+    return read;
+}
+
+JNIEXPORT jint JNICALL Java_com_codeminders_hidapi_HIDDevice_writeDirect
+  (JNIEnv *env, jobject self, jobject data, jint offset, jint length)
+{
+    hid_device *peer = getPeer(env, self);
+    if(!peer) 
+    {
+        throwIOException(env, peer);
+        return 0; /* not an error, freed previously */ 
+    }
+
+    unsigned char *buf = getDirectAddress(env, data, offset);
+    if(!buf)
+        return 0; /* exception thrown */
+    int res = hid_write(peer, buf, length);
+    if(res==-1)
+    {
+        throwIOException(env, peer);
+        return 0;
+    }
+    return res;
+}
+
+JNIEXPORT jint JNICALL Java_com_codeminders_hidapi_HIDDevice_readDirect
+  (JNIEnv *env, jobject self, jobject data, jint offset, jint length)
+{
+    hid_device *peer = getPeer(env, self);
+    if(!peer) 
+    {
+        throwIOException(env, peer);
+        return 0; /* not an error, freed previously */ 
+    }
+
+    unsigned char *buf = getDirectAddress(env, data, offset);
+    if(!buf)
+        return 0; /* exception thrown */
+    int read = hid_read(peer, buf, length);
+    if(read==-1)
+    {
+        throwIOException(env, peer);
+        return 0;
+    }
+    return read;
+}
+
+JNIEXPORT jint JNICALL Java_com_codeminders_hidapi_HIDDevice_readTimeoutDirect
+  (JNIEnv *env, jobject self, jobject data, jint offset, jint length, jint milliseconds)
+{
+    hid_device *peer = getPeer(env, self);
+    if(!peer) 
+    {
+        throwIOException(env, peer);
+        return 0; /* not an error, freed previously */ 
+    }
+
+    unsigned char *buf = getDirectAddress(env, data, offset);
+    if(!buf)
+        return 0; /* exception thrown */
+    int read = hid_read_timeout(peer, buf, length, milliseconds);
+    if(read==-1)
+    {
+        throwIOException(env, peer);
+        return 0;
+    }
+    return read; /* 0 on time out */
+}
+
+JNIEXPORT jint JNICALL Java_com_codeminders_hidapi_HIDDevice_readManyDirect
+  (JNIEnv *env, jobject self, jobject data, jint offset, jint length, jint maxReports, jint milliseconds)
+{
+    hid_device *peer = getPeer(env, self);
+    if(!peer) 
+    {
+        throwIOException(env, peer);
+        return 0; /* not an error, freed previously */ 
+    }
+
+    unsigned char *buf = getDirectAddress(env, data, offset);
+    if(!buf)
+        return 0; /* exception thrown */
+    size_t len = length;
+    int count = hid_read_many(peer, buf, &len, maxReports, milliseconds);
+    if(count==-1)
+    {
+        throwIOException(env, peer);
+        return 0;
+    }
+    return count; /* 0 on time out */
+}
+
 JNIEXPORT void JNICALL Java_com_codeminders_hidapi_HIDDevice_enableBlocking
   (JNIEnv *env, jobject self)
 {
@@ -146,6 +367,184 @@ JNIEXPORT void JNICALL Java_com_codeminders_hidapi_HIDDevice_disableBlocking
     }
 }
 
+JNIEXPORT void JNICALL Java_com_codeminders_hidapi_HIDDevice_setInputQueueNative
+  (JNIEnv *env, jobject self, jint capacity, jint policy)
+{
+    hid_device *peer = getPeer(env, self);
+    if(!peer)
+    {
+        throwIOException(env, peer);
+        return; /* not an error, freed previously */ 
+    }
+    int res = hid_set_input_queue(peer, capacity, policy);
+    if(res!=0)
+    {
+        throwIOException(env, peer);
+        return;
+    }
+}
+
+JNIEXPORT void JNICALL Java_com_codeminders_hidapi_HIDDevice_setInputTransfers
+  (JNIEnv *env, jobject self, jint count)
+{
+    hid_device *peer = getPeer(env, self);
+    if(!peer)
+    {
+        throwIOException(env, peer);
+        return; /* not an error, freed previously */ 
+    }
+    int res = hid_set_input_transfers(peer, count);
+    if(res!=0)
+    {
+        throwIOException(env, peer);
+        return;
+    }
+}
+
+JNIEXPORT jint JNICALL Java_com_codeminders_hidapi_HIDDevice_getPollFd
+  (JNIEnv *env, jobject self)
+{
+    hid_device *peer = getPeer(env, self);
+    if(!peer)
+    {
+        throwIOException(env, peer);
+        return -1; /* not an error, freed previously */ 
+    }
+    int fd = hid_get_poll_fd(peer);
+    if(fd==-1)
+        throwIOException(env, peer);
+    return fd;
+}
+
+JNIEXPORT jlong JNICALL Java_com_codeminders_hidapi_HIDDevice_getDroppedCount
+  (JNIEnv *env, jobject self)
+{
+    hid_device *peer = getPeer(env, self);
+    if(!peer)
+    {
+        throwIOException(env, peer);
+        return 0; /* not an error, freed previously */ 
+    }
+    unsigned long long count = 0;
+    if(hid_get_dropped_count(peer, &count)==-1)
+        throwIOException(env, peer);
+    return (jlong) count;
+}
+
+JNIEXPORT void JNICALL Java_com_codeminders_hidapi_HIDDevice_getStatsNative
+  (JNIEnv *env, jobject self, jlongArray values)
+{
+    hid_device *peer = getPeer(env, self);
+    if(!peer)
+    {
+        throwIOException(env, peer);
+        return; /* not an error, freed previously */ 
+    }
+    struct hid_device_stats stats;
+    if(hid_get_stats(peer, &stats)==-1)
+    {
+        throwIOException(env, peer);
+        return;
+    }
+
+    /* The fields in order, as HIDDeviceStats expects them. */
+    const unsigned long long *src = (const unsigned long long*) &stats;
+    jlong counters[sizeof(stats) / sizeof(*src)];
+    for(size_t i = 0; i < sizeof(stats) / sizeof(*src); i++)
+        counters[i] = (jlong) src[i];
+    env->SetLongArrayRegion(values, 0, sizeof(stats) / sizeof(*src), counters);
+}
+
+JNIEXPORT void JNICALL Java_com_codeminders_hidapi_HIDDevice_getLatencyHistogramNative
+  (JNIEnv *env, jobject self, jint kind, jlongArray values, jboolean reset)
+{
+    hid_device *peer = getPeer(env, self);
+    if(!peer)
+    {
+        throwIOException(env, peer);
+        return; /* not an error, freed previously */ 
+    }
+    struct hid_histogram histogram;
+    if(hid_get_latency_histogram(peer, kind, &histogram, reset)==-1)
+    {
+        throwIOException(env, peer);
+        return;
+    }
+
+    /* count, total, max and the buckets, as LatencyHistogram expects them. */
+    const unsigned long long *src = (const unsigned long long*) &histogram;
+    jlong counters[sizeof(histogram) / sizeof(*src)];
+    for(size_t i = 0; i < sizeof(histogram) / sizeof(*src); i++)
+        counters[i] = (jlong) src[i];
+    env->SetLongArrayRegion(values, 0, sizeof(histogram) / sizeof(*src), counters);
+}
+
+JNIEXPORT void JNICALL Java_com_codeminders_hidapi_HIDDevice_attachInputRing
+  (JNIEnv *env, jobject self, jobject ring, jint offset, jint length)
+{
+    hid_device *peer = getPeer(env, self);
+    if(!peer)
+    {
+        throwIOException(env, peer);
+        return; /* not an error, freed previously */ 
+    }
+
+    unsigned char *buf = getDirectAddress(env, ring, offset);
+    if(!buf)
+        return; /* exception thrown */
+    if(hid_set_input_ring(peer, (struct hid_input_ring*) buf, length)!=0)
+        throwIOException(env, peer);
+}
+
+JNIEXPORT void JNICALL Java_com_codeminders_hidapi_HIDDevice_detachInputRing
+  (JNIEnv *env, jobject self)
+{
+    hid_device *peer = getPeer(env, self);
+    if(!peer)
+        return; /* closed, which detached it */
+    hid_set_input_ring(peer, NULL, 0);
+}
+
+JNIEXPORT jint JNICALL Java_com_codeminders_hidapi_HIDDevice_waitInputRing
+  (JNIEnv *env, jobject self, jint milliseconds)
+{
+    hid_device *peer = getPeer(env, self);
+    if(!peer)
+    {
+        throwIOException(env, peer);
+        return 0; /* not an error, freed previously */ 
+    }
+    int res = hid_input_ring_wait(peer, milliseconds);
+    if(res==-1)
+    {
+        throwIOException(env, peer);
+        return 0;
+    }
+    return res;
+}
+
+JNIEXPORT void JNICALL Java_com_codeminders_hidapi_HIDDevice_startInput
+  (JNIEnv *env, jobject self)
+{
+    hid_device *peer = getPeer(env, self);
+    if(!peer)
+    {
+        throwIOException(env, peer);
+        return; /* not an error, freed previously */ 
+    }
+    if(startInputDispatch(env, self, peer)!=0)
+        throwIOException(env, peer);
+}
+
+JNIEXPORT void JNICALL Java_com_codeminders_hidapi_HIDDevice_stopInput
+  (JNIEnv *env, jobject self)
+{
+    hid_device *peer = getPeer(env, self);
+    if(!peer)
+        return; /* closed, which stopped it */
+    stopInputDispatch(env, peer);
+}
+
 JNIEXPORT jint JNICALL Java_com_codeminders_hidapi_HIDDevice_sendFeatureReport
   (JNIEnv *env, jobject self, jbyteArray data)
 {
@@ -155,10 +554,12 @@ JNIEXPORT jint JNICALL Java_com_codeminders_hidapi_HIDDevice_sendFeatureReport
         throwIOException(env, peer);
         return 0; /* not an error, freed previously */ 
     }
+    jobject event = beginEvent(env, HID_EVENT_FEATURE_REPORT);
     jsize bufsize = env->GetArrayLength(data);
     jbyte *buf = env->GetByteArrayElements(data, NULL);
     int res = hid_send_feature_report(peer, (const unsigned char*) buf, bufsize);
     env->ReleaseByteArrayElements(data, buf, JNI_ABORT);
+    endFeatureReportEvent(env, event, self, JNI_FALSE, res);
     if(res==-1)
     {
         throwIOException(env, peer);
@@ -178,10 +579,12 @@ JNIEXPORT jint JNICALL Java_com_codeminders_hidapi_HIDDevice_getFeatureReport
         return 0; /* not an error, freed previously */ 
     }
 
+    jobject event = beginEvent(env, HID_EVENT_FEATURE_REPORT);
     jsize bufsize = env->GetArrayLength(data);
     jbyte *buf = env->GetByteArrayElements(data, NULL);
     int res = hid_get_feature_report(peer, (unsigned char*) buf, bufsize);
     env->ReleaseByteArrayElements(data, buf, res==-1?JNI_ABORT:0);
+    endFeatureReportEvent(env, event, self, JNI_TRUE, res);
     if(res==-1)
     {
         throwIOException(env, peer);
@@ -191,6 +594,50 @@ JNIEXPORT jint JNICALL Java_com_codeminders_hidapi_HIDDevice_getFeatureReport
     return res;
 }
 
+JNIEXPORT jint JNICALL Java_com_codeminders_hidapi_HIDDevice_sendFeatureReportDirect
+  (JNIEnv *env, jobject self, jobject data, jint offset, jint length)
+{
+    hid_device *peer = getPeer(env, self);
+    if(!peer)
+    {
+        throwIOException(env, peer);
+        return 0; /* not an error, freed previously */ 
+    }
+
+    unsigned char *buf = getDirectAddress(env, data, offset);
+    if(!buf)
+        return 0; /* exception thrown */
+    int res = hid_send_feature_report(peer, buf, length);
+    if(res==-1)
+    {
+        throwIOException(env, peer);
+        return 0;
+    }
+    return res;
+}
+
+JNIEXPORT jint JNICALL Java_com_codeminders_hidapi_HIDDevice_getFeatureReportDirect
+  (JNIEnv *env, jobject self, jobject data, jint offset, jint length)
+{
+    hid_device *peer = getPeer(env, self);
+    if(!peer)
+    {
+        throwIOException(env, peer);
+        return 0; /* not an error, freed previously */ 
+    }
+
+    unsigned char *buf = getDirectAddress(env, data, offset);
+    if(!buf)
+        return 0; /* exception thrown */
+    int res = hid_get_feature_report(peer, buf, length);
+    if(res==-1)
+    {
+        throwIOException(env, peer);
+        return 0;
+    }
+    return res;
+}
+
 JNIEXPORT jstring JNICALL Java_com_codeminders_hidapi_HIDDevice_getManufacturerString
   (JNIEnv *env, jobject self)
 {
@@ -304,3 +751,44 @@ JNIEXPORT jstring JNICALL Java_com_codeminders_hidapi_HIDDevice_getIndexedString
     
     return string;
 }
+
+static JNINativeMethod methods[] = {
+    JNI_NATIVE("close", "()V", Java_com_codeminders_hidapi_HIDDevice_close),
+    JNI_NATIVE("write", "([B)I", Java_com_codeminders_hidapi_HIDDevice_write),
+    JNI_NATIVE("read", "([B)I", Java_com_codeminders_hidapi_HIDDevice_read),
+    JNI_NATIVE("readTimeout", "([BI)I", Java_com_codeminders_hidapi_HIDDevice_readTimeout),
+    JNI_NATIVE("enableBlocking", "()V", Java_com_codeminders_hidapi_HIDDevice_enableBlocking),
+    JNI_NATIVE("disableBlocking", "()V", Java_com_codeminders_hidapi_HIDDevice_disableBlocking),
+    JNI_NATIVE("sendFeatureReport", "([B)I", Java_com_codeminders_hidapi_HIDDevice_sendFeatureReport),
+    JNI_NATIVE("getFeatureReport", "([B)I", Java_com_codeminders_hidapi_HIDDevice_getFeatureReport),
+    JNI_NATIVE("getManufacturerString", "()Ljava/lang/String;", Java_com_codeminders_hidapi_HIDDevice_getManufacturerString),
+    JNI_NATIVE("getProductString", "()Ljava/lang/String;", Java_com_codeminders_hidapi_HIDDevice_getProductString),
+    JNI_NATIVE("getSerialNumberString", "()Ljava/lang/String;", Java_com_codeminders_hidapi_HIDDevice_getSerialNumberString),
+    JNI_NATIVE("getIndexedString", "(I)Ljava/lang/String;", Java_com_codeminders_hidapi_HIDDevice_getIndexedString),
+    JNI_NATIVE("writeRegion", "([BII)I", Java_com_codeminders_hidapi_HIDDevice_writeRegion),
+    JNI_NATIVE("readRegion", "([BII)I", Java_com_codeminders_hidapi_HIDDevice_readRegion),
+    JNI_NATIVE("readTimeoutRegion", "([BIII)I", Java_com_codeminders_hidapi_HIDDevice_readTimeoutRegion),
+    JNI_NATIVE("writeDirect", "(Ljava/nio/ByteBuffer;II)I", Java_com_codeminders_hidapi_HIDDevice_writeDirect),
+    JNI_NATIVE("readDirect", "(Ljava/nio/ByteBuffer;II)I", Java_com_codeminders_hidapi_HIDDevice_readDirect),
+    JNI_NATIVE("readTimeoutDirect", "(Ljava/nio/ByteBuffer;III)I", Java_com_codeminders_hidapi_HIDDevice_readTimeoutDirect),
+    JNI_NATIVE("readManyDirect", "(Ljava/nio/ByteBuffer;IIII)I", Java_com_codeminders_hidapi_HIDDevice_readManyDirect),
+    JNI_NATIVE("sendFeatureReportDirect", "(Ljava/nio/ByteBuffer;II)I", Java_com_codeminders_hidapi_HIDDevice_sendFeatureReportDirect),
+    JNI_NATIVE("getFeatureReportDirect", "(Ljava/nio/ByteBuffer;II)I", Java_com_codeminders_hidapi_HIDDevice_getFeatureReportDirect),
+    JNI_NATIVE("setInputQueueNative", "(II)V", Java_com_codeminders_hidapi_HIDDevice_setInputQueueNative),
+    JNI_NATIVE("setInputTransfers", "(I)V", Java_com_codeminders_hidapi_HIDDevice_setInputTransfers),
+    JNI_NATIVE("getPollFd", "()I", Java_com_codeminders_hidapi_HIDDevice_getPollFd),
+    JNI_NATIVE("attachInputRing", "(Ljava/nio/ByteBuffer;II)V", Java_com_codeminders_hidapi_HIDDevice_attachInputRing),
+    JNI_NATIVE("detachInputRing", "()V", Java_com_codeminders_hidapi_HIDDevice_detachInputRing),
+    JNI_NATIVE("waitInputRing", "(I)I", Java_com_codeminders_hidapi_HIDDevice_waitInputRing),
+    JNI_NATIVE("startInput", "()V", Java_com_codeminders_hidapi_HIDDevice_startInput),
+    JNI_NATIVE("stopInput", "()V", Java_com_codeminders_hidapi_HIDDevice_stopInput),
+    JNI_NATIVE("readSequencedNative", "([B[J[JI)I", Java_com_codeminders_hidapi_HIDDevice_readSequencedNative),
+    JNI_NATIVE("getDroppedCount", "()J", Java_com_codeminders_hidapi_HIDDevice_getDroppedCount),
+    JNI_NATIVE("getStatsNative", "([J)V", Java_com_codeminders_hidapi_HIDDevice_getStatsNative),
+    JNI_NATIVE("getLatencyHistogramNative", "(I[JZ)V", Java_com_codeminders_hidapi_HIDDevice_getLatencyHistogramNative),
+};
+
+int registerHIDDeviceNatives(JNIEnv *env, jclass cls)
+{
+    return env->RegisterNatives(cls, methods, sizeof(methods)/sizeof(methods[0]));
+}
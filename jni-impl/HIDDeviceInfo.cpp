@@ -3,36 +3,59 @@
 #include "hidapi/hidapi.h"
 #include "hid-java.h"
 
-JNIEXPORT jobject JNICALL Java_com_codeminders_hidapi_HIDDeviceInfo_open
-  (JNIEnv *env, jobject obj)
+static jobject openDevice(JNIEnv *env, jobject obj, jstring jpathstr)
 {
-    jclass thiscls = env->FindClass(DEVINFO_CLASS);
-    if (!thiscls)
-        return NULL;
-    
-    jfieldID path_field_id = env->GetFieldID(thiscls, "path", "Ljava/lang/String;");
-    jstring jpathstr = (jstring) env->GetObjectField(obj, path_field_id);
+    jstring jbackendstr = (jstring) env->GetObjectField(obj, jcache.deviceInfoBackend);
+    const char *jbackendbytes = NULL;
 
     const char *jpathbytes = env->GetStringUTFChars(jpathstr, NULL);
     if(!jpathbytes)
         return NULL;
+    if(jbackendstr)
+    {
+        jbackendbytes = env->GetStringUTFChars(jbackendstr, NULL);
+        if(!jbackendbytes)
+        {
+            env->ReleaseStringUTFChars(jpathstr, jpathbytes);
+            return NULL;
+        }
+    }
     
-    hid_device *dev = hid_open_path(jpathbytes);
+    /* The path only means something to the implementation which found it. */
+    hid_device *dev = hid_open_path_backend(jbackendbytes, jpathbytes);
     env->ReleaseStringUTFChars(jpathstr, jpathbytes); 
+    if(jbackendbytes)
+        env->ReleaseStringUTFChars(jbackendstr, jbackendbytes);
     if(!dev)
         return NULL;
     
     jlong peer = (jlong)dev;
     // Construct and return object
-    jclass cls = env->FindClass(DEV_CLASS);
-    if (cls == NULL) {
-        return NULL; /* exception thrown */
-    }
+    jobject device = env->NewObject(jcache.deviceClass, jcache.deviceInit, peer);
+    if(!device)
+        hid_close(dev);
+    return device;
+}
 
-    jmethodID cid = env->GetMethodID(cls,
-                                        "<init>", "(J)V");
-    if (cid == NULL) {
-        return NULL; /* exception thrown */
-    }
-    return env->NewObject(cls, cid, peer);
+JNIEXPORT jobject JNICALL Java_com_codeminders_hidapi_HIDDeviceInfo_open
+  (JNIEnv *env, jobject obj)
+{
+    jstring jpathstr = (jstring) env->GetObjectField(obj, jcache.deviceInfoPath);
+    jobject event = beginEvent(env, HID_EVENT_OPEN);
+    jobject device = openDevice(env, obj, jpathstr);
+    endOpenEvent(env, event, jpathstr, device);
+
+    /* Registers the device's MBean. */
+    if(device)
+        env->CallVoidMethod(device, jcache.deviceOpened, jpathstr);
+    return device;
+}
+
+static JNINativeMethod methods[] = {
+    JNI_NATIVE("open", "()L" DEV_CLASS ";", Java_com_codeminders_hidapi_HIDDeviceInfo_open),
+};
+
+int registerHIDDeviceInfoNatives(JNIEnv *env, jclass cls)
+{
+    return env->RegisterNatives(cls, methods, sizeof(methods)/sizeof(methods[0]));
 }
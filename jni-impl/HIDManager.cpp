@@ -157,53 +157,28 @@ static int hid_exit_loop()
 
 static jobject getPeer(JNIEnv *env, jobject self)
 {
-    jclass cls = env->FindClass(HID_MANAGER_CLASS);
-    assert(cls!=NULL);
-    if (cls == NULL) 
-        return NULL;
-    jfieldID fid = env->GetFieldID(cls, "peer", "J");
-    return (jobject)(env->GetLongField(self, fid));
+    return (jobject)(env->GetLongField(self, jcache.managerPeer));
 }
 
 static void setPeer(JNIEnv *env, jobject self, jobject peer)
 {
-    jclass cls = env->FindClass(HID_MANAGER_CLASS);
-    assert(cls!=NULL);
-    if (cls == NULL) 
-        return; 
-    jfieldID fid = env->GetFieldID(cls, "peer", "J");
     jlong peerj = (jlong)peer;
-    env->SetLongField(self, fid, peerj);     
-}
-
-static void setIntField(JNIEnv *env,
-                        jclass cls,
-                        jobject obj,
-                        const char *name,
-                        int val)
-{
-    jfieldID fid = env->GetFieldID(cls, name, "I");
-    env->SetIntField(obj, fid, val);
+    env->SetLongField(self, jcache.managerPeer, peerj);     
 }
 
 static void setStringField(JNIEnv *env,
-                           jclass cls,
                            jobject obj,
-                           const char *name,
+                           jfieldID fid,
                            const char *val)
 {
-    jfieldID fid = env->GetFieldID(cls, name, "Ljava/lang/String;");
     env->SetObjectField(obj, fid,  val ? env->NewStringUTF(val) : NULL);
 }
 
 static void setUStringField(JNIEnv *env,
-                           jclass cls,
                            jobject obj,
-                           const char *name,
+                           jfieldID fid,
                            const wchar_t *val)
 {
-    jfieldID fid = env->GetFieldID(cls, name, "Ljava/lang/String;");
-
     if(val)
     {
         char *u8 = convertToUTF8(env, val);
@@ -215,35 +190,34 @@ static void setUStringField(JNIEnv *env,
 }
 
 
-static jobject createHIDDeviceInfo(JNIEnv *env, jclass cls, struct hid_device_info *dev)
+jobject createHIDDeviceInfo(JNIEnv *env, struct hid_device_info *dev)
 {
-    jmethodID cid = env->GetMethodID(cls, "<init>", "()V");
-    if (cid == NULL) 
-        return NULL; /* exception thrown. */ 
-    
     if (dev == NULL)
         return NULL;
 
-    jobject result = env->NewObject(cls, cid);
+    jobject result = env->NewObject(jcache.deviceInfoClass, jcache.deviceInfoInit);
+    if (result == NULL)
+        return NULL; /* exception thrown. */ 
 
-    setIntField(env, cls, result, "vendor_id", dev->vendor_id);
-    setIntField(env, cls, result, "product_id", dev->product_id);
-    setIntField(env, cls, result, "release_number", dev->release_number);
-    setIntField(env, cls, result, "usage_page", dev->usage_page);
-    setIntField(env, cls, result, "usage", dev->usage);
-    setIntField(env, cls, result, "interface_number", dev->interface_number);
+    env->SetIntField(result, jcache.deviceInfoVendorId, dev->vendor_id);
+    env->SetIntField(result, jcache.deviceInfoProductId, dev->product_id);
+    env->SetIntField(result, jcache.deviceInfoReleaseNumber, dev->release_number);
+    env->SetIntField(result, jcache.deviceInfoUsagePage, dev->usage_page);
+    env->SetIntField(result, jcache.deviceInfoUsage, dev->usage);
+    env->SetIntField(result, jcache.deviceInfoInterfaceNumber, dev->interface_number);
     
-    setStringField(env, cls, result, "path", dev->path);
-    setUStringField(env, cls, result, "serial_number", dev->serial_number);
-    setUStringField(env, cls, result, "manufacturer_string", dev->manufacturer_string);
-    setUStringField(env, cls, result, "product_string", dev->product_string);
+    setStringField(env, result, jcache.deviceInfoPath, dev->path);
+    setUStringField(env, result, jcache.deviceInfoSerialNumber, dev->serial_number);
+    setUStringField(env, result, jcache.deviceInfoManufacturerString, dev->manufacturer_string);
+    setUStringField(env, result, jcache.deviceInfoProductString, dev->product_string);
+    setStringField(env, result, jcache.deviceInfoBackend, dev->backend);
 
     return result;
 }
-JNIEXPORT jobjectArray JNICALL
-Java_com_codeminders_hidapi_HIDManager_listDevices(JNIEnv *env, jobject obj)
+static jobjectArray enumerate(JNIEnv *env, jstring backend)
 {
     struct hid_device_info *devs, *cur_dev;
+    const char *name = NULL;
     int res = 0;
     
 #ifdef HID_RUN_LOOP    
@@ -261,7 +235,20 @@ Java_com_codeminders_hidapi_HIDManager_listDevices(JNIEnv *env, jobject obj)
         return NULL;
     }
     
-    devs = hid_enumerate(0x0, 0x0);
+    if(backend)
+    {
+        name = env->GetStringUTFChars(backend, NULL);
+        if(!name)
+            return NULL; /* exception thrown */
+    }
+    res = hid_enumerate_backend(name, 0x0, 0x0, &devs);
+    if(name)
+        env->ReleaseStringUTFChars(backend, name);
+    if(res != 0)
+    {
+        env->ThrowNew(jcache.ioExceptionClass, "no such implementation");
+        return NULL;
+    }
     if(devs == NULL)
     {
      /* no exception thrown */
@@ -280,16 +267,12 @@ Java_com_codeminders_hidapi_HIDManager_listDevices(JNIEnv *env, jobject obj)
        cur_dev = cur_dev->next;
     }
 
-    jclass infoCls = env->FindClass(DEVINFO_CLASS);
-    if (infoCls == NULL) {
-        return NULL; /* exception thrown */
-    }
-    jobjectArray result= env->NewObjectArray(size, infoCls, NULL);
+    jobjectArray result= env->NewObjectArray(size, jcache.deviceInfoClass, NULL);
     cur_dev = devs;
     int i=0;
     while(cur_dev)
     {
-        jobject x = createHIDDeviceInfo(env, infoCls, cur_dev);
+        jobject x = createHIDDeviceInfo(env, cur_dev);
         if(x == NULL)
            return NULL; /* exception thrown */ 
 
@@ -303,6 +286,29 @@ Java_com_codeminders_hidapi_HIDManager_listDevices(JNIEnv *env, jobject obj)
     return result;
 }
 
+static jobjectArray listDevices(JNIEnv *env, jstring backend)
+{
+    jobject event = beginEvent(env, HID_EVENT_ENUMERATE);
+    jobjectArray result = enumerate(env, backend);
+    if(env->ExceptionCheck())
+        endEnumerateEvent(env, event, -1);
+    else
+        endEnumerateEvent(env, event, result ? env->GetArrayLength(result) : 0);
+    return result;
+}
+
+JNIEXPORT jobjectArray JNICALL
+Java_com_codeminders_hidapi_HIDManager_listDevices(JNIEnv *env, jobject obj)
+{
+    return listDevices(env, NULL);
+}
+
+JNIEXPORT jobjectArray JNICALL
+Java_com_codeminders_hidapi_HIDManager_listDevicesNative(JNIEnv *env, jobject obj, jstring backend)
+{
+    return listDevices(env, backend);
+}
+
 JNIEXPORT void JNICALL Java_com_codeminders_hidapi_HIDManager_init(JNIEnv *env, jobject obj)
 {
     int res = 0;
@@ -310,7 +316,7 @@ JNIEXPORT void JNICALL Java_com_codeminders_hidapi_HIDManager_init(JNIEnv *env,
     if(NULL == m_env)
     {
       m_env = env;
-      m_env->GetJavaVM( &m_vm );
+      m_vm = jcache.vm;
     }
     
     if(jni_ref_count == 0)
@@ -354,6 +360,8 @@ JNIEXPORT void JNICALL Java_com_codeminders_hidapi_HIDManager_release(JNIEnv *en
     if(jni_ref_count>0){ 
        return;     
     }
+    /* Its monitor must go before the library is shut down. */
+    stopHotplugDispatch(env);
 #ifdef HID_RUN_LOOP    
     res = hid_exit_loop(); 
 #else
@@ -367,3 +375,53 @@ JNIEXPORT void JNICALL Java_com_codeminders_hidapi_HIDManager_release(JNIEnv *en
     printf("JNI Release library!\n");
 #endif
 }
+
+JNIEXPORT void JNICALL Java_com_codeminders_hidapi_HIDManager_setBackend(JNIEnv *env, jobject obj, jstring backend)
+{
+    const char *name = NULL;
+    int res;
+
+    if(backend)
+    {
+        name = env->GetStringUTFChars(backend, NULL);
+        if(!name)
+            return; /* exception thrown */
+    }
+    res = hid_set_backend(name);
+    if(name)
+        env->ReleaseStringUTFChars(backend, name);
+    if(res != 0)
+        env->ThrowNew(jcache.ioExceptionClass, "no such implementation");
+}
+
+JNIEXPORT jstring JNICALL Java_com_codeminders_hidapi_HIDManager_getBackend(JNIEnv *env, jobject obj)
+{
+    return env->NewStringUTF(hid_get_backend());
+}
+
+JNIEXPORT void JNICALL Java_com_codeminders_hidapi_HIDManager_startHotplug(JNIEnv *env, jobject obj)
+{
+    if(startHotplugDispatch(env, obj) != 0)
+        env->ThrowNew(jcache.ioExceptionClass, "hotplug notifications are not supported");
+}
+
+JNIEXPORT void JNICALL Java_com_codeminders_hidapi_HIDManager_stopHotplug(JNIEnv *env, jobject obj)
+{
+    stopHotplugDispatch(env);
+}
+
+static JNINativeMethod methods[] = {
+    JNI_NATIVE("listDevices", "()[L" DEVINFO_CLASS ";", Java_com_codeminders_hidapi_HIDManager_listDevices),
+    JNI_NATIVE("listDevicesNative", "(Ljava/lang/String;)[L" DEVINFO_CLASS ";", Java_com_codeminders_hidapi_HIDManager_listDevicesNative),
+    JNI_NATIVE("setBackend", "(Ljava/lang/String;)V", Java_com_codeminders_hidapi_HIDManager_setBackend),
+    JNI_NATIVE("getBackend", "()Ljava/lang/String;", Java_com_codeminders_hidapi_HIDManager_getBackend),
+    JNI_NATIVE("init", "()V", Java_com_codeminders_hidapi_HIDManager_init),
+    JNI_NATIVE("release", "()V", Java_com_codeminders_hidapi_HIDManager_release),
+    JNI_NATIVE("startHotplug", "()V", Java_com_codeminders_hidapi_HIDManager_startHotplug),
+    JNI_NATIVE("stopHotplug", "()V", Java_com_codeminders_hidapi_HIDManager_stopHotplug),
+};
+
+int registerHIDManagerNatives(JNIEnv *env, jclass cls)
+{
+    return env->RegisterNatives(cls, methods, sizeof(methods)/sizeof(methods[0]));
+}
@@ -0,0 +1,110 @@
+#include <stdlib.h>
+#include <assert.h>
+
+#include <jni-stubs/com_codeminders_hidapi_HIDSelector.h>
+#include "hidapi/hidapi.h"
+#include "hid-java.h"
+
+/* Up to this many ready devices are collected on the stack by
+   waitDevices(); larger arrays fall back to the heap. */
+#define READY_STACK_SIZE 64
+
+static hid_reactor* getPeer(JNIEnv *env, jobject self)
+{
+    return (hid_reactor*)(env->GetLongField(self, jcache.selectorPeer));
+}
+
+static void setPeer(JNIEnv *env, jobject self, hid_reactor *peer)
+{
+    jlong peerj = (jlong)peer;
+    env->SetLongField(self, jcache.selectorPeer, peerj);     
+}
+
+JNIEXPORT void JNICALL Java_com_codeminders_hidapi_HIDSelector_init
+  (JNIEnv *env, jobject self)
+{
+    hid_reactor *peer = hid_reactor_create();
+    if(!peer)
+    {
+        throwIOException(env, NULL);
+        return;
+    }
+    setPeer(env, self, peer);
+}
+
+JNIEXPORT void JNICALL Java_com_codeminders_hidapi_HIDSelector_close
+  (JNIEnv *env, jobject self)
+{
+    hid_reactor *peer = getPeer(env, self);
+    if(!peer)
+        return; /* not an error, freed previously */ 
+    hid_reactor_destroy(peer);
+    setPeer(env, self, NULL);
+}
+
+JNIEXPORT void JNICALL Java_com_codeminders_hidapi_HIDSelector_addDevice
+  (JNIEnv *env, jobject self, jlong device)
+{
+    hid_reactor *peer = getPeer(env, self);
+    if(!peer || !device || hid_reactor_add(peer, (hid_device*)device) != 0)
+        throwIOException(env, NULL);
+}
+
+JNIEXPORT void JNICALL Java_com_codeminders_hidapi_HIDSelector_removeDevice
+  (JNIEnv *env, jobject self, jlong device)
+{
+    hid_reactor *peer = getPeer(env, self);
+    if(!peer || !device || hid_reactor_remove(peer, (hid_device*)device) != 0)
+        throwIOException(env, NULL);
+}
+
+JNIEXPORT jint JNICALL Java_com_codeminders_hidapi_HIDSelector_waitDevices
+  (JNIEnv *env, jobject self, jlongArray ready, jint max, jint milliseconds)
+{
+    hid_reactor *peer = getPeer(env, self);
+    if(!peer)
+    {
+        throwIOException(env, NULL);
+        return 0; /* not an error, freed previously */ 
+    }
+    if(max <= 0)
+        return 0;
+
+    hid_device *stack_devices[READY_STACK_SIZE];
+    hid_device **devices = stack_devices;
+    if(max > READY_STACK_SIZE)
+    {
+        devices = (hid_device**) malloc(max * sizeof(hid_device*));
+        if(!devices)
+        {
+            throwIOException(env, NULL);
+            return 0;
+        }
+    }
+
+    int n = hid_reactor_wait(peer, devices, max, milliseconds);
+    if(n == -1)
+        throwIOException(env, NULL);
+    for(int i=0; i<n; i++)
+    {
+        jlong device = (jlong)devices[i];
+        env->SetLongArrayRegion(ready, i, 1, &device);
+    }
+
+    if(devices != stack_devices)
+        free(devices);
+    return n > 0 ? n : 0; /* 0 on time out */
+}
+
+static JNINativeMethod methods[] = {
+    JNI_NATIVE("close", "()V", Java_com_codeminders_hidapi_HIDSelector_close),
+    JNI_NATIVE("init", "()V", Java_com_codeminders_hidapi_HIDSelector_init),
+    JNI_NATIVE("addDevice", "(J)V", Java_com_codeminders_hidapi_HIDSelector_addDevice),
+    JNI_NATIVE("removeDevice", "(J)V", Java_com_codeminders_hidapi_HIDSelector_removeDevice),
+    JNI_NATIVE("waitDevices", "([JII)I", Java_com_codeminders_hidapi_HIDSelector_waitDevices),
+};
+
+int registerHIDSelectorNatives(JNIEnv *env, jclass cls)
+{
+    return env->RegisterNatives(cls, methods, sizeof(methods)/sizeof(methods[0]));
+}
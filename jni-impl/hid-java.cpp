@@ -1,4 +1,5 @@
 #include <stdlib.h>
+#include <string.h>
 #include <assert.h>
 #include <jni.h>
 
@@ -11,12 +12,243 @@
 #include "hidapi/hidapi.h"
 #include "hid-java.h"
 
+struct jni_cache jcache;
+
+static jclass findGlobalClass(JNIEnv *env, const char *name)
+{
+    jclass cls = env->FindClass(name);
+    if (cls == NULL)
+        return NULL; /* exception thrown */
+    jclass global = (jclass) env->NewGlobalRef(cls);
+    env->DeleteLocalRef(cls);
+    return global;
+}
+
+static void releaseCache(JNIEnv *env)
+{
+    if(jcache.ioExceptionClass)
+        env->DeleteGlobalRef(jcache.ioExceptionClass);
+    if(jcache.deviceClass)
+        env->DeleteGlobalRef(jcache.deviceClass);
+    if(jcache.deviceInfoClass)
+        env->DeleteGlobalRef(jcache.deviceInfoClass);
+    if(jcache.managerClass)
+        env->DeleteGlobalRef(jcache.managerClass);
+    if(jcache.selectorClass)
+        env->DeleteGlobalRef(jcache.selectorClass);
+    if(jcache.eventsClass)
+        env->DeleteGlobalRef(jcache.eventsClass);
+    if(jcache.events)
+        env->DeleteGlobalRef(jcache.events);
+    memset(&jcache, 0, sizeof(jcache));
+}
+
+static int initCache(JNIEnv *env)
+{
+    jclass cls;
+
+    cls = jcache.ioExceptionClass = findGlobalClass(env, "java/io/IOException");
+    if (cls == NULL)
+        return -1;
+
+    cls = jcache.deviceClass = findGlobalClass(env, DEV_CLASS);
+    if (cls == NULL)
+        return -1;
+    jcache.devicePeer = env->GetFieldID(cls, "peer", "J");
+    jcache.deviceInit = env->GetMethodID(cls, "<init>", "(J)V");
+    jcache.deviceDeliverInputReports = env->GetMethodID(cls, "deliverInputReports", "([BI)V");
+    jcache.deviceInputFailed = env->GetMethodID(cls, "inputFailed", "()V");
+    jcache.deviceOpened = env->GetMethodID(cls, "opened", "(Ljava/lang/String;)V");
+    jcache.deviceClosing = env->GetMethodID(cls, "closing", "()V");
+    if (!jcache.devicePeer || !jcache.deviceInit ||
+        !jcache.deviceDeliverInputReports || !jcache.deviceInputFailed ||
+        !jcache.deviceOpened || !jcache.deviceClosing)
+        return -1;
+
+    cls = jcache.deviceInfoClass = findGlobalClass(env, DEVINFO_CLASS);
+    if (cls == NULL)
+        return -1;
+    jcache.deviceInfoInit = env->GetMethodID(cls, "<init>", "()V");
+    jcache.deviceInfoPath = env->GetFieldID(cls, "path", "Ljava/lang/String;");
+    jcache.deviceInfoVendorId = env->GetFieldID(cls, "vendor_id", "I");
+    jcache.deviceInfoProductId = env->GetFieldID(cls, "product_id", "I");
+    jcache.deviceInfoSerialNumber = env->GetFieldID(cls, "serial_number", "Ljava/lang/String;");
+    jcache.deviceInfoReleaseNumber = env->GetFieldID(cls, "release_number", "I");
+    jcache.deviceInfoManufacturerString = env->GetFieldID(cls, "manufacturer_string", "Ljava/lang/String;");
+    jcache.deviceInfoProductString = env->GetFieldID(cls, "product_string", "Ljava/lang/String;");
+    jcache.deviceInfoUsagePage = env->GetFieldID(cls, "usage_page", "I");
+    jcache.deviceInfoUsage = env->GetFieldID(cls, "usage", "I");
+    jcache.deviceInfoInterfaceNumber = env->GetFieldID(cls, "interface_number", "I");
+    jcache.deviceInfoBackend = env->GetFieldID(cls, "backend", "Ljava/lang/String;");
+    if (env->ExceptionCheck())
+        return -1; /* NoSuchFieldError or NoSuchMethodError thrown */
+
+    cls = jcache.managerClass = findGlobalClass(env, HID_MANAGER_CLASS);
+    if (cls == NULL)
+        return -1;
+    jcache.managerPeer = env->GetFieldID(cls, "peer", "J");
+    jcache.managerHotplugEvent = env->GetMethodID(cls, "hotplugEvent", "(IL" DEVINFO_CLASS ";)V");
+    if (!jcache.managerPeer || !jcache.managerHotplugEvent)
+        return -1;
+
+    cls = jcache.selectorClass = findGlobalClass(env, HID_SELECTOR_CLASS);
+    if (cls == NULL)
+        return -1;
+    jcache.selectorPeer = env->GetFieldID(cls, "peer", "J");
+    if (!jcache.selectorPeer)
+        return -1;
+
+    cls = jcache.eventsClass = findGlobalClass(env, EVENTS_CLASS);
+    if (cls == NULL)
+        return -1;
+    jfieldID eventsField = env->GetStaticFieldID(cls, "events", "L" EVENTS_CLASS ";");
+    jcache.eventsBegin = env->GetMethodID(cls, "begin", "(I)Ljava/lang/Object;");
+    jcache.eventsEndRead = env->GetMethodID(cls, "endRead", "(Ljava/lang/Object;L" DEV_CLASS ";III)V");
+    jcache.eventsEndWrite = env->GetMethodID(cls, "endWrite", "(Ljava/lang/Object;L" DEV_CLASS ";I)V");
+    jcache.eventsEndFeatureReport = env->GetMethodID(cls, "endFeatureReport", "(Ljava/lang/Object;L" DEV_CLASS ";ZI)V");
+    jcache.eventsEndEnumerate = env->GetMethodID(cls, "endEnumerate", "(Ljava/lang/Object;I)V");
+    jcache.eventsEndOpen = env->GetMethodID(cls, "endOpen", "(Ljava/lang/Object;Ljava/lang/String;L" DEV_CLASS ";)V");
+    if (env->ExceptionCheck())
+        return -1; /* NoSuchFieldError or NoSuchMethodError thrown */
+
+    /* HIDEvents itself records nothing; only a subclass made for Flight
+       Recorder is worth calling. */
+    jobject events = env->GetStaticObjectField(cls, eventsField);
+    if (env->ExceptionCheck())
+        return -1; /* HIDEvents failed to initialize */
+    if (events)
+    {
+        jclass eventsImpl = env->GetObjectClass(events);
+        if (!env->IsSameObject(eventsImpl, cls))
+            jcache.events = env->NewGlobalRef(events);
+        env->DeleteLocalRef(eventsImpl);
+        env->DeleteLocalRef(events);
+    }
+
+    if (registerHIDDeviceNatives(env, jcache.deviceClass) != 0 ||
+        registerHIDDeviceInfoNatives(env, jcache.deviceInfoClass) != 0 ||
+        registerHIDManagerNatives(env, jcache.managerClass) != 0 ||
+        registerHIDSelectorNatives(env, jcache.selectorClass) != 0)
+        return -1;
+
+    return 0;
+}
+
+JNIEXPORT jint JNICALL JNI_OnLoad(JavaVM *vm, void *reserved)
+{
+    JNIEnv *env;
+
+    if (vm->GetEnv((void **) &env, JNI_VERSION_1_4) != JNI_OK)
+        return JNI_ERR;
+
+    jcache.vm = vm;
+    if (initCache(env) != 0)
+    {
+        releaseCache(env);
+        return JNI_ERR;
+    }
+
+    return JNI_VERSION_1_4;
+}
+
+JNIEXPORT void JNICALL JNI_OnUnload(JavaVM *vm, void *reserved)
+{
+    JNIEnv *env;
+
+    if (vm->GetEnv((void **) &env, JNI_VERSION_1_4) != JNI_OK)
+        return;
+
+    stopHotplugDispatch(env);
+    shutdownInputDispatch(env);
+    releaseCache(env);
+}
+
+jobject beginEvent(JNIEnv *env, jint type)
+{
+    if (!jcache.events)
+        return NULL;
+    jobject event = env->CallObjectMethod(jcache.events, jcache.eventsBegin, type);
+    if (env->ExceptionCheck())
+    {
+        /* Recording must not fail the operation. */
+        env->ExceptionClear();
+        return NULL;
+    }
+    return event;
+}
+
+/* Set a pending exception aside while an end method runs. */
+static jthrowable holdException(JNIEnv *env)
+{
+    jthrowable pending = env->ExceptionOccurred();
+    if (pending)
+        env->ExceptionClear();
+    return pending;
+}
+
+static void endEvent(JNIEnv *env, jobject event, jthrowable pending)
+{
+    if (env->ExceptionCheck())
+        env->ExceptionClear();
+    if (pending)
+    {
+        env->Throw(pending);
+        env->DeleteLocalRef(pending);
+    }
+    env->DeleteLocalRef(event);
+}
+
+void endReadEvent(JNIEnv *env, jobject event, jobject device, jint bytes, jint reports, jint timeout)
+{
+    if (!event)
+        return;
+    jthrowable pending = holdException(env);
+    env->CallVoidMethod(jcache.events, jcache.eventsEndRead, event, device, bytes, reports, timeout);
+    endEvent(env, event, pending);
+}
+
+void endWriteEvent(JNIEnv *env, jobject event, jobject device, jint bytes)
+{
+    if (!event)
+        return;
+    jthrowable pending = holdException(env);
+    env->CallVoidMethod(jcache.events, jcache.eventsEndWrite, event, device, bytes);
+    endEvent(env, event, pending);
+}
+
+void endFeatureReportEvent(JNIEnv *env, jobject event, jobject device, jboolean get, jint bytes)
+{
+    if (!event)
+        return;
+    jthrowable pending = holdException(env);
+    env->CallVoidMethod(jcache.events, jcache.eventsEndFeatureReport, event, device, get, bytes);
+    endEvent(env, event, pending);
+}
+
+void endEnumerateEvent(JNIEnv *env, jobject event, jint devices)
+{
+    if (!event)
+        return;
+    jthrowable pending = holdException(env);
+    env->CallVoidMethod(jcache.events, jcache.eventsEndEnumerate, event, devices);
+    endEvent(env, event, pending);
+}
+
+void endOpenEvent(JNIEnv *env, jobject event, jstring path, jobject device)
+{
+    if (!event)
+        return;
+    jthrowable pending = holdException(env);
+    env->CallVoidMethod(jcache.events, jcache.eventsEndOpen, event, path, device);
+    endEvent(env, event, pending);
+}
+
 void throwIOException(JNIEnv *env, hid_device *device)
 {
     jclass exceptionClass;
     char *message = NULL;
     
-    exceptionClass = env->FindClass("java/io/IOException");
+    exceptionClass = jcache.ioExceptionClass;
     if (exceptionClass == NULL) 
     {
         /* Unable to find the exception class, give up. */
@@ -67,7 +299,7 @@ char* convertToUTF8(JNIEnv *env, const wchar_t *str)
     size_t u8l = len*6+3; //BOM+chars
     char *u8 = (char *) malloc(u8l+1);
     char *u8p = u8;
-    int nconv = iconv(cd, &uval, &ulen, &u8p, &u8l);
+    size_t nconv = iconv(cd, &uval, &ulen, &u8p, &u8l);
     if(nconv == (size_t)-1)
     {
         iconv_close(cd);
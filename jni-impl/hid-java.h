@@ -1,25 +1,117 @@
 #ifndef __HID_JAVA_H__
 #define __HID_JAVA_H__
 
+#include <jni.h>
+
 #define DEV_CLASS "com/codeminders/hidapi/HIDDevice"
 #define DEVINFO_CLASS "com/codeminders/hidapi/HIDDeviceInfo"
 #define HID_MANAGER_CLASS "com/codeminders/hidapi/HIDManager"
+#define HID_SELECTOR_CLASS "com/codeminders/hidapi/HIDSelector"
+#define EVENTS_CLASS "com/codeminders/hidapi/HIDEvents"
+
+/* Event types, the constants of HIDEvents */
+#define HID_EVENT_READ 0
+#define HID_EVENT_WRITE 1
+#define HID_EVENT_FEATURE_REPORT 2
+#define HID_EVENT_ENUMERATE 3
+#define HID_EVENT_OPEN 4
 
 
 #if defined(__APPLE__)
 #define MAC_OS_X
 #endif
 
+#define JNI_NATIVE(name, sig, fn) { (char *) name, (char *) sig, (void *) fn }
+
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/* Classes, field and method IDs resolved once in JNI_OnLoad(). Classes
+   are held as global references until JNI_OnUnload(). */
+struct jni_cache {
+    JavaVM    *vm;
+
+    jclass    ioExceptionClass;
+
+    jclass    deviceClass;
+    jfieldID  devicePeer;
+    jmethodID deviceInit;
+    jmethodID deviceDeliverInputReports;
+    jmethodID deviceInputFailed;
+    jmethodID deviceOpened;
+    jmethodID deviceClosing;
+
+    jclass    deviceInfoClass;
+    jmethodID deviceInfoInit;
+    jfieldID  deviceInfoPath;
+    jfieldID  deviceInfoVendorId;
+    jfieldID  deviceInfoProductId;
+    jfieldID  deviceInfoSerialNumber;
+    jfieldID  deviceInfoReleaseNumber;
+    jfieldID  deviceInfoManufacturerString;
+    jfieldID  deviceInfoProductString;
+    jfieldID  deviceInfoUsagePage;
+    jfieldID  deviceInfoUsage;
+    jfieldID  deviceInfoInterfaceNumber;
+    jfieldID  deviceInfoBackend;
+
+    jclass    managerClass;
+    jfieldID  managerPeer;
+    jmethodID managerHotplugEvent;
+
+    jclass    selectorClass;
+    jfieldID  selectorPeer;
+
+    jclass    eventsClass;
+    jobject   events; /* HIDEvents.events, or NULL if it records nothing */
+    jmethodID eventsBegin;
+    jmethodID eventsEndRead;
+    jmethodID eventsEndWrite;
+    jmethodID eventsEndFeatureReport;
+    jmethodID eventsEndEnumerate;
+    jmethodID eventsEndOpen;
+};
+
+extern struct jni_cache jcache;
+
 void throwIOException(JNIEnv *env, hid_device *device);
 
 /* this call allocate buffer dynamically. return value should be
    released with free() routine */
-char* convertToUTF8(JNIEnv *env, const wchar_t *str); 
+char* convertToUTF8(JNIEnv *env, const wchar_t *str);
+
+/* Flight Recorder events of the natives which are public methods, see
+   HIDEvents.java. beginEvent() returns NULL when the type isn't being
+   recorded, and the end functions then do nothing. They may be called
+   with an exception pending, which is kept. */
+jobject beginEvent(JNIEnv *env, jint type);
+void endReadEvent(JNIEnv *env, jobject event, jobject device, jint bytes, jint reports, jint timeout);
+void endWriteEvent(JNIEnv *env, jobject event, jobject device, jint bytes);
+void endFeatureReportEvent(JNIEnv *env, jobject event, jobject device, jboolean get, jint bytes);
+void endEnumerateEvent(JNIEnv *env, jobject event, jint devices);
+void endOpenEvent(JNIEnv *env, jobject event, jstring path, jobject device);
+
+/* RegisterNatives() helpers, one per Java class. Return 0 on success. */
+int registerHIDDeviceNatives(JNIEnv *env, jclass cls);
+int registerHIDDeviceInfoNatives(JNIEnv *env, jclass cls);
+int registerHIDManagerNatives(JNIEnv *env, jclass cls);
+int registerHIDSelectorNatives(JNIEnv *env, jclass cls);
+
+/* The thread delivering Input reports to HIDDevice listeners, see
+   input-dispatch.cpp. start returns 0 on success. */
+int startInputDispatch(JNIEnv *env, jobject device, hid_device *dev);
+void stopInputDispatch(JNIEnv *env, hid_device *dev);
+void shutdownInputDispatch(JNIEnv *env);
+
+/* Makes a HIDDeviceInfo, or returns NULL with an exception thrown. */
+jobject createHIDDeviceInfo(JNIEnv *env, struct hid_device_info *dev);
+
+/* The thread delivering connections and disconnections to HIDManager
+   listeners, see hotplug-dispatch.cpp. start returns 0 on success. */
+int startHotplugDispatch(JNIEnv *env, jobject manager);
+void stopHotplugDispatch(JNIEnv *env);
 
 #ifdef __cplusplus
 }
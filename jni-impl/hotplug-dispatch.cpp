@@ -0,0 +1,189 @@
+#include <stdlib.h>
+
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+#include "hidapi/hidapi.h"
+#include "hid-java.h"
+
+/* One native thread waits on a hotplug monitor for every device and
+   passes each connection and disconnection to HIDManager.hotplugEvent(),
+   which calls the listeners whose filter matches. It is started with
+   the first listener and stopped when the last one is removed. */
+
+/* How often the thread checks whether it should stop, in ms. */
+#define HOTPLUG_WAIT_TIMEOUT 500
+
+#ifndef _WIN32
+
+/* hotplug_thread.state, reported to startHotplugDispatch() */
+#define HOTPLUG_STARTING 0
+#define HOTPLUG_RUNNING 1
+#define HOTPLUG_FAILED -1
+
+struct hotplug_thread {
+    hid_hotplug *hotplug;
+    jobject manager;  /* global reference to the HIDManager */
+    pthread_t thread;
+    volatile int stop;
+    int detached;     /* stopped from a listener, the thread frees itself */
+    int state;        /* protected by hotplug_mutex */
+};
+
+static pthread_mutex_t hotplug_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t hotplug_started = PTHREAD_COND_INITIALIZER;
+static hotplug_thread *hotplug_current;
+
+static void freeThread(JNIEnv *env, hotplug_thread *t)
+{
+    hid_hotplug_destroy(t->hotplug);
+    env->DeleteGlobalRef(t->manager);
+    free(t);
+}
+
+static void *hotplugThread(void *param)
+{
+    hotplug_thread *t = (hotplug_thread*) param;
+    JNIEnv *env;
+
+    /* As a daemon, so the thread doesn't keep the JVM alive. If this
+       fails, startHotplugDispatch() joins the thread and fails too. */
+    int attached = jcache.vm->AttachCurrentThreadAsDaemon((void **) &env, NULL) == JNI_OK;
+    pthread_mutex_lock(&hotplug_mutex);
+    t->state = attached ? HOTPLUG_RUNNING : HOTPLUG_FAILED;
+    pthread_cond_broadcast(&hotplug_started);
+    pthread_mutex_unlock(&hotplug_mutex);
+    if(!attached)
+        return NULL;
+
+    while(!t->stop)
+    {
+        struct hid_device_info *info;
+        int event = hid_hotplug_wait(t->hotplug, &info, HOTPLUG_WAIT_TIMEOUT);
+        if(event < 0)
+            break;
+        if(event == 0)
+            continue;
+
+        jobject device = createHIDDeviceInfo(env, info);
+        hid_free_enumeration(info);
+        if(device)
+        {
+            env->CallVoidMethod(t->manager, jcache.managerHotplugEvent, (jint) event, device);
+            env->DeleteLocalRef(device);
+        }
+
+        /* A listener's exception must not end the thread. */
+        if(env->ExceptionCheck())
+        {
+            env->ExceptionDescribe();
+            env->ExceptionClear();
+        }
+    }
+
+    /* If the monitor failed, nobody will stop the thread: it takes
+       itself out, so the next listener starts a new one, and frees
+       everything. Otherwise stopHotplugDispatch() took it out and
+       joins it, or set detached if called on this thread, without a
+       lock as it was then this thread. */
+    pthread_mutex_lock(&hotplug_mutex);
+    if(hotplug_current == t)
+    {
+        hotplug_current = NULL;
+        t->detached = 1;
+        pthread_detach(t->thread);
+    }
+    pthread_mutex_unlock(&hotplug_mutex);
+
+    if(t->detached)
+        freeThread(env, t);
+    jcache.vm->DetachCurrentThread();
+    return NULL;
+}
+
+int startHotplugDispatch(JNIEnv *env, jobject manager)
+{
+    hotplug_thread *t;
+    int res = -1;
+
+    pthread_mutex_lock(&hotplug_mutex);
+    if(hotplug_current)
+    {
+        res = 0;
+        goto out;
+    }
+
+    t = (hotplug_thread*) calloc(1, sizeof(hotplug_thread));
+    if(!t)
+        goto out;
+    /* For every device, the listeners have their own filters. */
+    t->hotplug = hid_hotplug_create(0x0, 0x0);
+    if(!t->hotplug)
+    {
+        free(t); /* not supported on this platform or implementation */
+        goto out;
+    }
+    t->manager = env->NewGlobalRef(manager);
+    t->state = HOTPLUG_STARTING;
+    if(pthread_create(&t->thread, NULL, hotplugThread, t) != 0)
+    {
+        freeThread(env, t);
+        goto out;
+    }
+    while(t->state == HOTPLUG_STARTING)
+        pthread_cond_wait(&hotplug_started, &hotplug_mutex);
+    if(t->state == HOTPLUG_FAILED)
+    {
+        pthread_join(t->thread, NULL);
+        freeThread(env, t);
+        goto out;
+    }
+    hotplug_current = t;
+    res = 0;
+
+out:
+    pthread_mutex_unlock(&hotplug_mutex);
+    return res;
+}
+
+void stopHotplugDispatch(JNIEnv *env)
+{
+    hotplug_thread *t;
+
+    pthread_mutex_lock(&hotplug_mutex);
+    t = hotplug_current;
+    hotplug_current = NULL;
+    pthread_mutex_unlock(&hotplug_mutex);
+    if(!t)
+        return;
+
+    t->stop = 1;
+    if(pthread_equal(pthread_self(), t->thread))
+    {
+        /* Called from a listener on the thread itself, which frees
+           everything once the upcall returns. */
+        t->detached = 1;
+        pthread_detach(t->thread);
+    }
+    else
+    {
+        pthread_join(t->thread, NULL);
+        freeThread(env, t);
+    }
+}
+
+#else /* _WIN32 */
+
+/* Not supported on this platform, as there are no hotplug monitors. */
+
+int startHotplugDispatch(JNIEnv *env, jobject manager)
+{
+    return -1;
+}
+
+void stopHotplugDispatch(JNIEnv *env)
+{
+}
+
+#endif /* _WIN32 */
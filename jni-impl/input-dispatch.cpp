@@ -0,0 +1,300 @@
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+#include "hidapi/hidapi.h"
+#include "hid-java.h"
+
+/* A native thread waits on every device with an input listener and
+   hands each one's queued reports to HIDDevice.deliverInputReports() in
+   a single upcall. A reactor only takes devices of its own
+   implementation, so there is one reactor and one thread for each
+   implementation devices are opened with (see hid_get_device_backend()).
+   A thread attaches to the JVM once, when it starts, and runs until the
+   library is unloaded. */
+
+/* The most reports and bytes handed over in one upcall. */
+#define INPUT_MAX_REPORTS 64
+#define INPUT_BUFFER_SIZE 65536
+
+/* The most devices handled per wake-up. */
+#define INPUT_MAX_READY 64
+
+/* How often the thread checks whether it should stop, in ms. */
+#define INPUT_WAIT_TIMEOUT 500
+
+#ifndef _WIN32
+
+struct input_reactor {
+    const char *backend; /* hid_get_device_backend() of its devices */
+    hid_reactor *reactor;
+    pthread_t thread;
+    input_reactor *next;
+};
+
+struct input_entry {
+    hid_device *dev;
+    jobject device;        /* global reference to the HIDDevice */
+    input_reactor *owner;  /* the reactor it is in */
+    int busy;              /* the thread is reading it or calling up */
+    int removed;           /* unlinked while busy, the thread frees it */
+    input_entry *next;
+};
+
+static pthread_mutex_t input_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t input_cond = PTHREAD_COND_INITIALIZER;
+static input_entry *input_entries;
+static input_reactor *input_reactors;
+static volatile int input_stop;
+
+/* This should be called with input_mutex locked. */
+static input_entry* findEntry(hid_device *dev)
+{
+    input_entry *entry;
+    for(entry = input_entries; entry; entry = entry->next)
+        if(entry->dev == dev)
+            return entry;
+    return NULL;
+}
+
+/* This should be called with input_mutex locked. */
+static input_reactor* findReactor(const char *backend)
+{
+    input_reactor *r;
+    for(r = input_reactors; r; r = r->next)
+        if(strcmp(r->backend, backend) == 0)
+            return r;
+    return NULL;
+}
+
+/* This should be called with input_mutex locked. */
+static void unlinkEntry(input_entry *entry)
+{
+    input_entry **link;
+    for(link = &input_entries; *link != entry; link = &(*link)->next)
+        ;
+    *link = entry->next;
+}
+
+static void deliver(JNIEnv *env, input_entry *entry, unsigned char *buf)
+{
+    size_t len = INPUT_BUFFER_SIZE;
+    int res = hid_read_many(entry->dev, buf, &len, INPUT_MAX_REPORTS, 0);
+
+    if(res > 0)
+    {
+        jbyteArray reports = env->NewByteArray((jsize) len);
+        if(reports)
+        {
+            env->SetByteArrayRegion(reports, 0, (jsize) len, (jbyte*) buf);
+            env->CallVoidMethod(entry->device, jcache.deviceDeliverInputReports, reports, res);
+            env->DeleteLocalRef(reports);
+        }
+    }
+    else if(res < 0)
+    {
+        /* Disconnected. Stop waiting on it, it would stay ready. */
+        pthread_mutex_lock(&input_mutex);
+        hid_reactor_remove(entry->owner->reactor, entry->dev);
+        pthread_mutex_unlock(&input_mutex);
+        env->CallVoidMethod(entry->device, jcache.deviceInputFailed);
+    }
+
+    /* A listener's exception must not end the thread. */
+    if(env->ExceptionCheck())
+    {
+        env->ExceptionDescribe();
+        env->ExceptionClear();
+    }
+
+    pthread_mutex_lock(&input_mutex);
+    entry->busy = 0;
+    if(res < 0 && !entry->removed)
+    {
+        unlinkEntry(entry);
+        entry->removed = 1;
+    }
+    if(entry->removed)
+    {
+        env->DeleteGlobalRef(entry->device);
+        free(entry);
+    }
+    pthread_cond_broadcast(&input_cond);
+    pthread_mutex_unlock(&input_mutex);
+}
+
+static void *inputThread(void *param)
+{
+    input_reactor *r = (input_reactor*) param;
+    JNIEnv *env;
+    hid_device *ready[INPUT_MAX_READY];
+    unsigned char *buf;
+    int i, n;
+
+    /* As a daemon, so the thread doesn't keep the JVM alive. */
+    if(jcache.vm->AttachCurrentThreadAsDaemon((void **) &env, NULL) != JNI_OK)
+        return NULL;
+    buf = (unsigned char*) malloc(INPUT_BUFFER_SIZE);
+
+    while(buf && !input_stop)
+    {
+        n = hid_reactor_wait(r->reactor, ready, INPUT_MAX_READY, INPUT_WAIT_TIMEOUT);
+        for(i = 0; i < n; i++)
+        {
+            input_entry *entry;
+
+            pthread_mutex_lock(&input_mutex);
+            entry = findEntry(ready[i]);
+            if(entry)
+                entry->busy = 1;
+            pthread_mutex_unlock(&input_mutex);
+
+            /* It may have been removed since the wait returned. */
+            if(entry)
+                deliver(env, entry, buf);
+        }
+    }
+
+    free(buf);
+    jcache.vm->DetachCurrentThread();
+    return NULL;
+}
+
+int startInputDispatch(JNIEnv *env, jobject device, hid_device *dev)
+{
+    const char *backend = hid_get_device_backend(dev);
+    input_reactor *r;
+    int res = -1;
+
+    pthread_mutex_lock(&input_mutex);
+    if(findEntry(dev))
+    {
+        res = 0;
+        goto out;
+    }
+
+    r = findReactor(backend);
+    if(!r)
+    {
+        r = (input_reactor*) calloc(1, sizeof(input_reactor));
+        if(!r)
+            goto out;
+        r->backend = backend;
+        r->reactor = hid_reactor_create_backend(backend);
+        if(!r->reactor)
+        {
+            free(r);
+            goto out; /* not supported by this implementation */
+        }
+        if(pthread_create(&r->thread, NULL, inputThread, r) != 0)
+        {
+            hid_reactor_destroy(r->reactor);
+            free(r);
+            goto out;
+        }
+        r->next = input_reactors;
+        input_reactors = r;
+    }
+
+    {
+        input_entry *entry = (input_entry*) calloc(1, sizeof(input_entry));
+        if(!entry)
+            goto out;
+        if(hid_reactor_add(r->reactor, dev) != 0)
+        {
+            free(entry);
+            goto out;
+        }
+        entry->dev = dev;
+        entry->device = env->NewGlobalRef(device);
+        entry->owner = r;
+        entry->next = input_entries;
+        input_entries = entry;
+        res = 0;
+    }
+
+out:
+    pthread_mutex_unlock(&input_mutex);
+    return res;
+}
+
+void stopInputDispatch(JNIEnv *env, hid_device *dev)
+{
+    input_entry *entry;
+
+    pthread_mutex_lock(&input_mutex);
+    entry = findEntry(dev);
+    if(entry)
+    {
+        hid_reactor_remove(entry->owner->reactor, dev);
+        unlinkEntry(entry);
+        if(entry->busy && pthread_equal(pthread_self(), entry->owner->thread))
+        {
+            /* Called from a listener on the thread itself, which
+               frees the entry once the upcall returns. */
+            entry->removed = 1;
+        }
+        else
+        {
+            /* Don't let the device be closed under the thread. */
+            while(entry->busy)
+                pthread_cond_wait(&input_cond, &input_mutex);
+            env->DeleteGlobalRef(entry->device);
+            free(entry);
+        }
+    }
+    pthread_mutex_unlock(&input_mutex);
+}
+
+void shutdownInputDispatch(JNIEnv *env)
+{
+    input_entry *entry;
+    input_reactor *r;
+
+    pthread_mutex_lock(&input_mutex);
+    if(input_reactors)
+    {
+        input_stop = 1;
+        pthread_mutex_unlock(&input_mutex);
+        for(r = input_reactors; r; r = r->next)
+            pthread_join(r->thread, NULL);
+        pthread_mutex_lock(&input_mutex);
+        input_stop = 0;
+    }
+    while((entry = input_entries) != NULL)
+    {
+        input_entries = entry->next;
+        env->DeleteGlobalRef(entry->device);
+        free(entry);
+    }
+    while((r = input_reactors) != NULL)
+    {
+        input_reactors = r->next;
+        hid_reactor_destroy(r->reactor);
+        free(r);
+    }
+    pthread_mutex_unlock(&input_mutex);
+}
+
+#else /* _WIN32 */
+
+/* Not supported on this platform, as there are no reactors. */
+
+int startInputDispatch(JNIEnv *env, jobject device, hid_device *dev)
+{
+    return -1;
+}
+
+void stopInputDispatch(JNIEnv *env, hid_device *dev)
+{
+}
+
+void shutdownInputDispatch(JNIEnv *env)
+{
+}
+
+#endif /* _WIN32 */
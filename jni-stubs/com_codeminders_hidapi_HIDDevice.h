@@ -103,6 +103,174 @@ JNIEXPORT jstring JNICALL Java_com_codeminders_hidapi_HIDDevice_getSerialNumberS
 JNIEXPORT jstring JNICALL Java_com_codeminders_hidapi_HIDDevice_getIndexedString
   (JNIEnv *, jobject, jint);
 
+/*
+ * Class:     com_codeminders_hidapi_HIDDevice
+ * Method:    writeRegion
+ * Signature: ([BII)I
+ */
+JNIEXPORT jint JNICALL Java_com_codeminders_hidapi_HIDDevice_writeRegion
+  (JNIEnv *, jobject, jbyteArray, jint, jint);
+
+/*
+ * Class:     com_codeminders_hidapi_HIDDevice
+ * Method:    readRegion
+ * Signature: ([BII)I
+ */
+JNIEXPORT jint JNICALL Java_com_codeminders_hidapi_HIDDevice_readRegion
+  (JNIEnv *, jobject, jbyteArray, jint, jint);
+
+/*
+ * Class:     com_codeminders_hidapi_HIDDevice
+ * Method:    readTimeoutRegion
+ * Signature: ([BIII)I
+ */
+JNIEXPORT jint JNICALL Java_com_codeminders_hidapi_HIDDevice_readTimeoutRegion
+  (JNIEnv *, jobject, jbyteArray, jint, jint, jint);
+
+/*
+ * Class:     com_codeminders_hidapi_HIDDevice
+ * Method:    writeDirect
+ * Signature: (Ljava/nio/ByteBuffer;II)I
+ */
+JNIEXPORT jint JNICALL Java_com_codeminders_hidapi_HIDDevice_writeDirect
+  (JNIEnv *, jobject, jobject, jint, jint);
+
+/*
+ * Class:     com_codeminders_hidapi_HIDDevice
+ * Method:    readDirect
+ * Signature: (Ljava/nio/ByteBuffer;II)I
+ */
+JNIEXPORT jint JNICALL Java_com_codeminders_hidapi_HIDDevice_readDirect
+  (JNIEnv *, jobject, jobject, jint, jint);
+
+/*
+ * Class:     com_codeminders_hidapi_HIDDevice
+ * Method:    readTimeoutDirect
+ * Signature: (Ljava/nio/ByteBuffer;III)I
+ */
+JNIEXPORT jint JNICALL Java_com_codeminders_hidapi_HIDDevice_readTimeoutDirect
+  (JNIEnv *, jobject, jobject, jint, jint, jint);
+
+/*
+ * Class:     com_codeminders_hidapi_HIDDevice
+ * Method:    readManyDirect
+ * Signature: (Ljava/nio/ByteBuffer;IIII)I
+ */
+JNIEXPORT jint JNICALL Java_com_codeminders_hidapi_HIDDevice_readManyDirect
+  (JNIEnv *, jobject, jobject, jint, jint, jint, jint);
+
+/*
+ * Class:     com_codeminders_hidapi_HIDDevice
+ * Method:    sendFeatureReportDirect
+ * Signature: (Ljava/nio/ByteBuffer;II)I
+ */
+JNIEXPORT jint JNICALL Java_com_codeminders_hidapi_HIDDevice_sendFeatureReportDirect
+  (JNIEnv *, jobject, jobject, jint, jint);
+
+/*
+ * Class:     com_codeminders_hidapi_HIDDevice
+ * Method:    getFeatureReportDirect
+ * Signature: (Ljava/nio/ByteBuffer;II)I
+ */
+JNIEXPORT jint JNICALL Java_com_codeminders_hidapi_HIDDevice_getFeatureReportDirect
+  (JNIEnv *, jobject, jobject, jint, jint);
+
+/*
+ * Class:     com_codeminders_hidapi_HIDDevice
+ * Method:    setInputQueueNative
+ * Signature: (II)V
+ */
+JNIEXPORT void JNICALL Java_com_codeminders_hidapi_HIDDevice_setInputQueueNative
+  (JNIEnv *, jobject, jint, jint);
+
+/*
+ * Class:     com_codeminders_hidapi_HIDDevice
+ * Method:    setInputTransfers
+ * Signature: (I)V
+ */
+JNIEXPORT void JNICALL Java_com_codeminders_hidapi_HIDDevice_setInputTransfers
+  (JNIEnv *, jobject, jint);
+
+/*
+ * Class:     com_codeminders_hidapi_HIDDevice
+ * Method:    getPollFd
+ * Signature: ()I
+ */
+JNIEXPORT jint JNICALL Java_com_codeminders_hidapi_HIDDevice_getPollFd
+  (JNIEnv *, jobject);
+
+/*
+ * Class:     com_codeminders_hidapi_HIDDevice
+ * Method:    startInput
+ * Signature: ()V
+ */
+JNIEXPORT void JNICALL Java_com_codeminders_hidapi_HIDDevice_startInput
+  (JNIEnv *, jobject);
+
+/*
+ * Class:     com_codeminders_hidapi_HIDDevice
+ * Method:    stopInput
+ * Signature: ()V
+ */
+JNIEXPORT void JNICALL Java_com_codeminders_hidapi_HIDDevice_stopInput
+  (JNIEnv *, jobject);
+
+/*
+ * Class:     com_codeminders_hidapi_HIDDevice
+ * Method:    attachInputRing
+ * Signature: (Ljava/nio/ByteBuffer;II)V
+ */
+JNIEXPORT void JNICALL Java_com_codeminders_hidapi_HIDDevice_attachInputRing
+  (JNIEnv *, jobject, jobject, jint, jint);
+
+/*
+ * Class:     com_codeminders_hidapi_HIDDevice
+ * Method:    detachInputRing
+ * Signature: ()V
+ */
+JNIEXPORT void JNICALL Java_com_codeminders_hidapi_HIDDevice_detachInputRing
+  (JNIEnv *, jobject);
+
+/*
+ * Class:     com_codeminders_hidapi_HIDDevice
+ * Method:    waitInputRing
+ * Signature: (I)I
+ */
+JNIEXPORT jint JNICALL Java_com_codeminders_hidapi_HIDDevice_waitInputRing
+  (JNIEnv *, jobject, jint);
+
+/*
+ * Class:     com_codeminders_hidapi_HIDDevice
+ * Method:    readSequencedNative
+ * Signature: ([B[J[JI)I
+ */
+JNIEXPORT jint JNICALL Java_com_codeminders_hidapi_HIDDevice_readSequencedNative
+  (JNIEnv *, jobject, jbyteArray, jlongArray, jlongArray, jint);
+
+/*
+ * Class:     com_codeminders_hidapi_HIDDevice
+ * Method:    getDroppedCount
+ * Signature: ()J
+ */
+JNIEXPORT jlong JNICALL Java_com_codeminders_hidapi_HIDDevice_getDroppedCount
+  (JNIEnv *, jobject);
+
+/*
+ * Class:     com_codeminders_hidapi_HIDDevice
+ * Method:    getStatsNative
+ * Signature: ([J)V
+ */
+JNIEXPORT void JNICALL Java_com_codeminders_hidapi_HIDDevice_getStatsNative
+  (JNIEnv *, jobject, jlongArray);
+
+/*
+ * Class:     com_codeminders_hidapi_HIDDevice
+ * Method:    getLatencyHistogramNative
+ * Signature: (I[JZ)V
+ */
+JNIEXPORT void JNICALL Java_com_codeminders_hidapi_HIDDevice_getLatencyHistogramNative
+  (JNIEnv *, jobject, jint, jlongArray, jboolean);
+
 #ifdef __cplusplus
 }
 #endif
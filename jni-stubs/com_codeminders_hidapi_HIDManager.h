@@ -16,6 +16,30 @@ extern "C" {
 JNIEXPORT jobjectArray JNICALL Java_com_codeminders_hidapi_HIDManager_listDevices
   (JNIEnv *, jobject);
 
+/*
+ * Class:     com_codeminders_hidapi_HIDManager
+ * Method:    listDevicesNative
+ * Signature: (Ljava/lang/String;)[Lcom/codeminders/hidapi/HIDDeviceInfo;
+ */
+JNIEXPORT jobjectArray JNICALL Java_com_codeminders_hidapi_HIDManager_listDevicesNative
+  (JNIEnv *, jobject, jstring);
+
+/*
+ * Class:     com_codeminders_hidapi_HIDManager
+ * Method:    setBackend
+ * Signature: (Ljava/lang/String;)V
+ */
+JNIEXPORT void JNICALL Java_com_codeminders_hidapi_HIDManager_setBackend
+  (JNIEnv *, jobject, jstring);
+
+/*
+ * Class:     com_codeminders_hidapi_HIDManager
+ * Method:    getBackend
+ * Signature: ()Ljava/lang/String;
+ */
+JNIEXPORT jstring JNICALL Java_com_codeminders_hidapi_HIDManager_getBackend
+  (JNIEnv *, jobject);
+
 /*
  * Class:     com_codeminders_hidapi_HIDManager
  * Method:    init
@@ -32,6 +56,22 @@ JNIEXPORT void JNICALL Java_com_codeminders_hidapi_HIDManager_init
 JNIEXPORT void JNICALL Java_com_codeminders_hidapi_HIDManager_release
   (JNIEnv *, jobject);
 
+/*
+ * Class:     com_codeminders_hidapi_HIDManager
+ * Method:    startHotplug
+ * Signature: ()V
+ */
+JNIEXPORT void JNICALL Java_com_codeminders_hidapi_HIDManager_startHotplug
+  (JNIEnv *, jobject);
+
+/*
+ * Class:     com_codeminders_hidapi_HIDManager
+ * Method:    stopHotplug
+ * Signature: ()V
+ */
+JNIEXPORT void JNICALL Java_com_codeminders_hidapi_HIDManager_stopHotplug
+  (JNIEnv *, jobject);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,53 @@
+/* DO NOT EDIT THIS FILE - it is machine generated */
+#include <jni.h>
+/* Header for class com_codeminders_hidapi_HIDSelector */
+
+#ifndef _Included_com_codeminders_hidapi_HIDSelector
+#define _Included_com_codeminders_hidapi_HIDSelector
+#ifdef __cplusplus
+extern "C" {
+#endif
+/*
+ * Class:     com_codeminders_hidapi_HIDSelector
+ * Method:    close
+ * Signature: ()V
+ */
+JNIEXPORT void JNICALL Java_com_codeminders_hidapi_HIDSelector_close
+  (JNIEnv *, jobject);
+
+/*
+ * Class:     com_codeminders_hidapi_HIDSelector
+ * Method:    init
+ * Signature: ()V
+ */
+JNIEXPORT void JNICALL Java_com_codeminders_hidapi_HIDSelector_init
+  (JNIEnv *, jobject);
+
+/*
+ * Class:     com_codeminders_hidapi_HIDSelector
+ * Method:    addDevice
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_com_codeminders_hidapi_HIDSelector_addDevice
+  (JNIEnv *, jobject, jlong);
+
+/*
+ * Class:     com_codeminders_hidapi_HIDSelector
+ * Method:    removeDevice
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_com_codeminders_hidapi_HIDSelector_removeDevice
+  (JNIEnv *, jobject, jlong);
+
+/*
+ * Class:     com_codeminders_hidapi_HIDSelector
+ * Method:    waitDevices
+ * Signature: ([JII)I
+ */
+JNIEXPORT jint JNICALL Java_com_codeminders_hidapi_HIDSelector_waitDevices
+  (JNIEnv *, jobject, jlongArray, jint, jint);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
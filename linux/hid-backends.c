@@ -0,0 +1,388 @@
+/*******************************************************
+ HIDAPI - Multi-Platform library for
+ communication with HID devices.
+
+ Selects the implementation at run time: hidraw (hid.c),
+ libusb (hid-libusb.c) or the in-memory one (../mock/hid.c).
+
+ At the discretion of the user of this library,
+ this software may be licensed under the terms of the
+ GNU Public License v3, a BSD-Style license, or the
+ original HIDAPI license as outlined in the LICENSE.txt,
+ LICENSE-gpl3.txt, LICENSE-bsd.txt, and LICENSE-orig.txt
+ files located at the root of the source distribution.
+ These files may also be found in the public source
+ code repository located at:
+        http://github.com/signal11/hidapi .
+********************************************************/
+
+/* Each implementation is built with its own names, see hid-backend.h,
+   and the functions here pass every call on to the right one: the one
+   which made the device or reactor, or otherwise the one selected with
+   hid_set_backend(). A call costs one more indirect call. */
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "hid-backend.h"
+
+/* Every device, reactor and hotplug monitor starts with its
+   implementation. */
+struct hid_device_ {
+	const struct hid_backend *backend;
+};
+
+struct hid_reactor_ {
+	const struct hid_backend *backend;
+};
+
+struct hid_hotplug_ {
+	const struct hid_backend *backend;
+};
+
+static const struct hid_backend *backends[] = {
+	&hid_libusb_backend, /* The first is the default. */
+	&hid_hidraw_backend,
+	&hid_mock_backend,
+};
+
+#define NUM_BACKENDS (sizeof(backends) / sizeof(backends[0]))
+
+/* Protects initialized and the first choice of current. */
+static pthread_mutex_t backend_mutex = PTHREAD_MUTEX_INITIALIZER;
+static const struct hid_backend *current;
+static int initialized[NUM_BACKENDS];
+
+static const struct hid_backend *find_backend(const char *name)
+{
+	size_t i;
+
+	if (!name)
+		return NULL;
+	for (i = 0; i < NUM_BACKENDS; i++) {
+		if (strcmp(backends[i]->name, name) == 0)
+			return backends[i];
+	}
+	return NULL;
+}
+
+/* The implementation selected, which is initialized on first use, as
+   the implementations do themselves. */
+static const struct hid_backend *selected(void)
+{
+	const struct hid_backend *backend = __atomic_load_n(&current, __ATOMIC_ACQUIRE);
+
+	if (!backend) {
+		pthread_mutex_lock(&backend_mutex);
+		if (!current) {
+			backend = find_backend(getenv("HIDAPI_BACKEND"));
+			__atomic_store_n(&current, backend? backend: backends[0], __ATOMIC_RELEASE);
+		}
+		backend = current;
+		pthread_mutex_unlock(&backend_mutex);
+	}
+	return backend;
+}
+
+static int init_backend(const struct hid_backend *backend)
+{
+	size_t i;
+	int res = 0;
+
+	pthread_mutex_lock(&backend_mutex);
+	for (i = 0; i < NUM_BACKENDS; i++) {
+		if (backends[i] == backend && !initialized[i]) {
+			res = backend->init();
+			initialized[i] = (res == 0);
+		}
+	}
+	pthread_mutex_unlock(&backend_mutex);
+	return res;
+}
+
+int HID_API_EXPORT hid_set_backend(const char *name)
+{
+	const struct hid_backend *backend = find_backend(name);
+
+	if (!backend)
+		return -1;
+	__atomic_store_n(&current, backend, __ATOMIC_RELEASE);
+	return 0;
+}
+
+HID_API_EXPORT const char * HID_API_CALL hid_get_backend(void)
+{
+	return selected()->name;
+}
+
+int HID_API_EXPORT hid_enumerate_backend(const char *name, unsigned short vendor_id, unsigned short product_id, struct hid_device_info **devs)
+{
+	const struct hid_backend *backend = name? find_backend(name): selected();
+
+	*devs = NULL;
+	if (!backend)
+		return -1;
+	if (init_backend(backend) == 0)
+		*devs = backend->enumerate(vendor_id, product_id);
+	return 0;
+}
+
+hid_device * HID_API_EXPORT hid_open_path_backend(const char *name, const char *path)
+{
+	const struct hid_backend *backend = name? find_backend(name): selected();
+
+	if (!backend || init_backend(backend) < 0)
+		return NULL;
+	return backend->open_path(path);
+}
+
+HID_API_EXPORT const char * HID_API_CALL hid_get_device_backend(hid_device *dev)
+{
+	return dev->backend->name;
+}
+
+int HID_API_EXPORT hid_init(void)
+{
+	return init_backend(selected());
+}
+
+int HID_API_EXPORT hid_exit(void)
+{
+	size_t i;
+	int res = 0;
+
+	pthread_mutex_lock(&backend_mutex);
+	for (i = 0; i < NUM_BACKENDS; i++) {
+		if (initialized[i]) {
+			if (backends[i]->exit() < 0)
+				res = -1;
+			initialized[i] = 0;
+		}
+	}
+	pthread_mutex_unlock(&backend_mutex);
+	return res;
+}
+
+int HID_API_EXPORT hid_set_io_engine(int engine)
+{
+	return selected()->set_io_engine(engine);
+}
+
+struct hid_device_info HID_API_EXPORT *hid_enumerate(unsigned short vendor_id, unsigned short product_id)
+{
+	const struct hid_backend *backend = selected();
+
+	if (init_backend(backend) < 0)
+		return NULL;
+	return backend->enumerate(vendor_id, product_id);
+}
+
+void HID_API_EXPORT hid_free_enumeration(struct hid_device_info *devs)
+{
+	/* Every implementation allocates the list the same way. */
+	selected()->free_enumeration(devs);
+}
+
+hid_device * HID_API_EXPORT hid_open(unsigned short vendor_id, unsigned short product_id, const wchar_t *serial_number)
+{
+	const struct hid_backend *backend = selected();
+
+	if (init_backend(backend) < 0)
+		return NULL;
+	return backend->open(vendor_id, product_id, serial_number);
+}
+
+hid_device * HID_API_EXPORT hid_open_path(const char *path)
+{
+	const struct hid_backend *backend = selected();
+
+	if (init_backend(backend) < 0)
+		return NULL;
+	return backend->open_path(path);
+}
+
+int HID_API_EXPORT hid_write(hid_device *dev, const unsigned char *data, size_t length)
+{
+	return dev->backend->write(dev, data, length);
+}
+
+int HID_API_EXPORT hid_read_timeout(hid_device *dev, unsigned char *data, size_t length, int milliseconds)
+{
+	return dev->backend->read_timeout(dev, data, length, milliseconds);
+}
+
+int HID_API_EXPORT hid_read(hid_device *dev, unsigned char *data, size_t length)
+{
+	return dev->backend->read(dev, data, length);
+}
+
+int HID_API_EXPORT hid_read_timestamped(hid_device *dev, unsigned char *data, size_t length, unsigned long long *timestamp, int milliseconds)
+{
+	return dev->backend->read_timestamped(dev, data, length, timestamp, milliseconds);
+}
+
+int HID_API_EXPORT hid_read_sequenced(hid_device *dev, unsigned char *data, size_t length, unsigned long long *sequence, unsigned long long *timestamp, int milliseconds)
+{
+	return dev->backend->read_sequenced(dev, data, length, sequence, timestamp, milliseconds);
+}
+
+int HID_API_EXPORT hid_get_dropped_count(hid_device *dev, unsigned long long *count)
+{
+	return dev->backend->get_dropped_count(dev, count);
+}
+
+int HID_API_EXPORT hid_get_stats(hid_device *dev, struct hid_device_stats *stats)
+{
+	return dev->backend->get_stats(dev, stats);
+}
+
+int HID_API_EXPORT hid_get_latency_histogram(hid_device *dev, int kind, struct hid_histogram *histogram, int reset)
+{
+	return dev->backend->get_latency_histogram(dev, kind, histogram, reset);
+}
+
+int HID_API_EXPORT hid_read_many(hid_device *dev, unsigned char *data, size_t *length, int max_reports, int milliseconds)
+{
+	return dev->backend->read_many(dev, data, length, max_reports, milliseconds);
+}
+
+int HID_API_EXPORT hid_get_poll_fd(hid_device *dev)
+{
+	return dev->backend->get_poll_fd(dev);
+}
+
+hid_reactor * HID_API_EXPORT hid_reactor_create(void)
+{
+	const struct hid_backend *backend = selected();
+
+	if (init_backend(backend) < 0)
+		return NULL;
+	return backend->reactor_create();
+}
+
+hid_reactor * HID_API_EXPORT hid_reactor_create_backend(const char *name)
+{
+	const struct hid_backend *backend = name? find_backend(name): selected();
+
+	if (!backend || init_backend(backend) < 0)
+		return NULL;
+	return backend->reactor_create();
+}
+
+int HID_API_EXPORT hid_reactor_add(hid_reactor *reactor, hid_device *dev)
+{
+	/* A reactor only knows the devices of its own implementation. */
+	if (dev->backend != reactor->backend)
+		return -1;
+	return reactor->backend->reactor_add(reactor, dev);
+}
+
+int HID_API_EXPORT hid_reactor_remove(hid_reactor *reactor, hid_device *dev)
+{
+	if (dev->backend != reactor->backend)
+		return -1;
+	return reactor->backend->reactor_remove(reactor, dev);
+}
+
+int HID_API_EXPORT hid_reactor_wait(hid_reactor *reactor, hid_device **ready, int max_ready, int milliseconds)
+{
+	return reactor->backend->reactor_wait(reactor, ready, max_ready, milliseconds);
+}
+
+void HID_API_EXPORT hid_reactor_destroy(hid_reactor *reactor)
+{
+	if (reactor)
+		reactor->backend->reactor_destroy(reactor);
+}
+
+hid_hotplug * HID_API_EXPORT hid_hotplug_create(unsigned short vendor_id, unsigned short product_id)
+{
+	const struct hid_backend *backend = selected();
+
+	if (init_backend(backend) < 0)
+		return NULL;
+	return backend->hotplug_create(vendor_id, product_id);
+}
+
+int HID_API_EXPORT hid_hotplug_wait(hid_hotplug *hotplug, struct hid_device_info **device, int milliseconds)
+{
+	return hotplug->backend->hotplug_wait(hotplug, device, milliseconds);
+}
+
+void HID_API_EXPORT hid_hotplug_destroy(hid_hotplug *hotplug)
+{
+	if (hotplug)
+		hotplug->backend->hotplug_destroy(hotplug);
+}
+
+int HID_API_EXPORT hid_set_nonblocking(hid_device *dev, int nonblock)
+{
+	return dev->backend->set_nonblocking(dev, nonblock);
+}
+
+int HID_API_EXPORT hid_set_input_queue(hid_device *dev, int capacity, int policy)
+{
+	return dev->backend->set_input_queue(dev, capacity, policy);
+}
+
+int HID_API_EXPORT hid_set_input_transfers(hid_device *dev, int count)
+{
+	return dev->backend->set_input_transfers(dev, count);
+}
+
+int HID_API_EXPORT hid_set_input_ring(hid_device *dev, struct hid_input_ring *ring, size_t size)
+{
+	return dev->backend->set_input_ring(dev, ring, size);
+}
+
+int HID_API_EXPORT hid_input_ring_wait(hid_device *dev, int milliseconds)
+{
+	return dev->backend->input_ring_wait(dev, milliseconds);
+}
+
+int HID_API_EXPORT hid_input_ring_read(hid_device *dev, unsigned char *data, size_t length, unsigned long long *timestamp, int milliseconds)
+{
+	return dev->backend->input_ring_read(dev, data, length, timestamp, milliseconds);
+}
+
+int HID_API_EXPORT hid_send_feature_report(hid_device *dev, const unsigned char *data, size_t length)
+{
+	return dev->backend->send_feature_report(dev, data, length);
+}
+
+int HID_API_EXPORT hid_get_feature_report(hid_device *dev, unsigned char *data, size_t length)
+{
+	return dev->backend->get_feature_report(dev, data, length);
+}
+
+void HID_API_EXPORT hid_close(hid_device *dev)
+{
+	if (dev)
+		dev->backend->close(dev);
+}
+
+int HID_API_EXPORT_CALL hid_get_manufacturer_string(hid_device *dev, wchar_t *string, size_t maxlen)
+{
+	return dev->backend->get_manufacturer_string(dev, string, maxlen);
+}
+
+int HID_API_EXPORT_CALL hid_get_product_string(hid_device *dev, wchar_t *string, size_t maxlen)
+{
+	return dev->backend->get_product_string(dev, string, maxlen);
+}
+
+int HID_API_EXPORT_CALL hid_get_serial_number_string(hid_device *dev, wchar_t *string, size_t maxlen)
+{
+	return dev->backend->get_serial_number_string(dev, string, maxlen);
+}
+
+int HID_API_EXPORT_CALL hid_get_indexed_string(hid_device *dev, int string_index, wchar_t *string, size_t maxlen)
+{
+	return dev->backend->get_indexed_string(dev, string_index, string, maxlen);
+}
+
+HID_API_EXPORT const wchar_t * HID_API_CALL hid_error(hid_device *dev)
+{
+	return (dev? dev->backend: selected())->error(dev);
+}
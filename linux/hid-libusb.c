@@ -41,13 +41,20 @@
 #include <sys/utsname.h>
 #include <fcntl.h>
 #include <pthread.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <time.h>
 #include <wchar.h>
 
 /* GNU / LibUSB */
 #include "libusb.h"
 #include "iconv.h"
 
-#include "hidapi.h"
+#include "hid-backend.h"
+#include "hid-probes.h"
+#include "hid-ring.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -71,15 +78,26 @@ libusb HIDAPI programs are encouraged to use the interface number
 instead to differentiate between interfaces on a composite HID device. */
 /*#define INVASIVE_GET_USAGE*/
 
-/* Linked List of input reports received from the device. */
+/* Default capacity of the input report ring, see hid_set_input_queue(). */
+#define INPUT_QUEUE_SIZE 30
+
+/* The most devices returned by one hid_reactor_wait(). */
+#define REACTOR_MAX_EVENTS 256
+
+/* A slot in the ring of input reports received from the device. The
+   data buffers are allocated once, when the device is opened, and are
+   input_ep_max_packet_size bytes each. */
 struct input_report {
 	uint8_t *data;
 	size_t len;
-	struct input_report *next;
+	unsigned long long timestamp; /* CLOCK_MONOTONIC ns, when the transfer completed */
+	unsigned long long sequence;
 };
 
 
 struct hid_device_ {
+	HID_BACKEND_HEADER
+
 	/* Handle to the actual device. */
 	libusb_device_handle *device_handle;
 	
@@ -98,40 +116,187 @@ struct hid_device_ {
 	
 	/* Whether blocking reads are used */
 	int blocking; /* boolean */
+
+	/* Whether the report descriptor has Report ID items, in which case
+	   the first byte of each report is its Report ID. */
+	int uses_numbered_reports; /* boolean */
 	
-	/* Read thread objects */
-	pthread_t thread;
-	pthread_mutex_t mutex; /* Protects input_reports */
+	/* Input transfer objects. The transfers are completed by the shared
+	   event thread, see event_thread_acquire(). next_transfer is the
+	   oldest one submitted; completions are handled in that order. */
+	pthread_mutex_t mutex; /* Protects the input report ring and everything below */
 	pthread_cond_t condition;
-	pthread_barrier_t barrier; /* Ensures correct startup sequence */
-	int shutdown_thread;
-	struct libusb_transfer *transfer;
-
-	/* List of received input reports. */
+	int shutdown_input; /* boolean, no more reports will be queued */
+	int cancelling; /* boolean, don't resubmit completed transfers */
+	struct libusb_transfer *transfers[HID_MAX_INPUT_TRANSFERS];
+	int transfer_state[HID_MAX_INPUT_TRANSFERS];
+	unsigned long long transfer_time[HID_MAX_INPUT_TRANSFERS]; /* When each one completed */
+	uint8_t *transfer_buffer;
+	int num_transfers;
+	int next_transfer;
+	int transfers_pending; /* Number of transfers not TRANSFER_IDLE */
+
+	/* An eventfd which is readable while reports are queued or the
+	   input is shut down, see hid_get_poll_fd(). It is created on
+	   first use, see get_poll_fd(). */
+	int poll_fd;
+	int poll_signalled; /* boolean */
+
+	/* Ring of received input reports. input_head is the oldest
+	   report and input_count the number queued. input_size slots are
+	   allocated; with HID_QUEUE_GROW this doubles up to input_capacity,
+	   otherwise the two are equal. */
 	struct input_report *input_reports;
+	uint8_t *input_buffer;
+	int input_size;
+	int input_capacity;
+	int input_policy;
+	int input_head;
+	int input_count;
+
+	/* Every report received is numbered from 0, so readers can spot
+	   the ones dropped, which are counted in stats. */
+	unsigned long long next_sequence;
+
+	/* See hid_get_stats(). Updated with relaxed atomics, since
+	   hid_write() doesn't take dev->mutex. */
+	struct hid_device_stats stats;
+	struct hid_histogram latency[HID_LATENCY_FEATURE + 1];
+
+	/* When not NULL, reports are written to this ring instead of the
+	   one above. See hid_set_input_ring(). */
+	struct hid_input_ring *shared_ring;
+};
+
+/* transfer_state values */
+enum {
+	TRANSFER_IDLE,      /* Not submitted */
+	TRANSFER_SUBMITTED, /* Owned by libusb */
+	TRANSFER_COMPLETED, /* Waiting for an older transfer to complete */
 };
 
 static libusb_context *usb_context = NULL;
 
+/* One thread handles libusb events for all open devices and hotplug
+   monitors. It is started by the first hid_open_path() or
+   hid_hotplug_create() and stopped when the last device is closed and
+   the last monitor destroyed. event_mutex protects event_refs and
+   serializes starting and stopping the thread. */
+static pthread_t event_thread;
+static pthread_mutex_t event_mutex = PTHREAD_MUTEX_INITIALIZER;
+static int event_refs = 0;
+static int event_stop = 0;
+
 uint16_t get_usb_code_for_current_locale(void);
 static int return_data(hid_device *dev, unsigned char *data, size_t length);
+static int resize_input_queue(hid_device *dev, int size);
+static void update_poll_fd(hid_device *dev);
 
 static hid_device *new_hid_device(void)
 {
 	hid_device *dev = calloc(1, sizeof(hid_device));
+	HID_BACKEND_INIT(dev);
 	dev->blocking = 1;
+	dev->input_capacity = INPUT_QUEUE_SIZE;
+	dev->input_policy = HID_QUEUE_DROP_OLDEST;
+	dev->num_transfers = 1;
+	dev->poll_fd = -1;
 	
 	pthread_mutex_init(&dev->mutex, NULL);
 	pthread_cond_init(&dev->condition, NULL);
-	pthread_barrier_init(&dev->barrier, NULL, 2);
 	
 	return dev;
 }
 
+#define STAT_ADD(dev, field, n) __atomic_add_fetch(&(dev)->stats.field, (n), __ATOMIC_RELAXED)
+
+static void stat_max(unsigned long long *stat, unsigned long long value)
+{
+	unsigned long long old = __atomic_load_n(stat, __ATOMIC_RELAXED);
+	while (value > old &&
+	       !__atomic_compare_exchange_n(stat, &old, value, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+		;
+}
+
+/* See hid_histogram for the bucket layout. */
+static void record_latency(hid_device *dev, int kind, unsigned long long ns)
+{
+	struct hid_histogram *h = &dev->latency[kind];
+	unsigned long long index = ns;
+
+	if (ns >= 2 * HID_HISTOGRAM_SUB_BUCKETS) {
+		int e = 63 - __builtin_clzll(ns) - __builtin_ctz(HID_HISTOGRAM_SUB_BUCKETS);
+		index = e * HID_HISTOGRAM_SUB_BUCKETS + (ns >> e);
+		if (index >= HID_HISTOGRAM_BUCKETS)
+			index = HID_HISTOGRAM_BUCKETS - 1;
+	}
+	__atomic_add_fetch(&h->counts[index], 1, __ATOMIC_RELAXED);
+	__atomic_add_fetch(&h->total, ns, __ATOMIC_RELAXED);
+	stat_max(&h->max, ns);
+}
+
+static void count_dropped(hid_device *dev)
+{
+	STAT_ADD(dev, reports_dropped, 1);
+	HID_PROBE1(report_drop, dev);
+}
+
+/* (Re)allocate the input report ring with room for size reports. Queued
+   reports are carried over, dropping the oldest ones if they don't all
+   fit. Returns 0 on success and -1 if the allocation failed, in which
+   case the old ring is left alone.
+   This should be called with dev->mutex locked once the input
+   transfer has been submitted. */
+static int resize_input_queue(hid_device *dev, int size)
+{
+	int i;
+	size_t slot_size = dev->input_ep_max_packet_size;
+	struct input_report *reports;
+	uint8_t *buffer;
+
+	reports = calloc(size, sizeof(struct input_report));
+	buffer = malloc(size * slot_size);
+	if (!reports || !buffer) {
+		free(reports);
+		free(buffer);
+		return -1;
+	}
+	for (i = 0; i < size; i++)
+		reports[i].data = buffer + i * slot_size;
+
+	/* Carry over the newest reports, oldest first. */
+	while (dev->input_count > size) {
+		return_data(dev, NULL, 0);
+		count_dropped(dev);
+	}
+	for (i = 0; i < dev->input_count; i++) {
+		struct input_report *rpt = &dev->input_reports[(dev->input_head + i) % dev->input_size];
+		memcpy(reports[i].data, rpt->data, rpt->len);
+		reports[i].len = rpt->len;
+		reports[i].timestamp = rpt->timestamp;
+		reports[i].sequence = rpt->sequence;
+	}
+
+	free(dev->input_reports);
+	free(dev->input_buffer);
+	dev->input_reports = reports;
+	dev->input_buffer = buffer;
+	dev->input_size = size;
+	dev->input_head = 0;
+
+	return 0;
+}
+
 static void free_hid_device(hid_device *dev)
 {
+	/* Free the input report ring */
+	free(dev->input_reports);
+	free(dev->input_buffer);
+
+	if (dev->poll_fd >= 0)
+		close(dev->poll_fd);
+
 	/* Clean up the thread objects */
-	pthread_barrier_destroy(&dev->barrier);
 	pthread_cond_destroy(&dev->condition);
 	pthread_mutex_destroy(&dev->mutex);
 
@@ -147,6 +312,45 @@ static void register_error(hid_device *device, const char *op)
 }
 #endif
 
+/* uses_numbered_reports() returns 1 if report_descriptor describes a device
+   which contains numbered reports. */
+static int uses_numbered_reports(uint8_t *report_descriptor, size_t size)
+{
+	size_t i = 0;
+	int data_len, key_size;
+
+	while (i < size) {
+		int key = report_descriptor[i];
+
+		/* Check for the Report ID key */
+		if (key == 0x85/*Report ID*/)
+			return 1;
+
+		if ((key & 0xf0) == 0xf0) {
+			/* A Long Item, whose data length is in the next byte.
+			   See the HID specification, version 1.11, section
+			   6.2.2.3. */
+			data_len = (i+1 < size)? report_descriptor[i+1]: 0;
+			key_size = 3;
+		}
+		else {
+			/* A Short Item, the bottom two bits of the key give
+			   the size of its data: 0, 1, 2 or 4 bytes. See
+			   section 6.2.2.2. */
+			data_len = key & 0x3;
+			if (data_len == 3)
+				data_len = 4;
+			key_size = 1;
+		}
+
+		/* Skip over this key and its associated data */
+		i += data_len + key_size;
+	}
+
+	/* Didn't find a Report ID key. Device doesn't use numbered reports. */
+	return 0;
+}
+
 #ifdef INVASIVE_GET_USAGE
 /* Get bytes from a HID Report Descriptor.
    Only call with a num_bytes of 0, 1, 2, or 4. */
@@ -431,166 +635,240 @@ int HID_API_EXPORT hid_exit(void)
 	return 0;
 }
 
-struct hid_device_info  HID_API_EXPORT *hid_enumerate(unsigned short vendor_id, unsigned short product_id)
+int HID_API_EXPORT hid_set_io_engine(int engine)
+{
+	/* Only the default engine on this platform. */
+	return (engine == HID_IO_ENGINE_DEFAULT)? 0: -1;
+}
+
+int HID_API_EXPORT hid_set_backend(const char *name)
+{
+	/* This is the only implementation in the library. */
+	return (name && strcmp(name, "libusb") == 0)? 0: -1;
+}
+
+HID_API_EXPORT const char * HID_API_CALL hid_get_backend(void)
+{
+	return "libusb";
+}
+
+int HID_API_EXPORT hid_enumerate_backend(const char *backend, unsigned short vendor_id, unsigned short product_id, struct hid_device_info **devs)
+{
+	*devs = NULL;
+	if (backend && strcmp(backend, hid_get_backend()) != 0)
+		return -1;
+	*devs = hid_enumerate(vendor_id, product_id);
+	return 0;
+}
+
+hid_device * HID_API_EXPORT hid_open_path_backend(const char *backend, const char *path)
+{
+	if (backend && strcmp(backend, hid_get_backend()) != 0)
+		return NULL;
+	return hid_open_path(path);
+}
+
+HID_API_EXPORT const char * HID_API_CALL hid_get_device_backend(hid_device *dev)
+{
+	return hid_get_backend();
+}
+
+hid_reactor * HID_API_EXPORT hid_reactor_create_backend(const char *backend)
+{
+	if (backend && strcmp(backend, hid_get_backend()) != 0)
+		return NULL;
+	return hid_reactor_create();
+}
+
+/* Describe the HID interfaces of a USB device which match the VID/PID
+   (0x0, 0x0 matching any). */
+static struct hid_device_info *create_device_infos(libusb_device *dev, unsigned short vendor_id, unsigned short product_id)
 {
-	libusb_device **devs;
-	libusb_device *dev;
 	libusb_device_handle *handle;
-	ssize_t num_devs;
-	int i = 0;
-	
 	struct hid_device_info *root = NULL; // return object
 	struct hid_device_info *cur_dev = NULL;
+	struct libusb_device_descriptor desc;
+	struct libusb_config_descriptor *conf_desc = NULL;
+	int j, k;
+	int interface_num = 0;
+
+	int res = libusb_get_device_descriptor(dev, &desc);
+	unsigned short dev_vid = desc.idVendor;
+	unsigned short dev_pid = desc.idProduct;
 	
-	hid_init();
-
-	num_devs = libusb_get_device_list(usb_context, &devs);
-	if (num_devs < 0)
+	/* HID's are defined at the interface level. */
+	if (desc.bDeviceClass != LIBUSB_CLASS_PER_INTERFACE)
 		return NULL;
-	while ((dev = devs[i++]) != NULL) {
-		struct libusb_device_descriptor desc;
-		struct libusb_config_descriptor *conf_desc = NULL;
-		int j, k;
-		int interface_num = 0;
 
-		int res = libusb_get_device_descriptor(dev, &desc);
-		unsigned short dev_vid = desc.idVendor;
-		unsigned short dev_pid = desc.idProduct;
-		
-		/* HID's are defined at the interface level. */
-		if (desc.bDeviceClass != LIBUSB_CLASS_PER_INTERFACE)
-			continue;
+	res = libusb_get_active_config_descriptor(dev, &conf_desc);
+	if (res < 0)
+		libusb_get_config_descriptor(dev, 0, &conf_desc);
+	if (conf_desc) {
+		for (j = 0; j < conf_desc->bNumInterfaces; j++) {
+			const struct libusb_interface *intf = &conf_desc->interface[j];
+			for (k = 0; k < intf->num_altsetting; k++) {
+				const struct libusb_interface_descriptor *intf_desc;
+				intf_desc = &intf->altsetting[k];
+				if (intf_desc->bInterfaceClass == LIBUSB_CLASS_HID) {
+					interface_num = intf_desc->bInterfaceNumber;
 
-		res = libusb_get_active_config_descriptor(dev, &conf_desc);
-		if (res < 0)
-			libusb_get_config_descriptor(dev, 0, &conf_desc);
-		if (conf_desc) {
-			for (j = 0; j < conf_desc->bNumInterfaces; j++) {
-				const struct libusb_interface *intf = &conf_desc->interface[j];
-				for (k = 0; k < intf->num_altsetting; k++) {
-					const struct libusb_interface_descriptor *intf_desc;
-					intf_desc = &intf->altsetting[k];
-					if (intf_desc->bInterfaceClass == LIBUSB_CLASS_HID) {
-						interface_num = intf_desc->bInterfaceNumber;
-
-						/* Check the VID/PID against the arguments */
-						if ((vendor_id == 0x0 && product_id == 0x0) ||
-						    (vendor_id == dev_vid && product_id == dev_pid)) {
-							struct hid_device_info *tmp;
-
-							/* VID/PID match. Create the record. */
-							tmp = calloc(1, sizeof(struct hid_device_info));
-							if (cur_dev) {
-								cur_dev->next = tmp;
-							}
-							else {
-								root = tmp;
-							}
-							cur_dev = tmp;
-							
-							/* Fill out the record */
-							cur_dev->next = NULL;
-							cur_dev->path = make_path(dev, interface_num);
-							
-							res = libusb_open(dev, &handle);
+					/* Check the VID/PID against the arguments */
+					if ((vendor_id == 0x0 && product_id == 0x0) ||
+					    (vendor_id == dev_vid && product_id == dev_pid)) {
+						struct hid_device_info *tmp;
 
-							if (res >= 0) {
-								/* Serial Number */
-								if (desc.iSerialNumber > 0)
-									cur_dev->serial_number =
-										get_usb_string(handle, desc.iSerialNumber);
-
-								/* Manufacturer and Product strings */
-								if (desc.iManufacturer > 0)
-									cur_dev->manufacturer_string =
-										get_usb_string(handle, desc.iManufacturer);
-								if (desc.iProduct > 0)
-									cur_dev->product_string =
-										get_usb_string(handle, desc.iProduct);
+						/* VID/PID match. Create the record. */
+						tmp = calloc(1, sizeof(struct hid_device_info));
+						if (cur_dev) {
+							cur_dev->next = tmp;
+						}
+						else {
+							root = tmp;
+						}
+						cur_dev = tmp;
+						cur_dev->backend = hid_get_backend();
+						
+						/* Fill out the record */
+						cur_dev->next = NULL;
+						cur_dev->path = make_path(dev, interface_num);
+						
+						res = libusb_open(dev, &handle);
+
+						if (res >= 0) {
+							/* Serial Number */
+							if (desc.iSerialNumber > 0)
+								cur_dev->serial_number =
+									get_usb_string(handle, desc.iSerialNumber);
+
+							/* Manufacturer and Product strings */
+							if (desc.iManufacturer > 0)
+								cur_dev->manufacturer_string =
+									get_usb_string(handle, desc.iManufacturer);
+							if (desc.iProduct > 0)
+								cur_dev->product_string =
+									get_usb_string(handle, desc.iProduct);
 
 #ifdef INVASIVE_GET_USAGE
-							/*
-							This section is removed because it is too
-							invasive on the system. Getting a Usage Page
-							and Usage requires parsing the HID Report
-							descriptor. Getting a HID Report descriptor
-							involves claiming the interface. Claiming the
-							interface involves detaching the kernel driver.
-							Detaching the kernel driver is hard on the system
-							because it will unclaim interfaces (if another
-							app has them claimed) and the re-attachment of
-							the driver will sometimes change /dev entry names.
-							It is for these reasons that this section is
-							#if 0. For composite devices, use the interface
-							field in the hid_device_info struct to distinguish
-							between interfaces. */
-								unsigned char data[256];
+						/*
+						This section is removed because it is too
+						invasive on the system. Getting a Usage Page
+						and Usage requires parsing the HID Report
+						descriptor. Getting a HID Report descriptor
+						involves claiming the interface. Claiming the
+						interface involves detaching the kernel driver.
+						Detaching the kernel driver is hard on the system
+						because it will unclaim interfaces (if another
+						app has them claimed) and the re-attachment of
+						the driver will sometimes change /dev entry names.
+						It is for these reasons that this section is
+						#if 0. For composite devices, use the interface
+						field in the hid_device_info struct to distinguish
+						between interfaces. */
+							unsigned char data[256];
 #ifdef DETACH_KERNEL_DRIVER
-								int detached = 0;
-								/* Usage Page and Usage */
-								res = libusb_kernel_driver_active(handle, interface_num);
-								if (res == 1) {
-									res = libusb_detach_kernel_driver(handle, interface_num);
-									if (res < 0)
-										LOG("Couldn't detach kernel driver, even though a kernel driver was attached.");
-									else
-										detached = 1;
-								}
+							int detached = 0;
+							/* Usage Page and Usage */
+							res = libusb_kernel_driver_active(handle, interface_num);
+							if (res == 1) {
+								res = libusb_detach_kernel_driver(handle, interface_num);
+								if (res < 0)
+									LOG("Couldn't detach kernel driver, even though a kernel driver was attached.");
+								else
+									detached = 1;
+							}
 #endif
-								res = libusb_claim_interface(handle, interface_num);
+							res = libusb_claim_interface(handle, interface_num);
+							if (res >= 0) {
+								/* Get the HID Report Descriptor. */
+								res = libusb_control_transfer(handle, LIBUSB_ENDPOINT_IN|LIBUSB_RECIPIENT_INTERFACE, LIBUSB_REQUEST_GET_DESCRIPTOR, (LIBUSB_DT_REPORT << 8)|interface_num, 0, data, sizeof(data), 5000);
 								if (res >= 0) {
-									/* Get the HID Report Descriptor. */
-									res = libusb_control_transfer(handle, LIBUSB_ENDPOINT_IN|LIBUSB_RECIPIENT_INTERFACE, LIBUSB_REQUEST_GET_DESCRIPTOR, (LIBUSB_DT_REPORT << 8)|interface_num, 0, data, sizeof(data), 5000);
-									if (res >= 0) {
-										unsigned short page=0, usage=0;
-										/* Parse the usage and usage page
-										   out of the report descriptor. */
-										get_usage(data, res,  &page, &usage);
-										cur_dev->usage_page = page;
-										cur_dev->usage = usage;
-									}
-									else
-										LOG("libusb_control_transfer() for getting the HID report failed with %d\n", res);
-
-									/* Release the interface */
-									res = libusb_release_interface(handle, interface_num);
-									if (res < 0)
-										LOG("Can't release the interface.\n");
+									unsigned short page=0, usage=0;
+									/* Parse the usage and usage page
+									   out of the report descriptor. */
+									get_usage(data, res,  &page, &usage);
+									cur_dev->usage_page = page;
+									cur_dev->usage = usage;
 								}
 								else
-									LOG("Can't claim interface %d\n", res);
+									LOG("libusb_control_transfer() for getting the HID report failed with %d\n", res);
+
+								/* Release the interface */
+								res = libusb_release_interface(handle, interface_num);
+								if (res < 0)
+									LOG("Can't release the interface.\n");
+							}
+							else
+								LOG("Can't claim interface %d\n", res);
 #ifdef DETACH_KERNEL_DRIVER
-								/* Re-attach kernel driver if necessary. */
-								if (detached) {
-									res = libusb_attach_kernel_driver(handle, interface_num);
-									if (res < 0)
-										LOG("Couldn't re-attach kernel driver.\n");
-								}
+							/* Re-attach kernel driver if necessary. */
+							if (detached) {
+								res = libusb_attach_kernel_driver(handle, interface_num);
+								if (res < 0)
+									LOG("Couldn't re-attach kernel driver.\n");
+							}
 #endif
 
 #endif // INVASIVE_GET_USAGE
 
-								libusb_close(handle);
-							}
-							/* VID/PID */
-							cur_dev->vendor_id = dev_vid;
-							cur_dev->product_id = dev_pid;
-
-							/* Release Number */
-							cur_dev->release_number = desc.bcdDevice;
-							
-							/* Interface Number */
-							cur_dev->interface_number = interface_num;
+							libusb_close(handle);
 						}
+						/* VID/PID */
+						cur_dev->vendor_id = dev_vid;
+						cur_dev->product_id = dev_pid;
+
+						/* Release Number */
+						cur_dev->release_number = desc.bcdDevice;
+						
+						/* Interface Number */
+						cur_dev->interface_number = interface_num;
 					}
-				} /* altsettings */
-			} /* interfaces */
-			libusb_free_config_descriptor(conf_desc);
+				}
+			} /* altsettings */
+		} /* interfaces */
+		libusb_free_config_descriptor(conf_desc);
+	}
+
+	return root;
+}
+
+struct hid_device_info  HID_API_EXPORT *hid_enumerate(unsigned short vendor_id, unsigned short product_id)
+{
+	libusb_device **devs;
+	libusb_device *dev;
+	ssize_t num_devs;
+	int i = 0;
+	
+	struct hid_device_info *root = NULL; // return object
+	struct hid_device_info *cur_dev = NULL;
+	int count = 0;
+	
+	hid_init();
+	HID_PROBE2(enumerate_entry, vendor_id, product_id);
+
+	num_devs = libusb_get_device_list(usb_context, &devs);
+	if (num_devs < 0)
+		return NULL;
+	while ((dev = devs[i++]) != NULL) {
+		struct hid_device_info *tmp = create_device_infos(dev, vendor_id, product_id);
+		if (!tmp)
+			continue;
+		if (cur_dev) {
+			cur_dev->next = tmp;
+		}
+		else {
+			root = tmp;
+		}
+		cur_dev = tmp;
+		count++;
+		while (cur_dev->next) {
+			cur_dev = cur_dev->next;
+			count++;
 		}
 	}
 
 	libusb_free_device_list(devs, 1);
 
+	HID_PROBE3(enumerate_return, vendor_id, product_id, count);
 	return root;
 }
 
@@ -643,177 +921,400 @@ hid_device * hid_open(unsigned short vendor_id, unsigned short product_id, const
 	return handle;
 }
 
-static void read_callback(struct libusb_transfer *transfer)
+static unsigned long long monotonic_ns(void)
 {
-	hid_device *dev = transfer->user_data;
-	int res;
-	
-	if (transfer->status == LIBUSB_TRANSFER_COMPLETED) {
-
-		struct input_report *rpt = malloc(sizeof(*rpt));
-		rpt->data = malloc(transfer->actual_length);
-		memcpy(rpt->data, transfer->buffer, transfer->actual_length);
-		rpt->len = transfer->actual_length;
-		rpt->next = NULL;
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
 
-		pthread_mutex_lock(&dev->mutex);
+/* Add a report to the input ring, applying the overflow policy if the
+   ring is full. This should be called with dev->mutex locked. */
+static void queue_report(hid_device *dev, const uint8_t *data, size_t len, unsigned long long sequence, unsigned long long timestamp)
+{
+	struct input_report *rpt;
+	int i;
 
-		/* Attach the new report object to the end of the list. */
-		if (dev->input_reports == NULL) {
-			/* The list is empty. Put it at the root. */
-			dev->input_reports = rpt;
-			pthread_cond_signal(&dev->condition);
-		}
-		else {
-			/* Find the end of the list and attach. */
-			struct input_report *cur = dev->input_reports;
-			int num_queued = 0;
-			while (cur->next != NULL) {
-				cur = cur->next;
-				num_queued++;
+	if (dev->input_policy == HID_QUEUE_KEEP_LATEST && len > 0) {
+		/* Overwrite a queued report with the same Report ID. All the
+		   reports of a device without Report IDs have the same one. */
+		for (i = 0; i < dev->input_count; i++) {
+			rpt = &dev->input_reports[(dev->input_head + i) % dev->input_size];
+			if (!dev->uses_numbered_reports ||
+			    (rpt->len > 0 && rpt->data[0] == data[0])) {
+				memcpy(rpt->data, data, len);
+				rpt->len = len;
+				rpt->timestamp = timestamp;
+				rpt->sequence = sequence;
+				count_dropped(dev);
+				return;
 			}
-			cur->next = rpt;
-			
-			/* Pop one off if we've reached 30 in the queue. This
-			   way we don't grow forever if the user never reads
-			   anything from the device. */
-			if (num_queued > 30) {
-				return_data(dev, NULL, 0);
-			}			
 		}
-		pthread_mutex_unlock(&dev->mutex);
+	}
+
+	if (dev->input_count == dev->input_size &&
+	    dev->input_policy == HID_QUEUE_GROW &&
+	    dev->input_size < dev->input_capacity) {
+		int size = dev->input_size * 2;
+		if (size > dev->input_capacity)
+			size = dev->input_capacity;
+		/* On failure, fall through and drop the oldest report. */
+		resize_input_queue(dev, size);
+	}
+
+	if (dev->input_count == dev->input_size) {
+		count_dropped(dev);
+		if (dev->input_policy == HID_QUEUE_DROP_NEWEST)
+			return;
+
+		/* Drop the oldest report. This way we don't grow forever
+		   if the user never reads anything from the device. */
+		dev->input_head = (dev->input_head + 1) % dev->input_size;
+		dev->input_count--;
+	}
+
+	/* Copy the report into the slot after the newest one. */
+	rpt = &dev->input_reports[(dev->input_head + dev->input_count) % dev->input_size];
+	memcpy(rpt->data, data, len);
+	rpt->len = len;
+	rpt->timestamp = timestamp;
+	rpt->sequence = sequence;
+	dev->input_count++;
+	stat_max(&dev->stats.queue_high_water, dev->input_count);
+	HID_PROBE4(report_enqueue, dev, len, sequence, dev->input_count);
+
+	/* The ring was empty. Wake a waiting reader. */
+	if (dev->input_count == 1) {
+		pthread_cond_signal(&dev->condition);
+		update_poll_fd(dev);
+	}
+}
+
+/* Queue the data from a completed transfer and resubmit it. This
+   should be called with dev->mutex locked. */
+static void handle_transfer(hid_device *dev, int i)
+{
+	struct libusb_transfer *transfer = dev->transfers[i];
+	int res;
+
+	if (transfer->status == LIBUSB_TRANSFER_COMPLETED) {
+		unsigned long long sequence = dev->next_sequence++;
+		STAT_ADD(dev, reports_received, 1);
+		STAT_ADD(dev, bytes_in, transfer->actual_length);
+		if (!dev->shared_ring)
+			queue_report(dev, transfer->buffer, transfer->actual_length, sequence, dev->transfer_time[i]);
+		else if (ring_push(dev->shared_ring, transfer->buffer, transfer->actual_length, sequence, dev->transfer_time[i]) < 0)
+			count_dropped(dev);
 	}
 	else if (transfer->status == LIBUSB_TRANSFER_CANCELLED) {
-		dev->shutdown_thread = 1;
-		return;
+		if (!dev->cancelling) {
+			STAT_ADD(dev, transfer_errors, 1);
+			dev->shutdown_input = 1;
+		}
 	}
 	else if (transfer->status == LIBUSB_TRANSFER_NO_DEVICE) {
-		dev->shutdown_thread = 1;
-		return;
+		STAT_ADD(dev, transfer_errors, 1);
+		dev->shutdown_input = 1;
 	}
 	else if (transfer->status == LIBUSB_TRANSFER_TIMED_OUT) {
 		//LOG("Timeout (normal)\n");
 	}
 	else {
 		LOG("Unknown transfer code: %d\n", transfer->status);
+		STAT_ADD(dev, transfer_errors, 1);
 	}
 	
-	/* Re-submit the transfer object. */
-	res = libusb_submit_transfer(transfer);
-	if (res != 0) {
+	/* Re-submit the transfer object, unless hid_close() or
+	   hid_set_input_transfers() is waiting for it. */
+	if (!dev->shutdown_input && !dev->cancelling) {
+		res = libusb_submit_transfer(transfer);
+		if (res == 0) {
+			dev->transfer_state[i] = TRANSFER_SUBMITTED;
+			return;
+		}
 		LOG("Unable to submit URB. libusb error code: %d\n", res);
-		dev->shutdown_thread = 1;
+		STAT_ADD(dev, transfer_errors, 1);
+		dev->shutdown_input = 1;
 	}
-}
 
+	dev->transfer_state[i] = TRANSFER_IDLE;
+	dev->transfers_pending--;
+}
 
-static void *read_thread(void *param)
+static void read_callback(struct libusb_transfer *transfer)
 {
-	hid_device *dev = param;
-	unsigned char *buf;
-	const size_t length = dev->input_ep_max_packet_size;
+	hid_device *dev = transfer->user_data;
+	unsigned long long now = monotonic_ns();
+	int i, n;
 
-	/* Set up the transfer object. */
-	buf = malloc(length);
-	dev->transfer = libusb_alloc_transfer(0);
-	libusb_fill_interrupt_transfer(dev->transfer,
-		dev->device_handle,
-		dev->input_endpoint,
-		buf,
-		length,
-		read_callback,
-		dev,
-		5000/*timeout*/);
+	if (transfer->status == LIBUSB_TRANSFER_COMPLETED)
+		HID_PROBE2(report_arrive, dev, transfer->actual_length);
 	
-	/* Make the first submission. Further submissions are made
-	   from inside read_callback() */
-	libusb_submit_transfer(dev->transfer);
+	pthread_mutex_lock(&dev->mutex);
+
+	/* Transfers on an endpoint complete in the order they were
+	   submitted, but don't rely on it: only handle this one once
+	   every transfer submitted before it has been handled. */
+	for (i = 0; dev->transfers[i] != transfer; i++)
+		;
+	dev->transfer_state[i] = TRANSFER_COMPLETED;
+	dev->transfer_time[i] = now;
+
+	for (n = 0; n < dev->num_transfers; n++) {
+		i = dev->next_transfer;
+		if (dev->transfer_state[i] == TRANSFER_SUBMITTED)
+			break;
+		if (dev->transfer_state[i] == TRANSFER_COMPLETED)
+			handle_transfer(dev, i);
+		dev->next_transfer = (i + 1) % dev->num_transfers;
+	}
+
+	if (dev->shutdown_input || dev->transfers_pending == 0) {
+		/* Wake hid_close() or hid_set_input_transfers() and any
+		   threads which are waiting on data (in hid_read_timeout()). */
+		pthread_cond_broadcast(&dev->condition);
+		update_poll_fd(dev);
+		if (dev->shutdown_input && dev->shared_ring)
+			ring_fail(dev->shared_ring);
+	}
+
+	pthread_mutex_unlock(&dev->mutex);
+}
+
+
+static void *event_loop(void *param)
+{
+	/* libusb wakes us when a transfer completes. The timeout only
+	   bounds how long event_thread_release() can wait for us to
+	   notice event_stop on versions of libusb which can't interrupt
+	   the event handler. */
+	struct timeval tv = { 1, 0 };
 
-	// Notify the main thread that the read thread is up and running.
-	pthread_barrier_wait(&dev->barrier);
-	
 	/* Handle all the events. */
-	while (!dev->shutdown_thread) {
+	while (!event_stop) {
 		int res;
-		res = libusb_handle_events(usb_context);
-		if (res < 0) {
-			/* There was an error. */
-			LOG("read_thread(): libusb reports error # %d\n", res);
-
-			/* Break out of this loop only on fatal error.*/
-			if (res != LIBUSB_ERROR_BUSY &&
-			    res != LIBUSB_ERROR_TIMEOUT &&
-			    res != LIBUSB_ERROR_OVERFLOW &&
-			    res != LIBUSB_ERROR_INTERRUPTED) {
-				break;
-			}
+		res = libusb_handle_events_timeout_completed(usb_context, &tv, &event_stop);
+		if (res < 0 &&
+		    res != LIBUSB_ERROR_BUSY &&
+		    res != LIBUSB_ERROR_TIMEOUT &&
+		    res != LIBUSB_ERROR_OVERFLOW &&
+		    res != LIBUSB_ERROR_INTERRUPTED) {
+			/* There was an error. Devices are shut down
+			   through their transfers, so carry on. */
+			LOG("event_loop(): libusb reports error # %d\n", res);
 		}
 	}
 	
-	/* Cancel any transfer that may be pending. This call will fail
-	   if no transfers are pending, but that's OK. */
-	if (libusb_cancel_transfer(dev->transfer) == 0) {
-		/* The transfer was cancelled, so wait for its completion. */
-		libusb_handle_events(usb_context);
+	return NULL;
+}
+
+/* Take a reference on the shared event thread, starting it if this is
+   the first user. Returns 0 on success and -1 on error. */
+static int event_thread_acquire(void)
+{
+	int res = 0;
+
+	pthread_mutex_lock(&event_mutex);
+	if (event_refs == 0) {
+		event_stop = 0;
+		res = pthread_create(&event_thread, NULL, event_loop, NULL);
 	}
-	
-	/* Now that the read thread is stopping, Wake any threads which are
-	   waiting on data (in hid_read_timeout()). Do this under a mutex to
-	   make sure that a thread which is about to go to sleep waiting on
-	   the condition acutally will go to sleep before the condition is
-	   signaled. */
-	pthread_mutex_lock(&dev->mutex);
-	pthread_cond_broadcast(&dev->condition);
-	pthread_mutex_unlock(&dev->mutex);
+	if (res == 0)
+		event_refs++;
+	pthread_mutex_unlock(&event_mutex);
 
-	/* The dev->transfer->buffer and dev->transfer objects are cleaned up
-	   in hid_close(). They are not cleaned up here because this thread
-	   could end either due to a disconnect or due to a user
-	   call to hid_close(). In both cases the objects can be safely
-	   cleaned up after the call to pthread_join() (in hid_close()), but
-	   since hid_close() calls libusb_cancel_transfer(), on these objects,
-	   they can not be cleaned up here. */
-	
-	return NULL;
+	return (res == 0)? 0: -1;
 }
 
+/* Drop a reference on the shared event thread, stopping it if this
+   was the last user. */
+static void event_thread_release(void)
+{
+	pthread_mutex_lock(&event_mutex);
+	if (--event_refs == 0) {
+		event_stop = 1;
+#if defined(LIBUSB_API_VERSION) && LIBUSB_API_VERSION >= 0x01000105
+		libusb_interrupt_event_handler(usb_context);
+#endif
+		pthread_join(event_thread, NULL);
+	}
+	pthread_mutex_unlock(&event_mutex);
+}
 
-hid_device * HID_API_EXPORT hid_open_path(const char *path)
+/* Allocate dev->num_transfers input transfers, each with its own
+   buffer. Returns 0 on success and -1 on error. */
+static int alloc_transfers(hid_device *dev)
 {
-	hid_device *dev = NULL;
+	const size_t length = dev->input_ep_max_packet_size;
+	int i;
 
-	dev = new_hid_device();
+	dev->transfer_buffer = malloc(dev->num_transfers * length);
+	if (!dev->transfer_buffer)
+		return -1;
 
-	libusb_device **devs;
-	libusb_device *usb_dev;
-	ssize_t num_devs;
-	int res;
-	int d = 0;
-	int good_open = 0;
-	
-	hid_init();
+	for (i = 0; i < dev->num_transfers; i++) {
+		dev->transfers[i] = libusb_alloc_transfer(0);
+		if (!dev->transfers[i])
+			return -1;
+		libusb_fill_interrupt_transfer(dev->transfers[i],
+			dev->device_handle,
+			dev->input_endpoint,
+			dev->transfer_buffer + i * length,
+			length,
+			read_callback,
+			dev,
+			5000/*timeout*/);
+		dev->transfer_state[i] = TRANSFER_IDLE;
+	}
 
-	num_devs = libusb_get_device_list(usb_context, &devs);
-	while ((usb_dev = devs[d++]) != NULL) {
-		struct libusb_device_descriptor desc;
-		struct libusb_config_descriptor *conf_desc = NULL;
-		int i,j,k;
-		libusb_get_device_descriptor(usb_dev, &desc);
+	return 0;
+}
 
-		if (libusb_get_active_config_descriptor(usb_dev, &conf_desc) < 0)
-			continue;
-		for (j = 0; j < conf_desc->bNumInterfaces; j++) {
-			const struct libusb_interface *intf = &conf_desc->interface[j];
-			for (k = 0; k < intf->num_altsetting; k++) {
-				const struct libusb_interface_descriptor *intf_desc;
-				intf_desc = &intf->altsetting[k];
-				if (intf_desc->bInterfaceClass == LIBUSB_CLASS_HID) {
-					char *dev_path = make_path(usb_dev, intf_desc->bInterfaceNumber);
-					if (!strcmp(dev_path, path)) {
-						/* Matched Paths. Open this device */
+static void free_transfers(hid_device *dev)
+{
+	int i;
 
-						// OPEN HERE //
-						res = libusb_open(usb_dev, &dev->device_handle);
+	for (i = 0; i < HID_MAX_INPUT_TRANSFERS; i++) {
+		libusb_free_transfer(dev->transfers[i]);
+		dev->transfers[i] = NULL;
+	}
+	free(dev->transfer_buffer);
+	dev->transfer_buffer = NULL;
+}
+
+/* Submit all the input transfers. Further submissions are made from
+   inside read_callback(). Returns 0 on success and -1 on error, in which
+   case the transfers already submitted are left in flight.
+   This should be called with dev->mutex locked. */
+static int submit_transfers(hid_device *dev)
+{
+	int i;
+
+	dev->next_transfer = 0;
+	for (i = 0; i < dev->num_transfers; i++) {
+		if (libusb_submit_transfer(dev->transfers[i]) < 0) {
+			LOG("can't submit an input transfer\n");
+			return -1;
+		}
+		dev->transfer_state[i] = TRANSFER_SUBMITTED;
+		dev->transfers_pending++;
+	}
+
+	return 0;
+}
+
+/* Cancel the input transfers and wait for the event thread to give
+   them all back. This should be called with dev->mutex locked. */
+static void cancel_transfers(hid_device *dev)
+{
+	int i;
+
+	dev->cancelling = 1;
+	for (i = 0; i < dev->num_transfers; i++) {
+		/* This call will fail if the transfer has already
+		   completed, in which case read_callback() won't
+		   resubmit it. */
+		if (dev->transfer_state[i] == TRANSFER_SUBMITTED)
+			libusb_cancel_transfer(dev->transfers[i]);
+	}
+	while (dev->transfers_pending > 0)
+		pthread_cond_wait(&dev->condition, &dev->mutex);
+	dev->cancelling = 0;
+}
+
+/* Set up the input transfers and start reading. Returns 0 on success
+   and -1 on error. */
+static int start_input(hid_device *dev)
+{
+	int res;
+
+	if (resize_input_queue(dev, dev->input_capacity) < 0) {
+		LOG("can't allocate input report queue\n");
+		return -1;
+	}
+
+	if (alloc_transfers(dev) < 0) {
+		free_transfers(dev);
+		return -1;
+	}
+
+	if (event_thread_acquire() < 0) {
+		LOG("can't start the event thread\n");
+		free_transfers(dev);
+		return -1;
+	}
+
+	pthread_mutex_lock(&dev->mutex);
+	res = submit_transfers(dev);
+	if (res < 0)
+		cancel_transfers(dev);
+	pthread_mutex_unlock(&dev->mutex);
+
+	if (res < 0) {
+		event_thread_release();
+		free_transfers(dev);
+	}
+
+	return res;
+}
+
+/* Cancel the input transfers and wait for the event thread to give
+   them back, then free them. */
+static void stop_input(hid_device *dev)
+{
+	pthread_mutex_lock(&dev->mutex);
+	dev->shutdown_input = 1;
+	cancel_transfers(dev);
+	pthread_mutex_unlock(&dev->mutex);
+
+	event_thread_release();
+
+	free_transfers(dev);
+}
+
+
+hid_device * HID_API_EXPORT hid_open_path(const char *path)
+{
+	hid_device *dev = NULL;
+
+	dev = new_hid_device();
+
+	libusb_device **devs;
+	libusb_device *usb_dev;
+	ssize_t num_devs;
+	int res;
+	int d = 0;
+	int good_open = 0;
+	unsigned char rpt_desc[4096]; /* HID_MAX_DESCRIPTOR_SIZE */
+	
+	hid_init();
+
+	num_devs = libusb_get_device_list(usb_context, &devs);
+	if (num_devs < 0) {
+		free_hid_device(dev);
+		HID_PROBE2(device_open, NULL, path);
+		return NULL;
+	}
+	while ((usb_dev = devs[d++]) != NULL) {
+		struct libusb_device_descriptor desc;
+		struct libusb_config_descriptor *conf_desc = NULL;
+		int i,j,k;
+		libusb_get_device_descriptor(usb_dev, &desc);
+
+		if (libusb_get_active_config_descriptor(usb_dev, &conf_desc) < 0)
+			continue;
+		for (j = 0; j < conf_desc->bNumInterfaces; j++) {
+			const struct libusb_interface *intf = &conf_desc->interface[j];
+			for (k = 0; k < intf->num_altsetting; k++) {
+				const struct libusb_interface_descriptor *intf_desc;
+				intf_desc = &intf->altsetting[k];
+				if (intf_desc->bInterfaceClass == LIBUSB_CLASS_HID) {
+					char *dev_path = make_path(usb_dev, intf_desc->bInterfaceNumber);
+					if (!strcmp(dev_path, path)) {
+						/* Matched Paths. Open this device */
+
+						// OPEN HERE //
+						res = libusb_open(usb_dev, &dev->device_handle);
 						if (res < 0) {
 							LOG("can't open device\n");
 							free(dev_path);
@@ -850,6 +1351,15 @@ hid_device * HID_API_EXPORT hid_open_path(const char *path)
 
 						/* Store off the interface number */
 						dev->interface = intf_desc->bInterfaceNumber;
+
+						/* Determine if this device uses numbered
+						   reports. If the report descriptor can't be
+						   read, assume it doesn't, as hid.c does. */
+						res = libusb_control_transfer(dev->device_handle, LIBUSB_ENDPOINT_IN|LIBUSB_RECIPIENT_INTERFACE, LIBUSB_REQUEST_GET_DESCRIPTOR, (LIBUSB_DT_REPORT << 8)|dev->interface, 0, rpt_desc, sizeof(rpt_desc), 5000);
+						if (res >= 0)
+							dev->uses_numbered_reports = uses_numbered_reports(rpt_desc, res);
+						else
+							LOG("libusb_control_transfer() for getting the HID report failed with %d\n", res);
 												
 						/* Find the INPUT and OUTPUT endpoints. An
 						   OUTPUT endpoint is not required. */
@@ -883,10 +1393,13 @@ hid_device * HID_API_EXPORT hid_open_path(const char *path)
 							}
 						}
 						
-						pthread_create(&dev->thread, NULL, read_thread, dev);
-						
-						// Wait here for the read thread to be initialized.
-						pthread_barrier_wait(&dev->barrier);
+						if (start_input(dev) < 0) {
+							free(dev_path);
+							libusb_release_interface(dev->device_handle, dev->interface);
+							libusb_close(dev->device_handle);
+							good_open = 0;
+							break;
+						}
 						
 					}
 					free(dev_path);
@@ -901,17 +1414,19 @@ hid_device * HID_API_EXPORT hid_open_path(const char *path)
 	
 	// If we have a good handle, return it.
 	if (good_open) {
+		HID_PROBE2(device_open, dev, path);
 		return dev;
 	}
 	else {
 		// Unable to open any devices.
 		free_hid_device(dev);
+		HID_PROBE2(device_open, NULL, path);
 		return NULL;
 	}
 }
 
 
-int HID_API_EXPORT hid_write(hid_device *dev, const unsigned char *data, size_t length)
+static int write_report(hid_device *dev, const unsigned char *data, size_t length)
 {
 	int res;
 	int report_number = data[0];
@@ -961,22 +1476,87 @@ int HID_API_EXPORT hid_write(hid_device *dev, const unsigned char *data, size_t
 	}
 }
 
+int HID_API_EXPORT hid_write(hid_device *dev, const unsigned char *data, size_t length)
+{
+	unsigned long long start, elapsed;
+	int res;
+
+	HID_PROBE3(write_entry, dev, data[0], length);
+	start = monotonic_ns();
+	res = write_report(dev, data, length);
+	elapsed = monotonic_ns() - start;
+	HID_PROBE2(write_return, dev, res);
+
+	if (res < 0) {
+		STAT_ADD(dev, transfer_errors, 1);
+	}
+	else {
+		STAT_ADD(dev, writes, 1);
+		STAT_ADD(dev, bytes_out, res);
+		STAT_ADD(dev, write_time_total, elapsed);
+		stat_max(&dev->stats.write_time_max, elapsed);
+		record_latency(dev, HID_LATENCY_WRITE, elapsed);
+	}
+
+	return res;
+}
+
 /* Helper function, to simplify hid_read().
    This should be called with dev->mutex locked. */
 static int return_data(hid_device *dev, unsigned char *data, size_t length)
 {
-	/* Copy the data out of the linked list item (rpt) into the
-	   return buffer (data), and delete the liked list item. */
-	struct input_report *rpt = dev->input_reports;
+	/* Copy the data out of the oldest slot (rpt) into the
+	   return buffer (data), and release the slot. */
+	struct input_report *rpt = &dev->input_reports[dev->input_head];
 	size_t len = (length < rpt->len)? length: rpt->len;
 	if (len > 0)
 		memcpy(data, rpt->data, len);
-	dev->input_reports = rpt->next;
-	free(rpt->data);
-	free(rpt);
+	/* Otherwise the report is being dropped or moved. */
+	if (data) {
+		unsigned long long latency = monotonic_ns() - rpt->timestamp;
+		record_latency(dev, HID_LATENCY_INPUT, latency);
+		HID_PROBE3(report_dequeue, dev, len, latency);
+	}
+	dev->input_head = (dev->input_head + 1) % dev->input_size;
+	dev->input_count--;
+	if (dev->input_count == 0)
+		update_poll_fd(dev);
 	return len;
 }
 
+/* Make dev->poll_fd readable exactly when a read wouldn't block. This
+   should be called with dev->mutex locked. */
+static void update_poll_fd(hid_device *dev)
+{
+	int readable = dev->input_count > 0 || dev->shutdown_input;
+	eventfd_t value;
+
+	if (dev->poll_fd < 0 || readable == dev->poll_signalled)
+		return;
+	if (readable)
+		eventfd_write(dev->poll_fd, 1);
+	else
+		eventfd_read(dev->poll_fd, &value);
+	dev->poll_signalled = readable;
+}
+
+/* Return dev->poll_fd, creating it if needed. Returns -1 on error. */
+static int get_poll_fd(hid_device *dev)
+{
+	int fd;
+
+	pthread_mutex_lock(&dev->mutex);
+	if (dev->poll_fd < 0) {
+		dev->poll_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+		dev->poll_signalled = 0;
+		update_poll_fd(dev);
+	}
+	fd = dev->poll_fd;
+	pthread_mutex_unlock(&dev->mutex);
+
+	return fd;
+}
+
 static void cleanup_mutex(void *param)
 {
 	hid_device *dev = param;
@@ -984,41 +1564,31 @@ static void cleanup_mutex(void *param)
 }
 
 
-int HID_API_EXPORT hid_read_timeout(hid_device *dev, unsigned char *data, size_t length, int milliseconds)
+/* Helper function for hid_read_timeout() and hid_read_many(). Waits
+   for an input report to be queued. Returns 1 if a report is available,
+   0 on timeout and -1 on error or disconnection.
+   This should be called with dev->mutex locked. */
+static int wait_for_report(hid_device *dev, int milliseconds)
 {
-	int bytes_read = -1;
-
-#if 0
-	int transferred;
-	int res = libusb_interrupt_transfer(dev->device_handle, dev->input_endpoint, data, length, &transferred, 5000);
-	LOG("transferred: %d\n", transferred);
-	return transferred;
-#endif
-
-	pthread_mutex_lock(&dev->mutex);
-	pthread_cleanup_push(&cleanup_mutex, dev);
+	/* Reports go to the application's ring instead. */
+	if (dev->shared_ring)
+		return -1;
 
-	/* There's an input report queued up. Return it. */
-	if (dev->input_reports) {
-		/* Return the first one */
-		bytes_read = return_data(dev, data, length);
-		goto ret;
-	}
+	/* There's an input report queued up. */
+	if (dev->input_count > 0)
+		return 1;
 	
-	if (dev->shutdown_thread) {
+	if (dev->shutdown_input) {
 		/* This means the device has been disconnected.
 		   An error code of -1 should be returned. */
-		bytes_read = -1;
-		goto ret;
+		return -1;
 	}
 	
 	if (milliseconds == -1) {
 		/* Blocking */
-		while (!dev->input_reports && !dev->shutdown_thread) {
+		while (dev->input_count == 0 && !dev->shutdown_input) {
 			pthread_cond_wait(&dev->condition, &dev->mutex);
-		}
-		if (dev->input_reports) {
-			bytes_read = return_data(dev, data, length);
+			STAT_ADD(dev, read_wakeups, 1);
 		}
 	}
 	else if (milliseconds > 0) {
@@ -1033,47 +1603,518 @@ int HID_API_EXPORT hid_read_timeout(hid_device *dev, unsigned char *data, size_t
 			ts.tv_nsec -= 1000000000L;
 		}
 		
-		while (!dev->input_reports && !dev->shutdown_thread) {
+		while (dev->input_count == 0 && !dev->shutdown_input) {
 			res = pthread_cond_timedwait(&dev->condition, &dev->mutex, &ts);
-			if (res == 0) {
-				if (dev->input_reports) {
-					bytes_read = return_data(dev, data, length);
-					break;
-				}
-				
-				/* If we're here, there was a spurious wake up
-				   or the read thread was shutdown. Run the
-				   loop again (ie: don't break). */
-			}
-			else if (res == ETIMEDOUT) {
+			if (res == ETIMEDOUT) {
 				/* Timed out. */
-				bytes_read = 0;
-				break;
+				STAT_ADD(dev, read_timeouts, 1);
+				return 0;
 			}
-			else {
+			else if (res != 0) {
 				/* Error. */
-				bytes_read = -1;
-				break;
+				return -1;
 			}
+			STAT_ADD(dev, read_wakeups, 1);
+			
+			/* If we're here, there was a spurious wake up
+			   or the input was shut down. Run the
+			   loop again (ie: don't break). */
 		}
 	}
 	else {
 		/* Purely non-blocking */
-		bytes_read = 0;
+		return 0;
+	}
+
+	return (dev->input_count > 0)? 1: -1;
+}
+
+int HID_API_EXPORT hid_read_timeout(hid_device *dev, unsigned char *data, size_t length, int milliseconds)
+{
+	int bytes_read = -1;
+
+#if 0
+	int transferred;
+	int res = libusb_interrupt_transfer(dev->device_handle, dev->input_endpoint, data, length, &transferred, 5000);
+	LOG("transferred: %d\n", transferred);
+	return transferred;
+#endif
+
+	pthread_mutex_lock(&dev->mutex);
+	pthread_cleanup_push(&cleanup_mutex, dev);
+
+	bytes_read = wait_for_report(dev, milliseconds);
+	if (bytes_read > 0) {
+		/* Return the first one */
+		bytes_read = return_data(dev, data, length);
+	}
+
+	pthread_mutex_unlock(&dev->mutex);
+	pthread_cleanup_pop(0);
+
+	return bytes_read;
+}
+
+int HID_API_EXPORT hid_read_timestamped(hid_device *dev, unsigned char *data, size_t length, unsigned long long *timestamp, int milliseconds)
+{
+	return hid_read_sequenced(dev, data, length, NULL, timestamp, milliseconds);
+}
+
+int HID_API_EXPORT hid_read_sequenced(hid_device *dev, unsigned char *data, size_t length, unsigned long long *sequence, unsigned long long *timestamp, int milliseconds)
+{
+	int bytes_read = -1;
+
+	pthread_mutex_lock(&dev->mutex);
+	pthread_cleanup_push(&cleanup_mutex, dev);
+
+	bytes_read = wait_for_report(dev, milliseconds);
+	if (bytes_read > 0) {
+		struct input_report *rpt = &dev->input_reports[dev->input_head];
+		if (sequence)
+			*sequence = rpt->sequence;
+		if (timestamp)
+			*timestamp = rpt->timestamp;
+		bytes_read = return_data(dev, data, length);
 	}
 
-ret:
 	pthread_mutex_unlock(&dev->mutex);
 	pthread_cleanup_pop(0);
 
 	return bytes_read;
 }
 
+int HID_API_EXPORT hid_get_dropped_count(hid_device *dev, unsigned long long *count)
+{
+	*count = __atomic_load_n(&dev->stats.reports_dropped, __ATOMIC_RELAXED);
+	return 0;
+}
+
+int HID_API_EXPORT hid_get_stats(hid_device *dev, struct hid_device_stats *stats)
+{
+	/* Every field is a counter of the same type. */
+	const unsigned long long *src = (const unsigned long long*) &dev->stats;
+	unsigned long long *dst = (unsigned long long*) stats;
+	size_t i;
+
+	for (i = 0; i < sizeof(*stats) / sizeof(*dst); i++)
+		dst[i] = __atomic_load_n(&src[i], __ATOMIC_RELAXED);
+
+	return 0;
+}
+
+int HID_API_EXPORT hid_get_latency_histogram(hid_device *dev, int kind, struct hid_histogram *histogram, int reset)
+{
+	struct hid_histogram *h;
+	int i;
+
+	if (kind < HID_LATENCY_INPUT || kind > HID_LATENCY_FEATURE)
+		return -1;
+	h = &dev->latency[kind];
+
+	histogram->count = 0;
+	for (i = 0; i < HID_HISTOGRAM_BUCKETS; i++) {
+		histogram->counts[i] = reset
+			? __atomic_exchange_n(&h->counts[i], 0, __ATOMIC_RELAXED)
+			: __atomic_load_n(&h->counts[i], __ATOMIC_RELAXED);
+		histogram->count += histogram->counts[i];
+	}
+	histogram->total = reset
+		? __atomic_exchange_n(&h->total, 0, __ATOMIC_RELAXED)
+		: __atomic_load_n(&h->total, __ATOMIC_RELAXED);
+	histogram->max = reset
+		? __atomic_exchange_n(&h->max, 0, __ATOMIC_RELAXED)
+		: __atomic_load_n(&h->max, __ATOMIC_RELAXED);
+
+	return 0;
+}
+
+/* Takes everything already queued, each report after its length as two
+   bytes, and returns the number taken. The first report is always taken,
+   truncated if it has to be, the rest only while they fit whole. Called
+   with dev->mutex held. */
+static int take_reports(hid_device *dev, unsigned char *data, size_t *length, int max_reports)
+{
+	size_t used = 0;
+	int count = 0;
+
+	while (dev->input_count > 0 && count < max_reports) {
+		size_t len = dev->input_reports[dev->input_head].len;
+		if (used + 2 + len > *length) {
+			if (count > 0)
+				break;
+			len = *length - 2;
+		}
+		len = return_data(dev, data + used + 2, len);
+		data[used] = len & 0xff;
+		data[used+1] = (len >> 8) & 0xff;
+		used += 2 + len;
+		count++;
+	}
+
+	*length = used;
+	return count;
+}
+
+int HID_API_EXPORT hid_read_many(hid_device *dev, unsigned char *data, size_t *length, int max_reports, int milliseconds)
+{
+	int res;
+
+	if (*length < 3 || max_reports < 1)
+		return -1;
+
+	/* Nothing but res lives across the cleanup handler's setjmp(), so
+	   no local can be clobbered when the thread is cancelled. */
+	pthread_mutex_lock(&dev->mutex);
+	pthread_cleanup_push(&cleanup_mutex, dev);
+
+	res = wait_for_report(dev, milliseconds);
+	if (res > 0)
+		res = take_reports(dev, data, length, max_reports);
+	else
+		*length = 0;
+
+	pthread_mutex_unlock(&dev->mutex);
+	pthread_cleanup_pop(0);
+
+	return res;
+}
+
 int HID_API_EXPORT hid_read(hid_device *dev, unsigned char *data, size_t length)
 {
 	return hid_read_timeout(dev, data, length, dev->blocking ? -1 : 0);
 }
 
+int HID_API_EXPORT hid_get_poll_fd(hid_device *dev)
+{
+	return get_poll_fd(dev);
+}
+
+struct hid_reactor_ {
+	HID_BACKEND_HEADER
+	int epoll_fd;
+};
+
+hid_reactor * HID_API_EXPORT hid_reactor_create(void)
+{
+	hid_reactor *reactor = calloc(1, sizeof(hid_reactor));
+	if (!reactor)
+		return NULL;
+	HID_BACKEND_INIT(reactor);
+
+	reactor->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	if (reactor->epoll_fd < 0) {
+		free(reactor);
+		return NULL;
+	}
+
+	return reactor;
+}
+
+int HID_API_EXPORT hid_reactor_add(hid_reactor *reactor, hid_device *dev)
+{
+	struct epoll_event ev;
+	int fd = get_poll_fd(dev);
+
+	if (fd < 0)
+		return -1;
+
+	/* Level-triggered, so a device stays ready until it's read. */
+	memset(&ev, 0, sizeof(ev));
+	ev.events = EPOLLIN;
+	ev.data.ptr = dev;
+	return epoll_ctl(reactor->epoll_fd, EPOLL_CTL_ADD, fd, &ev);
+}
+
+int HID_API_EXPORT hid_reactor_remove(hid_reactor *reactor, hid_device *dev)
+{
+	struct epoll_event ev;
+
+	if (dev->poll_fd < 0)
+		return -1;
+
+	/* Kernels before 2.6.9 require a non-NULL event. */
+	memset(&ev, 0, sizeof(ev));
+	return epoll_ctl(reactor->epoll_fd, EPOLL_CTL_DEL, dev->poll_fd, &ev);
+}
+
+int HID_API_EXPORT hid_reactor_wait(hid_reactor *reactor, hid_device **ready, int max_ready, int milliseconds)
+{
+	struct epoll_event events[REACTOR_MAX_EVENTS];
+	int i, res;
+
+	if (max_ready < 1)
+		return -1;
+	if (max_ready > REACTOR_MAX_EVENTS)
+		max_ready = REACTOR_MAX_EVENTS;
+
+	/* Each device's eventfd is readable while it has reports queued
+	   or its input is shut down. */
+	res = epoll_wait(reactor->epoll_fd, events, max_ready, milliseconds);
+	if (res < 0)
+		return (errno == EINTR)? 0: -1;
+
+	for (i = 0; i < res; i++)
+		ready[i] = events[i].data.ptr;
+
+	return res;
+}
+
+void HID_API_EXPORT hid_reactor_destroy(hid_reactor *reactor)
+{
+	if (!reactor)
+		return;
+	close(reactor->epoll_fd);
+	free(reactor);
+}
+
+/* A USB device connected or disconnected, queued by hotplug_callback()
+   on the event thread for hid_hotplug_wait(). */
+struct hotplug_event {
+	libusb_device *dev;
+	libusb_hotplug_event event;
+	struct hotplug_event *next;
+};
+
+struct hid_hotplug_ {
+	HID_BACKEND_HEADER
+	libusb_hotplug_callback_handle handle;
+	unsigned short vendor_id;
+	unsigned short product_id;
+
+	/* mutex protects the queue of events, oldest first. */
+	pthread_mutex_t mutex;
+	pthread_cond_t condition;
+	struct hotplug_event *events;
+	struct hotplug_event **events_tail;
+
+	/* The interfaces of the last USB device taken off the queue
+	   which are still to be reported, and what happened to them. */
+	struct hid_device_info *pending;
+	int pending_event;
+
+	/* The matching interfaces present, as they were when they
+	   arrived, to describe them when they leave. */
+	struct hid_device_info *devices;
+};
+
+static struct hid_device_info *copy_device_info(const struct hid_device_info *info)
+{
+	struct hid_device_info *copy = malloc(sizeof(struct hid_device_info));
+	if (!copy)
+		return NULL;
+
+	*copy = *info;
+	copy->next = NULL;
+	copy->path = info->path? strdup(info->path): NULL;
+	copy->serial_number = info->serial_number? wcsdup(info->serial_number): NULL;
+	copy->manufacturer_string = info->manufacturer_string? wcsdup(info->manufacturer_string): NULL;
+	copy->product_string = info->product_string? wcsdup(info->product_string): NULL;
+
+	return copy;
+}
+
+/* Runs on the event thread, where synchronous transfers (such as
+   reading the strings) aren't allowed, so only queues the device. */
+static int hotplug_callback(libusb_context *ctx, libusb_device *dev, libusb_hotplug_event event, void *user_data)
+{
+	hid_hotplug *hotplug = user_data;
+	struct hotplug_event *e = malloc(sizeof(struct hotplug_event));
+
+	if (e) {
+		e->dev = libusb_ref_device(dev);
+		e->event = event;
+		e->next = NULL;
+
+		pthread_mutex_lock(&hotplug->mutex);
+		*hotplug->events_tail = e;
+		hotplug->events_tail = &e->next;
+		pthread_cond_signal(&hotplug->condition);
+		pthread_mutex_unlock(&hotplug->mutex);
+	}
+
+	/* Stay registered. */
+	return 0;
+}
+
+/* Turn a USB device's event into the HID interfaces to report. */
+static void hotplug_process(hid_hotplug *hotplug, struct hotplug_event *e)
+{
+	struct hid_device_info **link;
+
+	if (e->event == LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED) {
+		struct hid_device_info *info, *next;
+
+		info = create_device_infos(e->dev, hotplug->vendor_id, hotplug->product_id);
+		for (; info; info = next) {
+			struct hid_device_info *copy = NULL;
+
+			next = info->next;
+			info->next = NULL;
+
+			/* One listed when the monitor was created may be
+			   reported by libusb as well. */
+			for (link = &hotplug->devices; *link; link = &(*link)->next) {
+				if ((*link)->path && info->path && strcmp((*link)->path, info->path) == 0)
+					break;
+			}
+			if (!*link)
+				copy = copy_device_info(info);
+			if (copy) {
+				copy->next = hotplug->devices;
+				hotplug->devices = copy;
+				info->next = hotplug->pending;
+				hotplug->pending = info;
+			}
+			else
+				hid_free_enumeration(info);
+		}
+		hotplug->pending_event = HID_HOTPLUG_ARRIVED;
+	}
+	else {
+		/* The device can't be asked for its interfaces anymore, but
+		   their paths start with its bus number and address. */
+		char prefix[16];
+		size_t len;
+
+		snprintf(prefix, sizeof(prefix), "%04x:%04x:",
+			libusb_get_bus_number(e->dev),
+			libusb_get_device_address(e->dev));
+		len = strlen(prefix);
+
+		link = &hotplug->devices;
+		while (*link) {
+			struct hid_device_info *info = *link;
+			if (info->path && strncmp(info->path, prefix, len) == 0) {
+				*link = info->next;
+				info->next = hotplug->pending;
+				hotplug->pending = info;
+			}
+			else
+				link = &info->next;
+		}
+		hotplug->pending_event = HID_HOTPLUG_LEFT;
+	}
+}
+
+hid_hotplug * HID_API_EXPORT hid_hotplug_create(unsigned short vendor_id, unsigned short product_id)
+{
+	hid_hotplug *hotplug;
+	int match_vid = LIBUSB_HOTPLUG_MATCH_ANY;
+	int match_pid = LIBUSB_HOTPLUG_MATCH_ANY;
+
+	if (hid_init() < 0 || !libusb_has_capability(LIBUSB_CAP_HAS_HOTPLUG))
+		return NULL;
+
+	hotplug = calloc(1, sizeof(hid_hotplug));
+	if (!hotplug)
+		return NULL;
+	HID_BACKEND_INIT(hotplug);
+	hotplug->vendor_id = vendor_id;
+	hotplug->product_id = product_id;
+	pthread_mutex_init(&hotplug->mutex, NULL);
+	pthread_cond_init(&hotplug->condition, NULL);
+	hotplug->events_tail = &hotplug->events;
+
+	/* The callback runs on the event thread. */
+	if (event_thread_acquire() < 0)
+		goto err;
+
+	if (vendor_id != 0x0 || product_id != 0x0) {
+		match_vid = vendor_id;
+		match_pid = product_id;
+	}
+	if (libusb_hotplug_register_callback(usb_context,
+	        LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED | LIBUSB_HOTPLUG_EVENT_DEVICE_LEFT,
+	        LIBUSB_HOTPLUG_NO_FLAGS, match_vid, match_pid, LIBUSB_HOTPLUG_MATCH_ANY,
+	        hotplug_callback, hotplug, &hotplug->handle) != LIBUSB_SUCCESS) {
+		event_thread_release();
+		goto err;
+	}
+
+	/* Listed once the callback is registered, so no device is missed
+	   in between. */
+	hotplug->devices = hid_enumerate(vendor_id, product_id);
+
+	return hotplug;
+
+err:
+	pthread_cond_destroy(&hotplug->condition);
+	pthread_mutex_destroy(&hotplug->mutex);
+	free(hotplug);
+	return NULL;
+}
+
+int HID_API_EXPORT hid_hotplug_wait(hid_hotplug *hotplug, struct hid_device_info **device, int milliseconds)
+{
+	struct timespec ts;
+	int res = 0;
+
+	*device = NULL;
+	if (milliseconds > 0) {
+		clock_gettime(CLOCK_REALTIME, &ts);
+		ts.tv_sec += milliseconds / 1000;
+		ts.tv_nsec += (milliseconds % 1000) * 1000000;
+		if (ts.tv_nsec >= 1000000000L) {
+			ts.tv_sec++;
+			ts.tv_nsec -= 1000000000L;
+		}
+	}
+
+	while (!hotplug->pending) {
+		struct hotplug_event *e;
+
+		pthread_mutex_lock(&hotplug->mutex);
+		while (!hotplug->events && milliseconds != 0 && res == 0) {
+			if (milliseconds < 0)
+				res = pthread_cond_wait(&hotplug->condition, &hotplug->mutex);
+			else
+				res = pthread_cond_timedwait(&hotplug->condition, &hotplug->mutex, &ts);
+		}
+		e = hotplug->events;
+		if (e) {
+			hotplug->events = e->next;
+			if (!hotplug->events)
+				hotplug->events_tail = &hotplug->events;
+		}
+		pthread_mutex_unlock(&hotplug->mutex);
+
+		if (!e)
+			return (res == 0 || res == ETIMEDOUT)? 0: -1;
+
+		hotplug_process(hotplug, e);
+		libusb_unref_device(e->dev);
+		free(e);
+	}
+
+	/* One interface at a time. */
+	*device = hotplug->pending;
+	hotplug->pending = (*device)->next;
+	(*device)->next = NULL;
+	return hotplug->pending_event;
+}
+
+void HID_API_EXPORT hid_hotplug_destroy(hid_hotplug *hotplug)
+{
+	if (!hotplug)
+		return;
+
+	/* libusb doesn't call it anymore once this returns. */
+	libusb_hotplug_deregister_callback(usb_context, hotplug->handle);
+	event_thread_release();
+
+	while (hotplug->events) {
+		struct hotplug_event *e = hotplug->events;
+		hotplug->events = e->next;
+		libusb_unref_device(e->dev);
+		free(e);
+	}
+	hid_free_enumeration(hotplug->pending);
+	hid_free_enumeration(hotplug->devices);
+	pthread_cond_destroy(&hotplug->condition);
+	pthread_mutex_destroy(&hotplug->mutex);
+	free(hotplug);
+}
+
 int HID_API_EXPORT hid_set_nonblocking(hid_device *dev, int nonblock)
 {
 	dev->blocking = !nonblock;
@@ -1082,8 +2123,123 @@ int HID_API_EXPORT hid_set_nonblocking(hid_device *dev, int nonblock)
 }
 
 
+int HID_API_EXPORT hid_set_input_queue(hid_device *dev, int capacity, int policy)
+{
+	int res = 0;
+	int size = capacity;
+
+	if (capacity < 1 ||
+	    policy < HID_QUEUE_DROP_OLDEST || policy > HID_QUEUE_GROW)
+		return -1;
+
+	pthread_mutex_lock(&dev->mutex);
+
+	/* A growing ring keeps its current allocation unless that is
+	   already over the new limit. */
+	if (policy == HID_QUEUE_GROW && dev->input_size < capacity)
+		size = dev->input_size;
+	if (size != dev->input_size)
+		res = resize_input_queue(dev, size);
+	if (res == 0) {
+		dev->input_capacity = capacity;
+		dev->input_policy = policy;
+	}
+
+	pthread_mutex_unlock(&dev->mutex);
+
+	return res;
+}
+
+int HID_API_EXPORT hid_set_input_transfers(hid_device *dev, int count)
+{
+	int res = 0;
+
+	if (count < 1 || count > HID_MAX_INPUT_TRANSFERS)
+		return -1;
+
+	pthread_mutex_lock(&dev->mutex);
+
+	if (dev->shutdown_input) {
+		/* The device is gone. */
+		res = -1;
+	}
+	else if (count != dev->num_transfers) {
+		/* Take the transfers back from libusb and start again
+		   with the new number. */
+		cancel_transfers(dev);
+		free_transfers(dev);
+		dev->num_transfers = count;
+		res = alloc_transfers(dev);
+		if (res == 0)
+			res = submit_transfers(dev);
+		if (res < 0) {
+			/* Reads will fail from now on. */
+			dev->shutdown_input = 1;
+			cancel_transfers(dev);
+			pthread_cond_broadcast(&dev->condition);
+			update_poll_fd(dev);
+			if (dev->shared_ring)
+				ring_fail(dev->shared_ring);
+		}
+	}
+
+	pthread_mutex_unlock(&dev->mutex);
+
+	return res;
+}
+
+int HID_API_EXPORT hid_set_input_ring(hid_device *dev, struct hid_input_ring *ring, size_t size)
+{
+	size_t capacity = 0;
+
+	if (ring && (capacity = ring_capacity(ring, size)) == 0)
+		return -1;
+
+	pthread_mutex_lock(&dev->mutex);
+
+	if (dev->shared_ring)
+		ring_fail(dev->shared_ring);
+	dev->shared_ring = ring;
+
+	if (ring) {
+		/* The reports already queued go first. */
+		ring_init(ring, capacity);
+		while (dev->input_count > 0) {
+			struct input_report *rpt = &dev->input_reports[dev->input_head];
+			if (ring_push(ring, rpt->data, rpt->len, rpt->sequence, rpt->timestamp) < 0)
+				count_dropped(dev);
+			return_data(dev, NULL, 0);
+		}
+		if (dev->shutdown_input)
+			ring_fail(ring);
+	}
+
+	pthread_mutex_unlock(&dev->mutex);
+
+	return 0;
+}
+
+int HID_API_EXPORT hid_input_ring_wait(hid_device *dev, int milliseconds)
+{
+	struct hid_input_ring *ring = dev->shared_ring;
+
+	if (!ring)
+		return -1;
+	return ring_wait(ring, milliseconds);
+}
+
+int HID_API_EXPORT hid_input_ring_read(hid_device *dev, unsigned char *data, size_t length, unsigned long long *timestamp, int milliseconds)
+{
+	struct hid_input_ring *ring = dev->shared_ring;
+
+	if (!ring)
+		return -1;
+	return ring_read(ring, data, length, timestamp, milliseconds);
+}
+
 int HID_API_EXPORT hid_send_feature_report(hid_device *dev, const unsigned char *data, size_t length)
 {
+	unsigned long long start;
 	int res = -1;
 	int skipped_report_id = 0;
 	int report_number = data[0];
@@ -1094,6 +2250,8 @@ int HID_API_EXPORT hid_send_feature_report(hid_device *dev, const unsigned char
 		skipped_report_id = 1;
 	}
 
+	HID_PROBE3(send_feature_entry, dev, report_number, length);
+	start = monotonic_ns();
 	res = libusb_control_transfer(dev->device_handle,
 		LIBUSB_REQUEST_TYPE_CLASS|LIBUSB_RECIPIENT_INTERFACE|LIBUSB_ENDPOINT_OUT,
 		0x09/*HID set_report*/,
@@ -1101,9 +2259,11 @@ int HID_API_EXPORT hid_send_feature_report(hid_device *dev, const unsigned char
 		dev->interface,
 		(unsigned char *)data, length,
 		1000/*timeout millis*/);
+	HID_PROBE2(send_feature_return, dev, res);
 	
 	if (res < 0)
 		return -1;
+	record_latency(dev, HID_LATENCY_FEATURE, monotonic_ns() - start);
 	
 	/* Account for the report ID */
 	if (skipped_report_id)
@@ -1114,6 +2274,7 @@ int HID_API_EXPORT hid_send_feature_report(hid_device *dev, const unsigned char
 
 int HID_API_EXPORT hid_get_feature_report(hid_device *dev, unsigned char *data, size_t length)
 {
+	unsigned long long start;
 	int res = -1;
 	int skipped_report_id = 0;
 	int report_number = data[0];
@@ -1125,6 +2286,8 @@ int HID_API_EXPORT hid_get_feature_report(hid_device *dev, unsigned char *data,
 		length--;
 		skipped_report_id = 1;
 	}
+	HID_PROBE3(get_feature_entry, dev, report_number, length);
+	start = monotonic_ns();
 	res = libusb_control_transfer(dev->device_handle,
 		LIBUSB_REQUEST_TYPE_CLASS|LIBUSB_RECIPIENT_INTERFACE|LIBUSB_ENDPOINT_IN,
 		0x01/*HID get_report*/,
@@ -1132,9 +2295,11 @@ int HID_API_EXPORT hid_get_feature_report(hid_device *dev, unsigned char *data,
 		dev->interface,
 		(unsigned char *)data, length,
 		1000/*timeout millis*/);
+	HID_PROBE2(get_feature_return, dev, res);
 	
 	if (res < 0)
 		return -1;
+	record_latency(dev, HID_LATENCY_FEATURE, monotonic_ns() - start);
 
 	if (skipped_report_id)
 		res++;
@@ -1147,17 +2312,12 @@ void HID_API_EXPORT hid_close(hid_device *dev)
 {
 	if (!dev)
 		return;
+	HID_PROBE1(device_close, dev);
 	
-	/* Cause read_thread() to stop. */
-	dev->shutdown_thread = 1;
-	libusb_cancel_transfer(dev->transfer);
-
-	/* Wait for read_thread() to end. */
-	pthread_join(dev->thread, NULL);
-	
-	/* Clean up the Transfer objects allocated in read_thread(). */
-	free(dev->transfer->buffer);
-	libusb_free_transfer(dev->transfer);
+	/* Stop reading and free the transfer objects. */
+	stop_input(dev);
+	if (dev->shared_ring)
+		ring_fail(dev->shared_ring);
 	
 	/* release the interface */
 	libusb_release_interface(dev->device_handle, dev->interface);
@@ -1165,13 +2325,7 @@ void HID_API_EXPORT hid_close(hid_device *dev)
 	/* Close the handle */
 	libusb_close(dev->device_handle);
 	
-	/* Clear out the queue of received reports. */
-	pthread_mutex_lock(&dev->mutex);
-	while (dev->input_reports) {
-		return_data(dev, NULL, 0);
-	}
-	pthread_mutex_unlock(&dev->mutex);
-	
+	/* free_hid_device() releases the ring of received reports. */
 	free_hid_device(dev);
 }
 
@@ -1419,6 +2573,8 @@ uint16_t get_usb_code_for_current_locale(void)
 	return 0x0;
 }
 
+HID_BACKEND_TABLE();
+
 #ifdef __cplusplus
 }
 #endif
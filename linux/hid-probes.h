@@ -0,0 +1,75 @@
+/*******************************************************
+ HIDAPI - Multi-Platform library for
+ communication with HID devices.
+
+ Static tracing probes for the Linux implementations.
+
+ At the discretion of the user of this library,
+ this software may be licensed under the terms of the
+ GNU Public License v3, a BSD-Style license, or the
+ original HIDAPI license as outlined in the LICENSE.txt,
+ LICENSE-gpl3.txt, LICENSE-bsd.txt, and LICENSE-orig.txt
+ files located at the root of the source distribution.
+ These files may also be found in the public source
+ code repository located at:
+        http://github.com/signal11/hidapi .
+********************************************************/
+
+#ifndef HID_PROBES_H__
+#define HID_PROBES_H__
+
+/* Built with -DHIDAPI_USDT, hid.c and hid-libusb.c carry USDT probes
+   under the provider "hidapi", which perf, bpftrace and SystemTap can
+   attach to without restarting the application:
+
+	bpftrace -e 'usdt:./libhidapi-jni.so:hidapi:report_dequeue
+		{ @latency = hist(arg2); }'
+
+   Each probe is a single NOP until a tracer attaches to it. Without
+   -DHIDAPI_USDT they aren't compiled in at all.
+
+   report_arrive(dev, len)
+	An Input report was received from the device.
+   report_enqueue(dev, len, sequence, queued)
+	It was queued for hid_read(). queued counts it.
+   report_dequeue(dev, len, latency_ns)
+	hid_read() took it out of the queue.
+   report_drop(dev)
+	An Input report was dropped, see hid_get_dropped_count().
+   write_entry(dev, report_id, len), write_return(dev, res)
+	Around hid_write().
+   send_feature_entry(dev, report_id, len), send_feature_return(dev, res)
+   get_feature_entry(dev, report_id, len), get_feature_return(dev, res)
+	Around the transfer of a Feature report.
+   device_open(dev, path), device_close(dev)
+	A device was opened or is being closed. dev is NULL if
+	opening path failed.
+   enumerate_entry(vendor_id, product_id),
+   enumerate_return(vendor_id, product_id, count)
+	Around hid_enumerate().
+
+   Reports written to an input ring (hid_set_input_ring()) are taken
+   out by the application, so they only fire report_arrive and
+   report_drop. */
+
+#ifdef HIDAPI_USDT
+
+#include <sys/sdt.h>
+
+#define HID_PROBE1(name, a) DTRACE_PROBE1(hidapi, name, a)
+#define HID_PROBE2(name, a, b) DTRACE_PROBE2(hidapi, name, a, b)
+#define HID_PROBE3(name, a, b, c) DTRACE_PROBE3(hidapi, name, a, b, c)
+#define HID_PROBE4(name, a, b, c, d) DTRACE_PROBE4(hidapi, name, a, b, c, d)
+
+#else
+
+/* Keep the arguments "used", so variables which are only traced
+   don't draw warnings. They are all plain values. */
+#define HID_PROBE1(name, a) do { (void) (a); } while (0)
+#define HID_PROBE2(name, a, b) do { (void) (a); (void) (b); } while (0)
+#define HID_PROBE3(name, a, b, c) do { (void) (a); (void) (b); (void) (c); } while (0)
+#define HID_PROBE4(name, a, b, c, d) do { (void) (a); (void) (b); (void) (c); (void) (d); } while (0)
+
+#endif
+
+#endif
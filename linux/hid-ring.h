@@ -0,0 +1,214 @@
+/*******************************************************
+ HIDAPI - Multi-Platform library for
+ communication with HID devices.
+
+ Input rings for the Linux implementations.
+
+ At the discretion of the user of this library,
+ this software may be licensed under the terms of the
+ GNU Public License v3, a BSD-Style license, or the
+ original HIDAPI license as outlined in the LICENSE.txt,
+ LICENSE-gpl3.txt, LICENSE-bsd.txt, and LICENSE-orig.txt
+ files located at the root of the source distribution.
+ These files may also be found in the public source
+ code repository located at:
+        http://github.com/signal11/hidapi .
+********************************************************/
+
+#ifndef HID_RING_H__
+#define HID_RING_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#include "hidapi.h"
+
+/* The application's input ring, see hid_set_input_ring(). The library
+   is the only producer: it writes the records, tail, dropped and
+   failed. The consumer writes head and waiting. */
+
+/* Size of a record with len bytes of data. Records are 8-byte aligned
+   so the timestamps are. */
+#define RING_RECORD_SIZE(len) ((sizeof(struct hid_input_record) + (len) + 7) & ~(size_t) 7)
+
+
+/* The smallest record area of an input ring. */
+#define RING_MIN_CAPACITY 256
+
+/* InputRing.java reads rings at these offsets, so changing the layout
+   of struct hid_input_ring or struct hid_input_record breaks the build
+   until it is updated too. */
+#define RING_LAYOUT_CHECK(name, cond) typedef char ring_layout_##name[(cond)? 1: -1]
+RING_LAYOUT_CHECK(head, offsetof(struct hid_input_ring, head) == 0);
+RING_LAYOUT_CHECK(tail, offsetof(struct hid_input_ring, tail) == 64);
+RING_LAYOUT_CHECK(capacity, offsetof(struct hid_input_ring, capacity) == 128);
+RING_LAYOUT_CHECK(dropped, offsetof(struct hid_input_ring, dropped) == 140);
+RING_LAYOUT_CHECK(failed, offsetof(struct hid_input_ring, failed) == 144);
+RING_LAYOUT_CHECK(header, sizeof(struct hid_input_ring) == 192);
+RING_LAYOUT_CHECK(record, sizeof(struct hid_input_record) == 16 &&
+                  offsetof(struct hid_input_record, sequence) == 4 &&
+                  offsetof(struct hid_input_record, timestamp) == 8);
+RING_LAYOUT_CHECK(wrap, HID_INPUT_RING_WRAP == 0xffffffffu);
+
+/* Returns the size of the record area for a ring of size bytes at
+   ring, or 0 if the memory is too small or misaligned. */
+static size_t ring_capacity(struct hid_input_ring *ring, size_t size)
+{
+	size_t capacity;
+
+	if (((uintptr_t) ring & 7) || size < sizeof(*ring) + RING_MIN_CAPACITY)
+		return 0;
+
+	size -= sizeof(*ring);
+	for (capacity = RING_MIN_CAPACITY; capacity * 2 <= size && capacity < 0x80000000u; capacity *= 2)
+		;
+	return capacity;
+}
+
+/* Set up the header of a new ring. */
+static void ring_init(struct hid_input_ring *ring, size_t capacity)
+{
+	memset(ring, 0, sizeof(*ring));
+	ring->capacity = capacity;
+}
+
+/* Wake the consumer if it is asleep in ring_wait(). */
+static void ring_wake(struct hid_input_ring *ring)
+{
+	/* Pairs with the fence in ring_wait(): either the consumer sees
+	   what we just published or we see it waiting. */
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	if (__atomic_load_n(&ring->waiting, __ATOMIC_RELAXED)) {
+		__atomic_add_fetch(&ring->wakeup, 1, __ATOMIC_RELEASE);
+		syscall(SYS_futex, &ring->wakeup, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+	}
+}
+
+/* Write a report to the ring, or count it as dropped if it doesn't
+   fit. Returns 0 if it was written and -1 if it was dropped. Only one
+   thread may call this at a time. */
+static int ring_push(struct hid_input_ring *ring, const uint8_t *data, size_t len, unsigned long long sequence, unsigned long long timestamp)
+{
+	unsigned char *records = (unsigned char*) (ring + 1);
+	unsigned int mask = ring->capacity - 1;
+	unsigned int tail = ring->tail;
+	unsigned int head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+	size_t size = RING_RECORD_SIZE(len);
+	size_t skip = 0;
+	struct hid_input_record *rec;
+
+	/* A record never wraps around. If it doesn't fit before the end,
+	   skip to the start. */
+	if (size > ring->capacity - (tail & mask))
+		skip = ring->capacity - (tail & mask);
+	if (skip + size > ring->capacity - (tail - head)) {
+		__atomic_store_n(&ring->dropped, ring->dropped + 1, __ATOMIC_RELAXED);
+		return -1;
+	}
+	if (skip > 0) {
+		rec = (struct hid_input_record*) (records + (tail & mask));
+		rec->length = HID_INPUT_RING_WRAP;
+		tail += skip;
+	}
+
+	rec = (struct hid_input_record*) (records + (tail & mask));
+	rec->length = len;
+	rec->sequence = (unsigned int) sequence;
+	rec->timestamp = timestamp;
+	memcpy(rec + 1, data, len);
+
+	__atomic_store_n(&ring->tail, tail + size, __ATOMIC_RELEASE);
+	ring_wake(ring);
+	return 0;
+}
+
+/* Tell the consumer that no more records will be written. */
+static void ring_fail(struct hid_input_ring *ring)
+{
+	__atomic_store_n(&ring->failed, 1, __ATOMIC_RELEASE);
+	ring_wake(ring);
+}
+
+/* Wait for a record. Returns 1 if one is available, 0 on timeout and
+   -1 if the ring has failed and is empty. */
+static int ring_wait(struct hid_input_ring *ring, int milliseconds)
+{
+	struct timespec deadline;
+
+	if (milliseconds > 0) {
+		clock_gettime(CLOCK_MONOTONIC, &deadline);
+		deadline.tv_sec += milliseconds / 1000;
+		deadline.tv_nsec += (milliseconds % 1000) * 1000000;
+		if (deadline.tv_nsec >= 1000000000L) {
+			deadline.tv_sec++;
+			deadline.tv_nsec -= 1000000000L;
+		}
+	}
+
+	for (;;) {
+		unsigned int wakeup = __atomic_load_n(&ring->wakeup, __ATOMIC_ACQUIRE);
+		int res = 0;
+
+		if (__atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) != ring->head)
+			return 1;
+		if (__atomic_load_n(&ring->failed, __ATOMIC_ACQUIRE))
+			return -1;
+		if (milliseconds == 0)
+			return 0;
+
+		/* Announce that we're going to sleep, then look again; see
+		   ring_wake(). If the producer bumps wakeup in between, the
+		   futex wait returns at once. */
+		__atomic_store_n(&ring->waiting, 1, __ATOMIC_RELAXED);
+		__atomic_thread_fence(__ATOMIC_SEQ_CST);
+		if (__atomic_load_n(&ring->tail, __ATOMIC_RELAXED) == ring->head &&
+		    !__atomic_load_n(&ring->failed, __ATOMIC_RELAXED))
+			res = syscall(SYS_futex, &ring->wakeup, FUTEX_WAIT_BITSET_PRIVATE, wakeup,
+			              milliseconds > 0? &deadline: NULL, NULL, FUTEX_BITSET_MATCH_ANY);
+		__atomic_store_n(&ring->waiting, 0, __ATOMIC_RELAXED);
+
+		/* Look once more, then give up. */
+		if (res < 0 && errno == ETIMEDOUT)
+			milliseconds = 0;
+	}
+}
+
+/* Take the oldest record out of the ring. Only the consumer may call
+   this. */
+static int ring_read(struct hid_input_ring *ring, unsigned char *data, size_t length, unsigned long long *timestamp, int milliseconds)
+{
+	unsigned char *records = (unsigned char*) (ring + 1);
+	unsigned int mask = ring->capacity - 1;
+	unsigned int head;
+	struct hid_input_record *rec;
+	size_t len;
+	int res;
+
+	res = ring_wait(ring, milliseconds);
+	if (res <= 0)
+		return res;
+
+	head = ring->head;
+	rec = (struct hid_input_record*) (records + (head & mask));
+	if (rec->length == HID_INPUT_RING_WRAP) {
+		head += ring->capacity - (head & mask);
+		rec = (struct hid_input_record*) records;
+	}
+
+	len = (length < rec->length)? length: rec->length;
+	memcpy(data, rec + 1, len);
+	if (timestamp)
+		*timestamp = rec->timestamp;
+
+	/* Hand the space back to the producer. */
+	__atomic_store_n(&ring->head, head + RING_RECORD_SIZE(rec->length), __ATOMIC_RELEASE);
+	return len;
+}
+
+#endif
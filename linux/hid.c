@@ -27,6 +27,8 @@
 #include <stdlib.h>
 #include <locale.h>
 #include <errno.h>
+#include <stdint.h>
+#include <time.h>
 
 /* Unix */
 #include <unistd.h>
@@ -36,14 +38,30 @@
 #include <sys/utsname.h>
 #include <fcntl.h>
 #include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
 
 /* Linux */
+#include <linux/futex.h>
 #include <linux/hidraw.h>
 #include <linux/version.h>
 #include <linux/input.h>
 #include <libudev.h>
+/* The io_uring engine needs provided buffer rings, from Linux 5.19. */
+#if defined(__has_include)
+#if __has_include(<linux/io_uring.h>) && LINUX_VERSION_CODE >= KERNEL_VERSION(5,19,0)
+#include <linux/io_uring.h>
+#define HAVE_IO_URING
+#endif
+#endif
 
-#include "hidapi.h"
+#include "hid-backend.h"
+#include "hid-probes.h"
+#include "hid-ring.h"
 
 /* Definitions from linux/hidraw.h. Since these are new, some distros
    may not have header files which contain them. */
@@ -54,6 +72,26 @@
 #define HIDIOCGFEATURE(len)    _IOC(_IOC_WRITE|_IOC_READ, 'H', 0x07, len)
 #endif
 
+/* The most devices returned by one hid_reactor_wait(). */
+#define REACTOR_MAX_EVENTS 256
+
+/* The largest report the reader thread of an input ring reads, see
+   hid_set_input_ring(). */
+#define RING_READ_SIZE 4096
+
+/* The io_uring engine: SQ entries in the shared ring, reads kept posted
+   on each device, and reports queued per device. Multishot reads share
+   URING_BUFFERS provided buffers instead. */
+#define URING_ENTRIES 1024
+#define URING_READS 4
+#define URING_BUFFER_SIZE 4096
+#define URING_QUEUE_SIZE 16
+#define URING_BUFFERS 256
+#define URING_BUFFER_GROUP 0
+
+/* IORING_OP_READ_MULTISHOT, from Linux 6.7. Older headers lack it. */
+#define URING_OP_READ_MULTISHOT 49
+
 
 /* USB HID device property names */
 const char *device_string_names[] = {
@@ -71,21 +109,67 @@ enum device_string_id {
 	DEVICE_STRING_COUNT,
 };
 
+struct uring_input;
+
 struct hid_device_ {
+	HID_BACKEND_HEADER
 	int device_handle;
 	int blocking;
 	int uses_numbered_reports;
+
+	/* Non-NULL when the device is read through the io_uring engine. */
+	struct uring_input *uring;
+
+	/* When not NULL, reports are written to this ring instead. See
+	   hid_set_input_ring(). The engine writes it for io_uring devices,
+	   ring_thread for others, until ring_stop_fd becomes readable. */
+	struct hid_input_ring *shared_ring;
+	pthread_t ring_thread;
+	int ring_stop_fd;
+
+	/* Every report read from the device is numbered from 0, so readers
+	   can spot the ones dropped, which are counted in stats. Both are
+	   updated with relaxed atomics, as reports may be read by the
+	   application, the engine or ring_thread. See hid_get_stats(). */
+	unsigned long long next_sequence;
+	struct hid_device_stats stats;
+	struct hid_histogram latency[HID_LATENCY_FEATURE + 1];
+};
+
+struct hid_reactor_ {
+	HID_BACKEND_HEADER
+	int epoll_fd;
+
+	/* Devices read by the io_uring engine aren't in the epoll set.
+	   They go on the ready list when they become ready, and ready_fd
+	   is readable while it isn't empty, so a batch of them costs one
+	   wake-up. */
+	pthread_mutex_t mutex; /* Protects the lists and the devices' links */
+	hid_device *members;
+	hid_device *ready;
+	int ready_fd;
+
+	/* Set while on the engine thread's list of reactors to wake at
+	   the end of its batch. Protected by uring.sq_lock. */
+	hid_reactor *wake_next;
+	int wake_queued; /* boolean */
 };
 
 
 static __u32 kernel_version = 0;
 
+/* The engine for devices opened from now on, see hid_set_io_engine(). */
+static int io_engine = HID_IO_ENGINE_DEFAULT;
+static pthread_mutex_t io_engine_mutex = PTHREAD_MUTEX_INITIALIZER;
+
 hid_device *new_hid_device()
 {
 	hid_device *dev = calloc(1, sizeof(hid_device));
+	HID_BACKEND_INIT(dev);
 	dev->device_handle = -1;
 	dev->blocking = 1;
 	dev->uses_numbered_reports = 0;
+	dev->uring = NULL;
 
 	return dev;
 }
@@ -278,7 +362,9 @@ static int get_device_string(hid_device *dev, enum device_string_id key, wchar_t
 			           &serial_number_utf8,
 			           &product_name_utf8);
 
-			if (bus_type == BUS_BLUETOOTH) {
+			/* Virtual devices, such as those made through /dev/uhid, have
+			   no parent to ask either, so take theirs from the uevent too. */
+			if (bus_type == BUS_BLUETOOTH || bus_type == BUS_VIRTUAL) {
 				switch (key) {
 					case DEVICE_STRING_MANUFACTURER:
 						wcsncpy(string, L"", maxlen);
@@ -338,371 +424,1746 @@ end:
 	return ret;
 }
 
-int HID_API_EXPORT hid_init(void)
+/* Number the next report read from the device. */
+static unsigned long long take_sequence(hid_device *dev)
 {
-	const char *locale;
-
-	/* Set the locale if it's not set. */
-	locale = setlocale(LC_CTYPE, NULL);
-	if (!locale)
-		setlocale(LC_CTYPE, "");
-
-	return 0;
+	return __atomic_fetch_add(&dev->next_sequence, 1, __ATOMIC_RELAXED);
 }
 
-int HID_API_EXPORT hid_exit(void)
+#define STAT_ADD(dev, field, n) __atomic_add_fetch(&(dev)->stats.field, (n), __ATOMIC_RELAXED)
+
+static void stat_max(unsigned long long *stat, unsigned long long value)
 {
-	/* Nothing to do for this in the Linux/hidraw implementation. */
-	return 0;
+	unsigned long long old = __atomic_load_n(stat, __ATOMIC_RELAXED);
+	while (value > old &&
+	       !__atomic_compare_exchange_n(stat, &old, value, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+		;
 }
 
-
-struct hid_device_info  HID_API_EXPORT *hid_enumerate(unsigned short vendor_id, unsigned short product_id)
+/* See hid_histogram for the bucket layout. */
+static void record_latency(hid_device *dev, int kind, unsigned long long ns)
 {
-	struct udev *udev;
-	struct udev_enumerate *enumerate;
-	struct udev_list_entry *devices, *dev_list_entry;
-	
-	struct hid_device_info *root = NULL; // return object
-	struct hid_device_info *cur_dev = NULL;
-	struct hid_device_info *prev_dev = NULL; // previous device
-
-	hid_init();
-
-	/* Create the udev object */
-	udev = udev_new();
-	if (!udev) {
-		printf("Can't create udev\n");
-		return NULL;
+	struct hid_histogram *h = &dev->latency[kind];
+	unsigned long long index = ns;
+
+	if (ns >= 2 * HID_HISTOGRAM_SUB_BUCKETS) {
+		int e = 63 - __builtin_clzll(ns) - __builtin_ctz(HID_HISTOGRAM_SUB_BUCKETS);
+		index = e * HID_HISTOGRAM_SUB_BUCKETS + (ns >> e);
+		if (index >= HID_HISTOGRAM_BUCKETS)
+			index = HID_HISTOGRAM_BUCKETS - 1;
 	}
+	__atomic_add_fetch(&h->counts[index], 1, __ATOMIC_RELAXED);
+	__atomic_add_fetch(&h->total, ns, __ATOMIC_RELAXED);
+	stat_max(&h->max, ns);
+}
 
-	/* Create a list of the devices in the 'hidraw' subsystem. */
-	enumerate = udev_enumerate_new(udev);
-	udev_enumerate_add_match_subsystem(enumerate, "hidraw");
-	udev_enumerate_scan_devices(enumerate);
-	devices = udev_enumerate_get_list_entry(enumerate);
-	/* For each item, see if it matches the vid/pid, and if so
-	   create a udev_device record for it */
-	udev_list_entry_foreach(dev_list_entry, devices) {
-		const char *sysfs_path;
-		const char *dev_path;
-		const char *str;
-		struct udev_device *raw_dev; // The device's hidraw udev node.
-		struct udev_device *hid_dev; // The device's HID udev node.
-		struct udev_device *usb_dev; // The device's USB udev node.
-		struct udev_device *intf_dev; // The device's interface (in the USB sense).
-		unsigned short dev_vid;
-		unsigned short dev_pid;
-		char *serial_number_utf8 = NULL;
-		char *product_name_utf8 = NULL;
-		int bus_type;
-		int result;
-
-		/* Get the filename of the /sys entry for the device
-		   and create a udev_device object (dev) representing it */
-		sysfs_path = udev_list_entry_get_name(dev_list_entry);
-		raw_dev = udev_device_new_from_syspath(udev, sysfs_path);
-		dev_path = udev_device_get_devnode(raw_dev);
+static void count_received(hid_device *dev, int len)
+{
+	STAT_ADD(dev, reports_received, 1);
+	STAT_ADD(dev, bytes_in, len);
+	HID_PROBE2(report_arrive, dev, len);
+}
 
-		hid_dev = udev_device_get_parent_with_subsystem_devtype(
-			raw_dev,
-			"hid",
-			NULL);
+static void count_dropped(hid_device *dev)
+{
+	STAT_ADD(dev, reports_dropped, 1);
+	HID_PROBE1(report_drop, dev);
+}
 
-		if (!hid_dev) {
-			/* Unable to find parent hid device. */
-			goto next;
-		}
+static unsigned long long monotonic_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
 
-		result = parse_uevent_info(
-			udev_device_get_sysattr_value(hid_dev, "uevent"),
-			&bus_type,
-			&dev_vid,
-			&dev_pid,
-			&serial_number_utf8,
-			&product_name_utf8);
+#ifdef HAVE_IO_URING
+/* The io_uring engine, see hid_set_io_engine(). One ring and one thread
+   serve every device opened with it. Each device keeps a multishot read
+   posted, or URING_READS reads on kernels before 6.7, which the kernel
+   completes as reports arrive, so one io_uring_enter() call reaps and
+   reposts reads for many devices and several reports per device.
+   Completed reports are copied into a per-device queue which
+   hid_read_timeout() takes them from.
+
+   Only the engine thread submits. The reads of a device then all run
+   in its context one after another, so their completions come in the
+   order the reports were read. Other threads add SQEs to the ring and
+   wake the thread through wake_fd, on which it keeps a read posted. */
+
+struct uring_op {
+	hid_device *dev;
+	int index;
+};
 
-		if (!result) {
-			/* parse_uevent_info() failed for at least one field. */
-			goto next;
-		}
+struct uring_input {
+	pthread_mutex_t mutex; /* Protects everything below */
+	pthread_cond_t condition;
+
+	struct uring_op ops[URING_READS];
+	uint8_t buffers[URING_READS][URING_BUFFER_SIZE];
+	int pending; /* reads posted and not completed */
+	int closing; /* boolean, don't repost reads */
+	int shutdown; /* boolean, no more reports will be queued */
+
+	/* Ring of received input reports, the oldest at head. */
+	uint8_t reports[URING_QUEUE_SIZE][URING_BUFFER_SIZE];
+	size_t report_len[URING_QUEUE_SIZE];
+	unsigned long long report_time[URING_QUEUE_SIZE]; /* CLOCK_MONOTONIC ns, when the read completed */
+	unsigned long long report_seq[URING_QUEUE_SIZE];
+	int head;
+	int count;
+
+	/* See hid_get_poll_fd(). */
+	int poll_fd;
+	int poll_signalled; /* boolean */
+
+	/* The reactor the device was added to, if any. */
+	hid_reactor *reactor;
+	hid_device *member_next;
+	hid_device *ready_next;
+	int on_ready_list; /* boolean */
+};
 
-		if (bus_type != BUS_USB && bus_type != BUS_BLUETOOTH) {
-			/* We only know how to handle USB and BT devices. */
-			goto next;
-		}
+static struct {
+	int fd; /* -1 until the engine is set up */
+	pthread_t thread;
+	int stop;
 
-		/* Check the VID/PID against the arguments */
-		if ((vendor_id == 0x0 && product_id == 0x0) ||
-		    (vendor_id == dev_vid && product_id == dev_pid)) {
-			struct hid_device_info *tmp;
+	int wake_fd;
+	eventfd_t wake_value;
 
-			/* VID/PID match. Create the record. */
-			tmp = malloc(sizeof(struct hid_device_info));
-			if (cur_dev) {
-				cur_dev->next = tmp;
-			}
-			else {
-				root = tmp;
-			}
-			prev_dev = cur_dev;
-			cur_dev = tmp;
+	pthread_mutex_t sq_lock; /* Protects the SQ, unsubmitted and wake_list */
+	unsigned *sq_head, *sq_tail, *sq_array;
+	unsigned sq_mask, sq_entries, sq_local_tail, unsubmitted;
+	struct io_uring_sqe *sqes;
+	hid_reactor *wake_list;
 
-			/* Fill out the record */
-			cur_dev->next = NULL;
-			cur_dev->path = dev_path? strdup(dev_path): NULL;
+	unsigned *cq_head, *cq_tail;
+	unsigned cq_mask;
+	struct io_uring_cqe *cqes;
 
-			/* VID/PID */
-			cur_dev->vendor_id = dev_vid;
-			cur_dev->product_id = dev_pid;
+	void *ring; /* both the SQ and CQ rings */
+	size_t ring_size, sqes_size;
 
-			/* Serial Number */
-			cur_dev->serial_number = utf8_to_wchar_t(serial_number_utf8);
+	/* The provided buffers for multishot reads, returned to the
+	   kernel by the engine thread as soon as they are copied. */
+	int multishot; /* boolean */
+	struct io_uring_buf_ring *buf_ring;
+	uint8_t *buf_base;
+	unsigned short buf_tail;
+} uring = { -1, 0, 0, -1, 0, PTHREAD_MUTEX_INITIALIZER };
 
-			/* Release Number */
-			cur_dev->release_number = 0x0;
-
-			/* Interface Number */
-			cur_dev->interface_number = -1;
-
-			switch (bus_type) {
-				case BUS_USB:
-					/* The device pointed to by raw_dev contains information about
-					   the hidraw device. In order to get information about the
-					   USB device, get the parent device with the
-					   subsystem/devtype pair of "usb"/"usb_device". This will
-					   be several levels up the tree, but the function will find
-					   it. */
-					usb_dev = udev_device_get_parent_with_subsystem_devtype(
-							raw_dev,
-							"usb",
-							"usb_device");
-
-					if (!usb_dev) {
-						/* Free this device */
-						free(cur_dev->serial_number);
-						free(cur_dev->path);
-						free(cur_dev);
-
-						/* Take it off the device list. */
-						if (prev_dev) {
-							prev_dev->next = NULL;
-							cur_dev = prev_dev;
-						}
-						else {
-							cur_dev = root = NULL;
-						}
-
-						goto next;
-					}
+static int io_uring_setup(unsigned entries, struct io_uring_params *p)
+{
+	return syscall(__NR_io_uring_setup, entries, p);
+}
 
-					/* Manufacturer and Product strings */
-					cur_dev->manufacturer_string = copy_udev_string(usb_dev, device_string_names[DEVICE_STRING_MANUFACTURER]);
-					cur_dev->product_string = copy_udev_string(usb_dev, device_string_names[DEVICE_STRING_PRODUCT]);
-
-					/* Release Number */
-					str = udev_device_get_sysattr_value(usb_dev, "bcdDevice");
-					cur_dev->release_number = (str)? strtol(str, NULL, 16): 0x0;
-
-					/* Get a handle to the interface's udev node. */
-					intf_dev = udev_device_get_parent_with_subsystem_devtype(
-							raw_dev,
-							"usb",
-							"usb_interface");
-					if (intf_dev) {
-						str = udev_device_get_sysattr_value(intf_dev, "bInterfaceNumber");
-						cur_dev->interface_number = (str)? strtol(str, NULL, 16): -1;
-					}
+static int io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags)
+{
+	return syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, NULL, 0);
+}
 
-					break;
+static int io_uring_register(int fd, unsigned opcode, void *arg, unsigned nr_args)
+{
+	return syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+}
 
-				case BUS_BLUETOOTH:
-					/* Manufacturer and Product strings */
-					cur_dev->manufacturer_string = wcsdup(L"");
-					cur_dev->product_string = utf8_to_wchar_t(product_name_utf8);
+/* Make the SQEs added so far visible to the kernel and return how many
+   to submit. This should be called with uring.sq_lock locked. */
+static unsigned uring_publish(void)
+{
+	unsigned to_submit = uring.unsubmitted;
+	__atomic_store_n(uring.sq_tail, uring.sq_local_tail, __ATOMIC_RELEASE);
+	uring.unsubmitted = 0;
+	return to_submit;
+}
 
-					break;
+/* Have the engine thread submit the SQEs added so far. */
+static void uring_wake(void)
+{
+	eventfd_write(uring.wake_fd, 1);
+}
 
-				default:
-					/* Unknown device type - this should never happen, as we
-					 * check for USB and Bluetooth devices above */
-					break;
-			}
+/* Return a cleared SQE to fill in, to be submitted by the engine thread.
+   This should be called with uring.sq_lock locked. */
+static struct io_uring_sqe *uring_get_sqe(void)
+{
+	struct io_uring_sqe *sqe;
+	unsigned index;
+
+	while (uring.sq_local_tail - __atomic_load_n(uring.sq_head, __ATOMIC_ACQUIRE) == uring.sq_entries) {
+		/* The SQ is full. The engine thread can submit it
+		   right away; others have to let it catch up. */
+		if (pthread_equal(pthread_self(), uring.thread)) {
+			io_uring_enter(uring.fd, uring_publish(), 0, 0);
+			continue;
 		}
-
-	next:
-		free(serial_number_utf8);
-		free(product_name_utf8);
-		udev_device_unref(raw_dev);
-		/* hid_dev, usb_dev and intf_dev don't need to be (and can't be)
-		   unref()d.  It will cause a double-free() error.  I'm not
-		   sure why.  */
+		uring_wake();
+		pthread_mutex_unlock(&uring.sq_lock);
+		sched_yield();
+		pthread_mutex_lock(&uring.sq_lock);
 	}
-	/* Free the enumerator and udev objects. */
-	udev_enumerate_unref(enumerate);
-	udev_unref(udev);
-	
-	return root;
+
+	index = uring.sq_local_tail & uring.sq_mask;
+	sqe = &uring.sqes[index];
+	memset(sqe, 0, sizeof(*sqe));
+	uring.sq_array[index] = index;
+	uring.sq_local_tail++;
+	uring.unsubmitted++;
+	return sqe;
 }
 
-void  HID_API_EXPORT hid_free_enumeration(struct hid_device_info *devs)
+/* Post read number index of dev, or its multishot read. This should be
+   called with uring.sq_lock locked, and the caller counts the read in
+   dev->uring->pending. */
+static void uring_post_read(hid_device *dev, int index)
 {
-	struct hid_device_info *d = devs;
-	while (d) {
-		struct hid_device_info *next = d->next;
-		free(d->path);
-		free(d->serial_number);
-		free(d->manufacturer_string);
-		free(d->product_string);
-		free(d);
-		d = next;
+	struct uring_input *in = dev->uring;
+	struct io_uring_sqe *sqe;
+
+	sqe = uring_get_sqe();
+	sqe->fd = dev->device_handle;
+	sqe->off = -1; /* current position, it's a character device */
+	sqe->user_data = (unsigned long) &in->ops[index];
+	if (uring.multishot) {
+		sqe->opcode = URING_OP_READ_MULTISHOT;
+		sqe->flags = IOSQE_BUFFER_SELECT;
+		sqe->buf_group = URING_BUFFER_GROUP;
+	}
+	else {
+		sqe->opcode = IORING_OP_READ;
+		sqe->addr = (unsigned long) in->buffers[index];
+		sqe->len = URING_BUFFER_SIZE;
 	}
 }
 
-hid_device * hid_open(unsigned short vendor_id, unsigned short product_id, const wchar_t *serial_number)
+/* Give provided buffer bid back to the kernel. Once the engine thread
+   runs, only it calls this. */
+static void uring_recycle_buffer(unsigned short bid)
 {
-	struct hid_device_info *devs, *cur_dev;
-	const char *path_to_open = NULL;
-	hid_device *handle = NULL;
-	
-	devs = hid_enumerate(vendor_id, product_id);
-	cur_dev = devs;
-	while (cur_dev) {
-		if (cur_dev->vendor_id == vendor_id &&
-		    cur_dev->product_id == product_id) {
-			if (serial_number) {
-				if (wcscmp(serial_number, cur_dev->serial_number) == 0) {
-					path_to_open = cur_dev->path;
-					break;
+	struct io_uring_buf *buf = &uring.buf_ring->bufs[uring.buf_tail & (URING_BUFFERS - 1)];
+
+	buf->addr = (unsigned long) (uring.buf_base + (size_t) bid * URING_BUFFER_SIZE);
+	buf->len = URING_BUFFER_SIZE;
+	buf->bid = bid;
+	uring.buf_tail++;
+	__atomic_store_n(&uring.buf_ring->tail, uring.buf_tail, __ATOMIC_RELEASE);
+}
+
+/* Put dev on its reactor's ready list. This should be called with
+   dev->uring->mutex locked. */
+static void uring_reactor_push(hid_device *dev)
+{
+	struct uring_input *in = dev->uring;
+	hid_reactor *reactor = in->reactor;
+
+	pthread_mutex_lock(&reactor->mutex);
+	if (!in->on_ready_list) {
+		if (!reactor->ready) {
+			/* The engine thread wakes the reactor once it has
+			   handled all the completions at hand. */
+			if (pthread_equal(pthread_self(), uring.thread)) {
+				pthread_mutex_lock(&uring.sq_lock);
+				if (!reactor->wake_queued) {
+					reactor->wake_next = uring.wake_list;
+					uring.wake_list = reactor;
+					reactor->wake_queued = 1;
 				}
+				pthread_mutex_unlock(&uring.sq_lock);
 			}
-			else {
-				path_to_open = cur_dev->path;
-				break;
-			}
+			else
+				eventfd_write(reactor->ready_fd, 1);
 		}
-		cur_dev = cur_dev->next;
-	}
-
-	if (path_to_open) {
-		/* Open the device */
-		handle = hid_open_path(path_to_open);
+		in->ready_next = reactor->ready;
+		reactor->ready = dev;
+		in->on_ready_list = 1;
 	}
-
-	hid_free_enumeration(devs);
-	
-	return handle;
+	pthread_mutex_unlock(&reactor->mutex);
 }
 
-hid_device * HID_API_EXPORT hid_open_path(const char *path)
+/* Add dev to reactor. This should be called with dev->uring->mutex
+   locked. */
+static void uring_reactor_add(hid_reactor *reactor, hid_device *dev)
 {
-	hid_device *dev = NULL;
+	struct uring_input *in = dev->uring;
 
-	hid_init();
+	pthread_mutex_lock(&reactor->mutex);
+	in->member_next = reactor->members;
+	reactor->members = dev;
+	pthread_mutex_unlock(&reactor->mutex);
 
-	dev = new_hid_device();
+	in->reactor = reactor;
+	if (in->count > 0 || in->shutdown)
+		uring_reactor_push(dev);
+}
 
-	if (kernel_version == 0) {
-		struct utsname name;
-		int major, minor, release;
-		int ret;
-		uname(&name);
-		ret = sscanf(name.release, "%d.%d.%d", &major, &minor, &release);
-		if (ret == 3) {
-			kernel_version = major << 16 | minor << 8 | release;
-			//printf("Kernel Version: %d\n", kernel_version);
+/* Take dev off its reactor. This should be called with
+   dev->uring->mutex locked. */
+static void uring_reactor_remove(hid_device *dev)
+{
+	struct uring_input *in = dev->uring;
+	hid_reactor *reactor = in->reactor;
+	hid_device **link;
+
+	pthread_mutex_lock(&reactor->mutex);
+	for (link = &reactor->members; *link != dev; link = &(*link)->uring->member_next)
+		;
+	*link = in->member_next;
+	if (in->on_ready_list) {
+		for (link = &reactor->ready; *link != dev; link = &(*link)->uring->ready_next)
+			;
+		*link = in->ready_next;
+		in->on_ready_list = 0;
+	}
+	pthread_mutex_unlock(&reactor->mutex);
+	in->reactor = NULL;
+}
+
+/* Store up to max_ready devices from the reactor's ready list which are
+   still ready and drop the others. Returns the number stored. A device
+   that becomes ready again is put back by the engine thread, which takes
+   reactor->mutex after changing its queue. */
+static int uring_reactor_collect(hid_reactor *reactor, hid_device **ready, int max_ready)
+{
+	hid_device **link;
+	int count = 0;
+
+	pthread_mutex_lock(&reactor->mutex);
+	link = &reactor->ready;
+	while (*link && count < max_ready) {
+		hid_device *dev = *link;
+		struct uring_input *in = dev->uring;
+		if (__atomic_load_n(&in->count, __ATOMIC_RELAXED) > 0 ||
+		    __atomic_load_n(&in->shutdown, __ATOMIC_RELAXED)) {
+			ready[count++] = dev;
+			link = &in->ready_next;
 		}
 		else {
-			printf("Couldn't sscanf() version string %s\n", name.release);
+			*link = in->ready_next;
+			in->on_ready_list = 0;
 		}
 	}
+	if (!reactor->ready) {
+		eventfd_t value;
+		eventfd_read(reactor->ready_fd, &value);
+	}
+	pthread_mutex_unlock(&reactor->mutex);
 
-	// OPEN HERE //
-	dev->device_handle = open(path, O_RDWR);
+	return count;
+}
 
-	// If we have a good handle, return it.
-	if (dev->device_handle > 0) {
+/* Make poll_fd readable exactly when a read wouldn't block, and tell the
+   reactor when it becomes so. This should be called with
+   dev->uring->mutex locked. */
+static void uring_update_ready(hid_device *dev)
+{
+	struct uring_input *in = dev->uring;
+	int readable = in->count > 0 || in->shutdown;
+	eventfd_t value;
 
-		/* Get the report descriptor */
-		int res, desc_size = 0;
-		struct hidraw_report_descriptor rpt_desc;
+	if (readable && in->reactor)
+		uring_reactor_push(dev);
+	if (in->poll_fd < 0 || readable == in->poll_signalled)
+		return;
+	if (readable)
+		eventfd_write(in->poll_fd, 1);
+	else
+		eventfd_read(in->poll_fd, &value);
+	in->poll_signalled = readable;
+}
 
-		memset(&rpt_desc, 0x0, sizeof(rpt_desc));
+static void uring_complete(struct uring_op *op, int res, unsigned flags)
+{
+	struct uring_input *in = op->dev->uring;
+	const uint8_t *buffer = in->buffers[op->index];
+	unsigned long long now = monotonic_ns();
 
-		/* Get Report Descriptor Size */
-		res = ioctl(dev->device_handle, HIDIOCGRDESCSIZE, &desc_size);
-		if (res < 0)
-			perror("HIDIOCGRDESCSIZE");
+	pthread_mutex_lock(&in->mutex);
 
+	/* A multishot read stays posted while the kernel says so. */
+	if (!(flags & IORING_CQE_F_MORE))
+		in->pending--;
+	if (flags & IORING_CQE_F_BUFFER)
+		buffer = uring.buf_base + (size_t) (flags >> IORING_CQE_BUFFER_SHIFT) * URING_BUFFER_SIZE;
 
-		/* Get Report Descriptor */
-		rpt_desc.size = desc_size;
-		res = ioctl(dev->device_handle, HIDIOCGRDESC, &rpt_desc);
-		if (res < 0) {
-			perror("HIDIOCGRDESC");
-		} else {
-			/* Determine if this device uses numbered reports. */
-			dev->uses_numbered_reports =
-				uses_numbered_reports(rpt_desc.value,
-				                      rpt_desc.size);
+	if (res > 0)
+		count_received(op->dev, res);
+
+	if (res > 0 && op->dev->shared_ring) {
+		if (ring_push(op->dev->shared_ring, buffer, res, take_sequence(op->dev), now) < 0)
+			count_dropped(op->dev);
+	}
+	else if (res > 0) {
+		/* A report. Drop the oldest one if the queue is full. */
+		int slot;
+		if (in->count == URING_QUEUE_SIZE) {
+			in->head = (in->head + 1) % URING_QUEUE_SIZE;
+			in->count--;
+			count_dropped(op->dev);
+		}
+		slot = (in->head + in->count) % URING_QUEUE_SIZE;
+		memcpy(in->reports[slot], buffer, res);
+		in->report_len[slot] = res;
+		in->report_time[slot] = now;
+		in->report_seq[slot] = take_sequence(op->dev);
+		in->count++;
+		stat_max(&op->dev->stats.queue_high_water, in->count);
+		HID_PROBE4(report_enqueue, op->dev, res, in->report_seq[slot], in->count);
+		if (in->count == 1) {
+			pthread_cond_signal(&in->condition);
+			uring_update_ready(op->dev);
 		}
-		
-		return dev;
 	}
-	else {
-		// Unable to open any devices.
-		free(dev);
-		return NULL;
+	/* -EAGAIN means no report was there and the kernel couldn't wait
+	   on poll for one; the read is posted again below, like one which
+	   ran out of buffers. */
+	else if (res != -EAGAIN && res != -EINTR && res != -ECANCELED && res != -ENOBUFS) {
+		/* This means the device has been disconnected. */
+		STAT_ADD(op->dev, transfer_errors, 1);
+		in->shutdown = 1;
+		pthread_cond_broadcast(&in->condition);
+		uring_update_ready(op->dev);
+		if (op->dev->shared_ring)
+			ring_fail(op->dev->shared_ring);
 	}
-}
 
+	if (flags & IORING_CQE_F_BUFFER)
+		uring_recycle_buffer(flags >> IORING_CQE_BUFFER_SHIFT);
 
-int HID_API_EXPORT hid_write(hid_device *dev, const unsigned char *data, size_t length)
+	if (!(flags & IORING_CQE_F_MORE)) {
+		if (!in->closing && !in->shutdown) {
+			in->pending++;
+			pthread_mutex_lock(&uring.sq_lock);
+			uring_post_read(op->dev, op->index);
+			pthread_mutex_unlock(&uring.sq_lock);
+		}
+		else if (in->pending == 0) {
+			/* Wake hid_close(). */
+			pthread_cond_broadcast(&in->condition);
+		}
+	}
+
+	pthread_mutex_unlock(&in->mutex);
+}
+
+/* Post the read of wake_fd. This should be called with uring.sq_lock
+   locked. */
+static void uring_post_wake(void)
 {
-	int bytes_written;
+	struct io_uring_sqe *sqe;
+
+	sqe = uring_get_sqe();
+	sqe->opcode = IORING_OP_READ;
+	sqe->fd = uring.wake_fd;
+	sqe->addr = (unsigned long) &uring.wake_value;
+	sqe->len = sizeof(uring.wake_value);
+	sqe->user_data = (unsigned long) &uring.wake_value;
+}
 
-	bytes_written = write(dev->device_handle, data, length);
+static void *uring_thread(void *param)
+{
+	pthread_mutex_lock(&uring.sq_lock);
+	uring_post_wake();
+	pthread_mutex_unlock(&uring.sq_lock);
+
+	while (!uring.stop) {
+		unsigned head, tail, to_submit;
+
+		/* Submit the reads reposted while handling the last batch
+		   and wait for the next one in the same call. */
+		pthread_mutex_lock(&uring.sq_lock);
+		to_submit = uring_publish();
+		pthread_mutex_unlock(&uring.sq_lock);
+
+		if (io_uring_enter(uring.fd, to_submit, 1, IORING_ENTER_GETEVENTS) < 0 &&
+		    errno != EINTR && errno != EAGAIN && errno != EBUSY)
+			break;
+
+		head = *uring.cq_head;
+		tail = __atomic_load_n(uring.cq_tail, __ATOMIC_ACQUIRE);
+		for (; head != tail; head++) {
+			struct io_uring_cqe *cqe = &uring.cqes[head & uring.cq_mask];
+			struct uring_op *op = (struct uring_op *) (unsigned long) cqe->user_data;
+			if (cqe->user_data == (unsigned long) &uring.wake_value) {
+				pthread_mutex_lock(&uring.sq_lock);
+				uring_post_wake();
+				pthread_mutex_unlock(&uring.sq_lock);
+			}
+			else if (op) /* Cancellations carry no op. */
+				uring_complete(op, cqe->res, cqe->flags);
+		}
+		__atomic_store_n(uring.cq_head, head, __ATOMIC_RELEASE);
+
+		/* Wake the reactors which got ready devices. */
+		pthread_mutex_lock(&uring.sq_lock);
+		while (uring.wake_list) {
+			hid_reactor *reactor = uring.wake_list;
+			uring.wake_list = reactor->wake_next;
+			reactor->wake_queued = 0;
+			eventfd_write(reactor->ready_fd, 1);
+		}
+		pthread_mutex_unlock(&uring.sq_lock);
+	}
 
-	return bytes_written;
+	return NULL;
 }
 
+/* Close the ring and unmap what uring_start() mapped. */
+static void uring_stop_mappings(void)
+{
+	close(uring.fd);
+	munmap(uring.sqes, uring.sqes_size);
+	munmap(uring.ring, uring.ring_size);
+	if (uring.multishot) {
+		munmap(uring.buf_base, (size_t) URING_BUFFERS * URING_BUFFER_SIZE);
+		munmap(uring.buf_ring, URING_BUFFERS * sizeof(struct io_uring_buf));
+	}
+	uring.fd = -1;
+	uring.multishot = 0;
+}
 
-int HID_API_EXPORT hid_read_timeout(hid_device *dev, unsigned char *data, size_t length, int milliseconds)
+static void uring_stop(void)
 {
-	int bytes_read;
+	if (uring.fd < 0)
+		return;
 
-	if (milliseconds != 0) {
-		/* milliseconds is -1 or > 0. In both cases, we want to
-		   call poll() and wait for data to arrive. -1 means
-		   INFINITE. */
-		int ret;
-		struct pollfd fds;
+	uring.stop = 1;
+	uring_wake();
+	pthread_join(uring.thread, NULL);
 
-		fds.fd = dev->device_handle;
-		fds.events = POLLIN;
-		fds.revents = 0;
-		ret = poll(&fds, 1, milliseconds);
-		if (ret == -1 || ret == 0)
-			/* Error or timeout */
-			return ret;
+	close(uring.wake_fd);
+	uring.wake_fd = -1;
+	uring.stop = 0;
+	uring_stop_mappings();
+}
+
+/* Set up multishot reads if the kernel has them (6.7), registering the
+   provided buffers. Returns 1 if it does and 0 if not. */
+static int uring_start_multishot(void)
+{
+	struct io_uring_probe *probe;
+	struct io_uring_buf_reg reg;
+	int supported, i;
+
+	probe = calloc(1, sizeof(*probe) + 256 * sizeof(struct io_uring_probe_op));
+	if (!probe)
+		return 0;
+	supported = io_uring_register(uring.fd, IORING_REGISTER_PROBE, probe, 256) == 0 &&
+	            probe->last_op >= URING_OP_READ_MULTISHOT &&
+	            (probe->ops[URING_OP_READ_MULTISHOT].flags & IO_URING_OP_SUPPORTED);
+	free(probe);
+	if (!supported)
+		return 0;
+
+	uring.buf_ring = mmap(NULL, URING_BUFFERS * sizeof(struct io_uring_buf), PROT_READ | PROT_WRITE,
+	                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (uring.buf_ring == MAP_FAILED)
+		return 0;
+	uring.buf_base = mmap(NULL, (size_t) URING_BUFFERS * URING_BUFFER_SIZE, PROT_READ | PROT_WRITE,
+	                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (uring.buf_base == MAP_FAILED) {
+		munmap(uring.buf_ring, URING_BUFFERS * sizeof(struct io_uring_buf));
+		return 0;
 	}
 
-	bytes_read = read(dev->device_handle, data, length);
-	if (bytes_read < 0 && errno == EAGAIN)
-		bytes_read = 0;
-	
-	if (bytes_read >= 0 &&
-	    kernel_version < KERNEL_VERSION(2,6,34) &&
-	    dev->uses_numbered_reports) {
-		/* Work around a kernel bug. Chop off the first byte. */
-		memmove(data, data+1, bytes_read);
-		bytes_read--;
+	memset(&reg, 0, sizeof(reg));
+	reg.ring_addr = (unsigned long) uring.buf_ring;
+	reg.ring_entries = URING_BUFFERS;
+	reg.bgid = URING_BUFFER_GROUP;
+	if (io_uring_register(uring.fd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+		munmap(uring.buf_base, (size_t) URING_BUFFERS * URING_BUFFER_SIZE);
+		munmap(uring.buf_ring, URING_BUFFERS * sizeof(struct io_uring_buf));
+		return 0;
 	}
 
-	return bytes_read;
+	uring.buf_tail = 0;
+	for (i = 0; i < URING_BUFFERS; i++)
+		uring_recycle_buffer(i);
+
+	return 1;
 }
 
-int HID_API_EXPORT hid_read(hid_device *dev, unsigned char *data, size_t length)
+/* Set up the ring and start its thread. Returns 0 on success and -1 if
+   io_uring is not available or lacks the features used. */
+static int uring_start(void)
+{
+	struct io_uring_params p;
+	int fd;
+
+	if (uring.fd >= 0)
+		return 0;
+
+	memset(&p, 0, sizeof(p));
+	fd = io_uring_setup(URING_ENTRIES, &p);
+	if (fd < 0)
+		return -1;
+
+	/* With FAST_POLL (5.7) a read which finds no report waits on
+	   poll and is retried, rather than blocking a worker thread. That
+	   needs a first attempt which can fail with -EAGAIN: hidraw has no
+	   FMODE_NOWAIT, so io_uring only makes one if the file is
+	   O_NONBLOCK, which uring_open() sets. IORING_OP_READ came in 5.6
+	   without a feature flag. */
+	if (!(p.features & IORING_FEAT_NODROP) ||
+	    !(p.features & IORING_FEAT_SINGLE_MMAP) ||
+	    !(p.features & IORING_FEAT_FAST_POLL)) {
+		close(fd);
+		return -1;
+	}
+
+	/* With SINGLE_MMAP (5.4) the CQ ring shares the SQ ring's
+	   mapping. */
+	uring.ring_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+	if (p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe) > uring.ring_size)
+		uring.ring_size = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+	uring.sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+
+	uring.ring = mmap(NULL, uring.ring_size, PROT_READ | PROT_WRITE,
+	                  MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+	if (uring.ring == MAP_FAILED) {
+		close(fd);
+		return -1;
+	}
+	uring.sqes = mmap(NULL, uring.sqes_size, PROT_READ | PROT_WRITE,
+	                  MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+	if (uring.sqes == MAP_FAILED) {
+		munmap(uring.ring, uring.ring_size);
+		close(fd);
+		return -1;
+	}
+
+	uring.sq_head = (unsigned *) ((char *) uring.ring + p.sq_off.head);
+	uring.sq_tail = (unsigned *) ((char *) uring.ring + p.sq_off.tail);
+	uring.sq_array = (unsigned *) ((char *) uring.ring + p.sq_off.array);
+	uring.sq_mask = *(unsigned *) ((char *) uring.ring + p.sq_off.ring_mask);
+	uring.sq_entries = p.sq_entries;
+	uring.sq_local_tail = *uring.sq_tail;
+	uring.cq_head = (unsigned *) ((char *) uring.ring + p.cq_off.head);
+	uring.cq_tail = (unsigned *) ((char *) uring.ring + p.cq_off.tail);
+	uring.cq_mask = *(unsigned *) ((char *) uring.ring + p.cq_off.ring_mask);
+	uring.cqes = (struct io_uring_cqe *) ((char *) uring.ring + p.cq_off.cqes);
+
+	uring.fd = fd;
+	uring.multishot = uring_start_multishot();
+	uring.wake_fd = eventfd(0, EFD_CLOEXEC);
+	if (uring.wake_fd < 0 ||
+	    pthread_create(&uring.thread, NULL, uring_thread, NULL) != 0) {
+		if (uring.wake_fd >= 0)
+			close(uring.wake_fd);
+		uring.wake_fd = -1;
+		uring_stop_mappings();
+		return -1;
+	}
+
+	return 0;
+}
+
+/* Start reading dev through the ring. Returns 0 on success and -1 on
+   error, in which case dev keeps using poll() and read(). */
+static int uring_open(hid_device *dev)
+{
+	struct uring_input *in;
+	int flags, i;
+
+	/* The reads must be nonblocking, see uring_start(). Without it,
+	   each one is handed to an io-wq worker which blocks in read(),
+	   and a multishot read gives a single report. hid_read() waits
+	   on the queue instead, so dev->blocking doesn't change. */
+	flags = fcntl(dev->device_handle, F_GETFL, 0);
+	if (flags < 0 || fcntl(dev->device_handle, F_SETFL, flags | O_NONBLOCK) < 0)
+		return -1;
+
+	in = calloc(1, sizeof(struct uring_input));
+	if (!in) {
+		fcntl(dev->device_handle, F_SETFL, flags);
+		return -1;
+	}
+
+	pthread_mutex_init(&in->mutex, NULL);
+	pthread_cond_init(&in->condition, NULL);
+	for (i = 0; i < URING_READS; i++) {
+		in->ops[i].dev = dev;
+		in->ops[i].index = i;
+	}
+	in->poll_fd = -1;
+	dev->uring = in;
+
+	/* Count the reads before posting them, without in->mutex: when
+	   the SQ is full, uring_get_sqe() waits for the engine thread,
+	   which may be completing the first of them. */
+	in->pending = uring.multishot? 1: URING_READS;
+	pthread_mutex_lock(&uring.sq_lock);
+	for (i = 0; i < in->pending; i++)
+		uring_post_read(dev, i);
+	pthread_mutex_unlock(&uring.sq_lock);
+	uring_wake();
+
+	return 0;
+}
+
+/* Cancel dev's reads and wait for the engine thread to give them back. */
+static void uring_close(hid_device *dev)
+{
+	struct uring_input *in = dev->uring;
+	struct io_uring_sqe *sqe;
+	int i, pending;
+
+	pthread_mutex_lock(&in->mutex);
+	if (in->reactor)
+		uring_reactor_remove(dev);
+	in->closing = 1;
+	pending = in->pending;
+	pthread_mutex_unlock(&in->mutex);
+
+	/* Queue the cancellations without in->mutex, which the engine
+	   thread needs to make room in a full SQ. A read completing
+	   meanwhile isn't reposted, and its cancellation just fails with
+	   -ENOENT. */
+	if (pending > 0) {
+		pthread_mutex_lock(&uring.sq_lock);
+		for (i = 0; i < (uring.multishot? 1: URING_READS); i++) {
+			sqe = uring_get_sqe();
+			sqe->opcode = IORING_OP_ASYNC_CANCEL;
+			sqe->addr = (unsigned long) &in->ops[i];
+		}
+		pthread_mutex_unlock(&uring.sq_lock);
+		uring_wake();
+	}
+
+	pthread_mutex_lock(&in->mutex);
+	while (in->pending > 0)
+		pthread_cond_wait(&in->condition, &in->mutex);
+	pthread_mutex_unlock(&in->mutex);
+
+	if (in->poll_fd >= 0)
+		close(in->poll_fd);
+	pthread_cond_destroy(&in->condition);
+	pthread_mutex_destroy(&in->mutex);
+	free(in);
+	dev->uring = NULL;
+}
+
+/* Take the oldest queued report. This should be called with
+   dev->uring->mutex locked and a report queued. */
+static int uring_return_data(hid_device *dev, unsigned char *data, size_t length)
+{
+	struct uring_input *in = dev->uring;
+	size_t len = in->report_len[in->head];
+	unsigned long long latency;
+
+	if (len > length)
+		len = length;
+	memcpy(data, in->reports[in->head], len);
+	latency = monotonic_ns() - in->report_time[in->head];
+	record_latency(dev, HID_LATENCY_INPUT, latency);
+	HID_PROBE3(report_dequeue, dev, len, latency);
+	in->head = (in->head + 1) % URING_QUEUE_SIZE;
+	in->count--;
+	if (in->count == 0)
+		uring_update_ready(dev);
+	return len;
+}
+
+/* Wait for a report to be queued. Returns 1 if a report is available,
+   0 on timeout and -1 on error or disconnection. This should be called
+   with dev->uring->mutex locked. */
+static int uring_wait(hid_device *dev, int milliseconds)
+{
+	struct uring_input *in = dev->uring;
+	struct timespec ts;
+	int res;
+
+	if (milliseconds > 0) {
+		clock_gettime(CLOCK_REALTIME, &ts);
+		ts.tv_sec += milliseconds / 1000;
+		ts.tv_nsec += (milliseconds % 1000) * 1000000;
+		if (ts.tv_nsec >= 1000000000L) {
+			ts.tv_sec++;
+			ts.tv_nsec -= 1000000000L;
+		}
+	}
+
+	while (in->count == 0) {
+		if (in->shutdown)
+			return -1;
+		if (milliseconds == 0)
+			return 0;
+		if (milliseconds < 0)
+			res = pthread_cond_wait(&in->condition, &in->mutex);
+		else
+			res = pthread_cond_timedwait(&in->condition, &in->mutex, &ts);
+		if (res == ETIMEDOUT) {
+			STAT_ADD(dev, read_timeouts, 1);
+			return 0;
+		}
+		else if (res != 0)
+			return -1;
+		STAT_ADD(dev, read_wakeups, 1);
+	}
+
+	return 1;
+}
+
+static int uring_read(hid_device *dev, unsigned char *data, size_t length, unsigned long long *sequence, unsigned long long *timestamp, int milliseconds)
+{
+	struct uring_input *in = dev->uring;
+	int res;
+
+	pthread_mutex_lock(&in->mutex);
+	res = uring_wait(dev, milliseconds);
+	if (res > 0) {
+		if (sequence)
+			*sequence = in->report_seq[in->head];
+		if (timestamp)
+			*timestamp = in->report_time[in->head];
+		res = uring_return_data(dev, data, length);
+	}
+	pthread_mutex_unlock(&in->mutex);
+
+	return res;
+}
+
+static int uring_read_many(hid_device *dev, unsigned char *data, size_t *length, int max_reports, int milliseconds)
+{
+	struct uring_input *in = dev->uring;
+	size_t used = 0;
+	int count = 0;
+	int res;
+
+	pthread_mutex_lock(&in->mutex);
+	res = uring_wait(dev, milliseconds);
+	while (res > 0 && in->count > 0 && count < max_reports) {
+		size_t len = in->report_len[in->head];
+		/* The first report is truncated if it doesn't fit,
+		   like hid_read(); the rest are only taken whole. */
+		if (count > 0 && used + 2 + len > *length)
+			break;
+		len = uring_return_data(dev, data + used + 2, *length - used - 2);
+		data[used] = len & 0xff;
+		data[used+1] = (len >> 8) & 0xff;
+		used += 2 + len;
+		count++;
+	}
+	pthread_mutex_unlock(&in->mutex);
+
+	*length = used;
+	return (count > 0)? count: res;
+}
+
+static int uring_get_poll_fd(hid_device *dev)
+{
+	struct uring_input *in = dev->uring;
+	int fd;
+
+	pthread_mutex_lock(&in->mutex);
+	if (in->poll_fd < 0) {
+		in->poll_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+		in->poll_signalled = 0;
+		uring_update_ready(dev);
+	}
+	fd = in->poll_fd;
+	pthread_mutex_unlock(&in->mutex);
+
+	return fd;
+}
+#endif /* HAVE_IO_URING */
+
+int HID_API_EXPORT hid_init(void)
+{
+	const char *locale;
+
+	/* Set the locale if it's not set. */
+	locale = setlocale(LC_CTYPE, NULL);
+	if (!locale)
+		setlocale(LC_CTYPE, "");
+
+	return 0;
+}
+
+int HID_API_EXPORT hid_exit(void)
+{
+#ifdef HAVE_IO_URING
+	pthread_mutex_lock(&io_engine_mutex);
+	uring_stop();
+	io_engine = HID_IO_ENGINE_DEFAULT;
+	pthread_mutex_unlock(&io_engine_mutex);
+#endif
+	return 0;
+}
+
+int HID_API_EXPORT hid_set_io_engine(int engine)
+{
+	int res = -1;
+
+	pthread_mutex_lock(&io_engine_mutex);
+	if (engine == HID_IO_ENGINE_DEFAULT)
+		res = 0;
+#ifdef HAVE_IO_URING
+	else if (engine == HID_IO_ENGINE_IO_URING)
+		res = uring_start();
+#endif
+	if (res == 0)
+		io_engine = engine;
+	pthread_mutex_unlock(&io_engine_mutex);
+
+	return res;
+}
+
+int HID_API_EXPORT hid_set_backend(const char *name)
+{
+	/* This is the only implementation in the library. */
+	return (name && strcmp(name, "hidraw") == 0)? 0: -1;
+}
+
+HID_API_EXPORT const char * HID_API_CALL hid_get_backend(void)
+{
+	return "hidraw";
+}
+
+int HID_API_EXPORT hid_enumerate_backend(const char *backend, unsigned short vendor_id, unsigned short product_id, struct hid_device_info **devs)
+{
+	*devs = NULL;
+	if (backend && strcmp(backend, hid_get_backend()) != 0)
+		return -1;
+	*devs = hid_enumerate(vendor_id, product_id);
+	return 0;
+}
+
+hid_device * HID_API_EXPORT hid_open_path_backend(const char *backend, const char *path)
+{
+	if (backend && strcmp(backend, hid_get_backend()) != 0)
+		return NULL;
+	return hid_open_path(path);
+}
+
+HID_API_EXPORT const char * HID_API_CALL hid_get_device_backend(hid_device *dev)
+{
+	return hid_get_backend();
+}
+
+hid_reactor * HID_API_EXPORT hid_reactor_create_backend(const char *backend)
+{
+	if (backend && strcmp(backend, hid_get_backend()) != 0)
+		return NULL;
+	return hid_reactor_create();
+}
+
+
+/* Describe the device of a hidraw node, or return NULL if it isn't one
+   we know how to handle or if it doesn't match the VID/PID (0x0, 0x0
+   matching any). */
+static struct hid_device_info *create_device_info(struct udev_device *raw_dev, unsigned short vendor_id, unsigned short product_id)
+{
+	struct hid_device_info *cur_dev = NULL;
+	const char *dev_path;
+	const char *str;
+	struct udev_device *hid_dev; // The device's HID udev node.
+	struct udev_device *usb_dev; // The device's USB udev node.
+	struct udev_device *intf_dev; // The device's interface (in the USB sense).
+	unsigned short dev_vid;
+	unsigned short dev_pid;
+	char *serial_number_utf8 = NULL;
+	char *product_name_utf8 = NULL;
+	int bus_type;
+	int result;
+
+	dev_path = udev_device_get_devnode(raw_dev);
+
+	hid_dev = udev_device_get_parent_with_subsystem_devtype(
+		raw_dev,
+		"hid",
+		NULL);
+
+	if (!hid_dev) {
+		/* Unable to find parent hid device. */
+		goto end;
+	}
+
+	result = parse_uevent_info(
+		udev_device_get_sysattr_value(hid_dev, "uevent"),
+		&bus_type,
+		&dev_vid,
+		&dev_pid,
+		&serial_number_utf8,
+		&product_name_utf8);
+
+	if (!result) {
+		/* parse_uevent_info() failed for at least one field. */
+		goto end;
+	}
+
+	if (bus_type != BUS_USB && bus_type != BUS_BLUETOOTH &&
+	    bus_type != BUS_VIRTUAL) {
+		/* We only know how to handle USB, BT and virtual devices. */
+		goto end;
+	}
+
+	/* Check the VID/PID against the arguments */
+	if ((vendor_id != 0x0 || product_id != 0x0) &&
+	    (vendor_id != dev_vid || product_id != dev_pid))
+		goto end;
+
+	/* VID/PID match. Create the record. */
+	cur_dev = calloc(1, sizeof(struct hid_device_info));
+	if (!cur_dev)
+		goto end;
+
+	/* Fill out the record */
+	cur_dev->next = NULL;
+	cur_dev->backend = hid_get_backend();
+	cur_dev->path = dev_path? strdup(dev_path): NULL;
+
+	/* VID/PID */
+	cur_dev->vendor_id = dev_vid;
+	cur_dev->product_id = dev_pid;
+
+	/* Serial Number */
+	cur_dev->serial_number = utf8_to_wchar_t(serial_number_utf8);
+
+	/* Release Number */
+	cur_dev->release_number = 0x0;
+
+	/* Interface Number */
+	cur_dev->interface_number = -1;
+
+	switch (bus_type) {
+		case BUS_USB:
+			/* The device pointed to by raw_dev contains information about
+			   the hidraw device. In order to get information about the
+			   USB device, get the parent device with the
+			   subsystem/devtype pair of "usb"/"usb_device". This will
+			   be several levels up the tree, but the function will find
+			   it. */
+			usb_dev = udev_device_get_parent_with_subsystem_devtype(
+					raw_dev,
+					"usb",
+					"usb_device");
+
+			if (!usb_dev) {
+				/* Free this device */
+				free(cur_dev->serial_number);
+				free(cur_dev->path);
+				free(cur_dev);
+				cur_dev = NULL;
+				goto end;
+			}
+
+			/* Manufacturer and Product strings */
+			cur_dev->manufacturer_string = copy_udev_string(usb_dev, device_string_names[DEVICE_STRING_MANUFACTURER]);
+			cur_dev->product_string = copy_udev_string(usb_dev, device_string_names[DEVICE_STRING_PRODUCT]);
+
+			/* Release Number */
+			str = udev_device_get_sysattr_value(usb_dev, "bcdDevice");
+			cur_dev->release_number = (str)? strtol(str, NULL, 16): 0x0;
+
+			/* Get a handle to the interface's udev node. */
+			intf_dev = udev_device_get_parent_with_subsystem_devtype(
+					raw_dev,
+					"usb",
+					"usb_interface");
+			if (intf_dev) {
+				str = udev_device_get_sysattr_value(intf_dev, "bInterfaceNumber");
+				cur_dev->interface_number = (str)? strtol(str, NULL, 16): -1;
+			}
+
+			break;
+
+		case BUS_BLUETOOTH:
+		case BUS_VIRTUAL:
+			/* Manufacturer and Product strings */
+			cur_dev->manufacturer_string = wcsdup(L"");
+			cur_dev->product_string = utf8_to_wchar_t(product_name_utf8);
+
+			break;
+
+		default:
+			/* Unknown device type - this should never happen, as we
+			 * check for USB, Bluetooth and virtual devices above */
+			break;
+	}
+
+end:
+	free(serial_number_utf8);
+	free(product_name_utf8);
+	/* hid_dev, usb_dev and intf_dev don't need to be (and can't be)
+	   unref()d.  It will cause a double-free() error.  I'm not
+	   sure why.  */
+	return cur_dev;
+}
+
+struct hid_device_info  HID_API_EXPORT *hid_enumerate(unsigned short vendor_id, unsigned short product_id)
+{
+	struct udev *udev;
+	struct udev_enumerate *enumerate;
+	struct udev_list_entry *devices, *dev_list_entry;
+	
+	struct hid_device_info *root = NULL; // return object
+	struct hid_device_info *cur_dev = NULL;
+	int count = 0;
+
+	hid_init();
+	HID_PROBE2(enumerate_entry, vendor_id, product_id);
+
+	/* Create the udev object */
+	udev = udev_new();
+	if (!udev) {
+		printf("Can't create udev\n");
+		return NULL;
+	}
+
+	/* Create a list of the devices in the 'hidraw' subsystem. */
+	enumerate = udev_enumerate_new(udev);
+	udev_enumerate_add_match_subsystem(enumerate, "hidraw");
+	udev_enumerate_scan_devices(enumerate);
+	devices = udev_enumerate_get_list_entry(enumerate);
+	/* For each item, see if it matches the vid/pid, and if so
+	   create a record for it */
+	udev_list_entry_foreach(dev_list_entry, devices) {
+		const char *sysfs_path;
+		struct udev_device *raw_dev; // The device's hidraw udev node.
+		struct hid_device_info *tmp;
+
+		/* Get the filename of the /sys entry for the device
+		   and create a udev_device object (dev) representing it */
+		sysfs_path = udev_list_entry_get_name(dev_list_entry);
+		raw_dev = udev_device_new_from_syspath(udev, sysfs_path);
+
+		tmp = create_device_info(raw_dev, vendor_id, product_id);
+		if (tmp) {
+			if (cur_dev) {
+				cur_dev->next = tmp;
+			}
+			else {
+				root = tmp;
+			}
+			cur_dev = tmp;
+			count++;
+		}
+
+		udev_device_unref(raw_dev);
+	}
+	/* Free the enumerator and udev objects. */
+	udev_enumerate_unref(enumerate);
+	udev_unref(udev);
+	
+	HID_PROBE3(enumerate_return, vendor_id, product_id, count);
+	return root;
+}
+
+void  HID_API_EXPORT hid_free_enumeration(struct hid_device_info *devs)
+{
+	struct hid_device_info *d = devs;
+	while (d) {
+		struct hid_device_info *next = d->next;
+		free(d->path);
+		free(d->serial_number);
+		free(d->manufacturer_string);
+		free(d->product_string);
+		free(d);
+		d = next;
+	}
+}
+
+hid_device * hid_open(unsigned short vendor_id, unsigned short product_id, const wchar_t *serial_number)
+{
+	struct hid_device_info *devs, *cur_dev;
+	const char *path_to_open = NULL;
+	hid_device *handle = NULL;
+	
+	devs = hid_enumerate(vendor_id, product_id);
+	cur_dev = devs;
+	while (cur_dev) {
+		if (cur_dev->vendor_id == vendor_id &&
+		    cur_dev->product_id == product_id) {
+			if (serial_number) {
+				if (wcscmp(serial_number, cur_dev->serial_number) == 0) {
+					path_to_open = cur_dev->path;
+					break;
+				}
+			}
+			else {
+				path_to_open = cur_dev->path;
+				break;
+			}
+		}
+		cur_dev = cur_dev->next;
+	}
+
+	if (path_to_open) {
+		/* Open the device */
+		handle = hid_open_path(path_to_open);
+	}
+
+	hid_free_enumeration(devs);
+	
+	return handle;
+}
+
+hid_device * HID_API_EXPORT hid_open_path(const char *path)
+{
+	hid_device *dev = NULL;
+
+	hid_init();
+
+	dev = new_hid_device();
+
+	if (kernel_version == 0) {
+		struct utsname name;
+		int major, minor, release;
+		int ret;
+		uname(&name);
+		ret = sscanf(name.release, "%d.%d.%d", &major, &minor, &release);
+		if (ret == 3) {
+			kernel_version = major << 16 | minor << 8 | release;
+			//printf("Kernel Version: %d\n", kernel_version);
+		}
+		else {
+			printf("Couldn't sscanf() version string %s\n", name.release);
+		}
+	}
+
+	// OPEN HERE //
+	dev->device_handle = open(path, O_RDWR);
+
+	// If we have a good handle, return it.
+	if (dev->device_handle > 0) {
+
+		/* Get the report descriptor */
+		int res, desc_size = 0;
+		struct hidraw_report_descriptor rpt_desc;
+
+		memset(&rpt_desc, 0x0, sizeof(rpt_desc));
+
+		/* Get Report Descriptor Size */
+		res = ioctl(dev->device_handle, HIDIOCGRDESCSIZE, &desc_size);
+		if (res < 0)
+			perror("HIDIOCGRDESCSIZE");
+
+
+		/* Get Report Descriptor */
+		rpt_desc.size = desc_size;
+		res = ioctl(dev->device_handle, HIDIOCGRDESC, &rpt_desc);
+		if (res < 0) {
+			perror("HIDIOCGRDESC");
+		} else {
+			/* Determine if this device uses numbered reports. */
+			dev->uses_numbered_reports =
+				uses_numbered_reports(rpt_desc.value,
+				                      rpt_desc.size);
+		}
+
+#ifdef HAVE_IO_URING
+		/* Fall back to poll() and read() if this fails. */
+		pthread_mutex_lock(&io_engine_mutex);
+		if (io_engine == HID_IO_ENGINE_IO_URING)
+			uring_open(dev);
+		pthread_mutex_unlock(&io_engine_mutex);
+#endif
+		
+		HID_PROBE2(device_open, dev, path);
+		return dev;
+	}
+	else {
+		// Unable to open any devices.
+		free(dev);
+		HID_PROBE2(device_open, NULL, path);
+		return NULL;
+	}
+}
+
+
+int HID_API_EXPORT hid_write(hid_device *dev, const unsigned char *data, size_t length)
+{
+	int bytes_written;
+	unsigned long long start, elapsed;
+
+	HID_PROBE3(write_entry, dev, data[0], length);
+	start = monotonic_ns();
+	bytes_written = write(dev->device_handle, data, length);
+	elapsed = monotonic_ns() - start;
+	HID_PROBE2(write_return, dev, bytes_written);
+
+	if (bytes_written < 0) {
+		STAT_ADD(dev, transfer_errors, 1);
+	}
+	else {
+		STAT_ADD(dev, writes, 1);
+		STAT_ADD(dev, bytes_out, bytes_written);
+		STAT_ADD(dev, write_time_total, elapsed);
+		stat_max(&dev->stats.write_time_max, elapsed);
+		record_latency(dev, HID_LATENCY_WRITE, elapsed);
+	}
+
+	return bytes_written;
+}
+
+
+/* read() a report from the device. Returns -1 with errno set on error. */
+static int read_report(hid_device *dev, unsigned char *data, size_t length)
+{
+	int bytes_read = read(dev->device_handle, data, length);
+
+	if (bytes_read >= 0 &&
+	    kernel_version < KERNEL_VERSION(2,6,34) &&
+	    dev->uses_numbered_reports) {
+		/* Work around a kernel bug. Chop off the first byte. */
+		memmove(data, data+1, bytes_read);
+		bytes_read--;
+	}
+
+	return bytes_read;
+}
+
+int HID_API_EXPORT hid_read_timeout(hid_device *dev, unsigned char *data, size_t length, int milliseconds)
+{
+	return hid_read_sequenced(dev, data, length, NULL, NULL, milliseconds);
+}
+
+int HID_API_EXPORT hid_read_timestamped(hid_device *dev, unsigned char *data, size_t length, unsigned long long *timestamp, int milliseconds)
+{
+	return hid_read_sequenced(dev, data, length, NULL, timestamp, milliseconds);
+}
+
+int HID_API_EXPORT hid_read_sequenced(hid_device *dev, unsigned char *data, size_t length, unsigned long long *sequence, unsigned long long *timestamp, int milliseconds)
+{
+	int bytes_read;
+
+	/* Reports go to the application's ring instead. */
+	if (dev->shared_ring)
+		return -1;
+
+#ifdef HAVE_IO_URING
+	if (dev->uring)
+		return uring_read(dev, data, length, sequence, timestamp, milliseconds);
+#endif
+
+	if (milliseconds != 0) {
+		/* milliseconds is -1 or > 0. In both cases, we want to
+		   call poll() and wait for data to arrive. -1 means
+		   INFINITE. */
+		int ret;
+		struct pollfd fds;
+
+		fds.fd = dev->device_handle;
+		fds.events = POLLIN;
+		fds.revents = 0;
+		ret = poll(&fds, 1, milliseconds);
+		if (ret == 0)
+			STAT_ADD(dev, read_timeouts, 1);
+		else if (ret > 0)
+			STAT_ADD(dev, read_wakeups, 1);
+		if (ret == -1 || ret == 0)
+			/* Error or timeout */
+			return ret;
+	}
+
+	bytes_read = read_report(dev, data, length);
+	if (bytes_read < 0 && errno == EAGAIN)
+		bytes_read = 0;
+	else if (bytes_read < 0)
+		STAT_ADD(dev, transfer_errors, 1);
+	else {
+		/* hidraw doesn't say when a report arrived or how many it
+		   dropped, so this numbers and times the read. Use the
+		   io_uring engine for the arrival time. */
+		unsigned long long n = take_sequence(dev);
+		count_received(dev, bytes_read);
+		if (sequence)
+			*sequence = n;
+		if (timestamp)
+			*timestamp = monotonic_ns();
+	}
+
+	return bytes_read;
+}
+
+int HID_API_EXPORT hid_get_dropped_count(hid_device *dev, unsigned long long *count)
+{
+	*count = __atomic_load_n(&dev->stats.reports_dropped, __ATOMIC_RELAXED);
+	return 0;
+}
+
+int HID_API_EXPORT hid_get_stats(hid_device *dev, struct hid_device_stats *stats)
+{
+	/* Every field is a counter of the same type. */
+	const unsigned long long *src = (const unsigned long long*) &dev->stats;
+	unsigned long long *dst = (unsigned long long*) stats;
+	size_t i;
+
+	for (i = 0; i < sizeof(*stats) / sizeof(*dst); i++)
+		dst[i] = __atomic_load_n(&src[i], __ATOMIC_RELAXED);
+
+	return 0;
+}
+
+int HID_API_EXPORT hid_get_latency_histogram(hid_device *dev, int kind, struct hid_histogram *histogram, int reset)
+{
+	struct hid_histogram *h;
+	int i;
+
+	if (kind < HID_LATENCY_INPUT || kind > HID_LATENCY_FEATURE)
+		return -1;
+	h = &dev->latency[kind];
+
+	histogram->count = 0;
+	for (i = 0; i < HID_HISTOGRAM_BUCKETS; i++) {
+		histogram->counts[i] = reset
+			? __atomic_exchange_n(&h->counts[i], 0, __ATOMIC_RELAXED)
+			: __atomic_load_n(&h->counts[i], __ATOMIC_RELAXED);
+		histogram->count += histogram->counts[i];
+	}
+	histogram->total = reset
+		? __atomic_exchange_n(&h->total, 0, __ATOMIC_RELAXED)
+		: __atomic_load_n(&h->total, __ATOMIC_RELAXED);
+	histogram->max = reset
+		? __atomic_exchange_n(&h->max, 0, __ATOMIC_RELAXED)
+		: __atomic_load_n(&h->max, __ATOMIC_RELAXED);
+
+	return 0;
+}
+
+int HID_API_EXPORT hid_read_many(hid_device *dev, unsigned char *data, size_t *length, int max_reports, int milliseconds)
+{
+	size_t used = 0;
+	size_t largest = 0;
+	int count = 0;
+	int res;
+
+	if (*length < 3 || max_reports < 1 || dev->shared_ring)
+		return -1;
+
+#ifdef HAVE_IO_URING
+	if (dev->uring)
+		return uring_read_many(dev, data, length, max_reports, milliseconds);
+#endif
+
+	res = hid_read_timeout(dev, data + 2, *length - 2, milliseconds);
+	while (res > 0) {
+		struct pollfd fds;
+
+		data[used] = res & 0xff;
+		data[used+1] = (res >> 8) & 0xff;
+		used += 2 + res;
+		count++;
+
+		/* The kernel drops whatever doesn't fit in the read() buffer,
+		   so only go on while there is room for the largest report
+		   seen so far. */
+		if ((size_t) res > largest)
+			largest = res;
+		if (count == max_reports || used + 2 + largest > *length)
+			break;
+
+		/* Only take reports the kernel has already queued. */
+		fds.fd = dev->device_handle;
+		fds.events = POLLIN;
+		fds.revents = 0;
+		if (poll(&fds, 1, 0) <= 0)
+			break;
+		res = hid_read_timeout(dev, data + used + 2, *length - used - 2, 0);
+	}
+
+	*length = used;
+	return count > 0? count: res;
+}
+
+int HID_API_EXPORT hid_get_poll_fd(hid_device *dev)
+{
+#ifdef HAVE_IO_URING
+	/* The ring reads the device, so it's ready when it has queued
+	   a report. */
+	if (dev->uring)
+		return uring_get_poll_fd(dev);
+#endif
+	return dev->device_handle;
+}
+
+hid_reactor * HID_API_EXPORT hid_reactor_create(void)
+{
+	struct epoll_event ev;
+	hid_reactor *reactor = calloc(1, sizeof(hid_reactor));
+	if (!reactor)
+		return NULL;
+	HID_BACKEND_INIT(reactor);
+
+	reactor->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	if (reactor->epoll_fd < 0) {
+		free(reactor);
+		return NULL;
+	}
+
+	reactor->ready_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	memset(&ev, 0, sizeof(ev));
+	ev.events = EPOLLIN;
+	ev.data.ptr = reactor;
+	if (reactor->ready_fd < 0 ||
+	    epoll_ctl(reactor->epoll_fd, EPOLL_CTL_ADD, reactor->ready_fd, &ev) < 0) {
+		if (reactor->ready_fd >= 0)
+			close(reactor->ready_fd);
+		close(reactor->epoll_fd);
+		free(reactor);
+		return NULL;
+	}
+	pthread_mutex_init(&reactor->mutex, NULL);
+
+	return reactor;
+}
+
+int HID_API_EXPORT hid_reactor_add(hid_reactor *reactor, hid_device *dev)
+{
+	struct epoll_event ev;
+
+#ifdef HAVE_IO_URING
+	if (dev->uring) {
+		struct uring_input *in = dev->uring;
+		int res = -1;
+
+		/* It can only be on one ready list. */
+		pthread_mutex_lock(&in->mutex);
+		if (!in->reactor) {
+			uring_reactor_add(reactor, dev);
+			res = 0;
+		}
+		pthread_mutex_unlock(&in->mutex);
+		return res;
+	}
+#endif
+
+	/* Level-triggered, so a device stays ready until it's read. */
+	memset(&ev, 0, sizeof(ev));
+	ev.events = EPOLLIN;
+	ev.data.ptr = dev;
+	return epoll_ctl(reactor->epoll_fd, EPOLL_CTL_ADD, dev->device_handle, &ev);
+}
+
+int HID_API_EXPORT hid_reactor_remove(hid_reactor *reactor, hid_device *dev)
+{
+	struct epoll_event ev;
+
+#ifdef HAVE_IO_URING
+	if (dev->uring) {
+		struct uring_input *in = dev->uring;
+		int res = -1;
+
+		pthread_mutex_lock(&in->mutex);
+		if (in->reactor == reactor) {
+			uring_reactor_remove(dev);
+			res = 0;
+		}
+		pthread_mutex_unlock(&in->mutex);
+		return res;
+	}
+#endif
+
+	/* Kernels before 2.6.9 require a non-NULL event. */
+	memset(&ev, 0, sizeof(ev));
+	return epoll_ctl(reactor->epoll_fd, EPOLL_CTL_DEL, dev->device_handle, &ev);
+}
+
+int HID_API_EXPORT hid_reactor_wait(hid_reactor *reactor, hid_device **ready, int max_ready, int milliseconds)
+{
+	struct epoll_event events[REACTOR_MAX_EVENTS];
+	int i, res, count = 0;
+
+	if (max_ready < 1)
+		return -1;
+	if (max_ready > REACTOR_MAX_EVENTS)
+		max_ready = REACTOR_MAX_EVENTS;
+
+	/* EPOLLHUP and EPOLLERR are always reported, so disconnected
+	   devices are returned too. */
+	res = epoll_wait(reactor->epoll_fd, events, max_ready, milliseconds);
+	if (res < 0)
+		return (errno == EINTR)? 0: -1;
+
+	/* The reactor's own event is for the ready list. */
+	for (i = 0; i < res; i++) {
+		if (events[i].data.ptr != reactor)
+			ready[count++] = events[i].data.ptr;
+	}
+
+#ifdef HAVE_IO_URING
+	if (count < max_ready)
+		count += uring_reactor_collect(reactor, ready + count, max_ready - count);
+#endif
+
+	return count;
+}
+
+void HID_API_EXPORT hid_reactor_destroy(hid_reactor *reactor)
+{
+	if (!reactor)
+		return;
+
+#ifdef HAVE_IO_URING
+	/* Take out the devices read by the io_uring engine, and make sure
+	   the engine thread won't wake the reactor anymore. */
+	for (;;) {
+		hid_device *dev;
+		pthread_mutex_lock(&reactor->mutex);
+		dev = reactor->members;
+		pthread_mutex_unlock(&reactor->mutex);
+		if (!dev)
+			break;
+		hid_reactor_remove(reactor, dev);
+	}
+	pthread_mutex_lock(&uring.sq_lock);
+	if (reactor->wake_queued) {
+		hid_reactor **link;
+		for (link = &uring.wake_list; *link != reactor; link = &(*link)->wake_next)
+			;
+		*link = reactor->wake_next;
+	}
+	pthread_mutex_unlock(&uring.sq_lock);
+#endif
+
+	pthread_mutex_destroy(&reactor->mutex);
+	close(reactor->ready_fd);
+	close(reactor->epoll_fd);
+	free(reactor);
+}
+
+struct hid_hotplug_ {
+	HID_BACKEND_HEADER
+	struct udev *udev;
+	struct udev_monitor *monitor;
+	unsigned short vendor_id;
+	unsigned short product_id;
+	/* The matching devices present, as they were when they arrived,
+	   to describe them when they leave. */
+	struct hid_device_info *devices;
+};
+
+static struct hid_device_info *copy_device_info(const struct hid_device_info *info)
+{
+	struct hid_device_info *copy = malloc(sizeof(struct hid_device_info));
+	if (!copy)
+		return NULL;
+
+	*copy = *info;
+	copy->next = NULL;
+	copy->path = info->path? strdup(info->path): NULL;
+	copy->serial_number = info->serial_number? wcsdup(info->serial_number): NULL;
+	copy->manufacturer_string = info->manufacturer_string? wcsdup(info->manufacturer_string): NULL;
+	copy->product_string = info->product_string? wcsdup(info->product_string): NULL;
+
+	return copy;
+}
+
+/* Returns the link to the listed device with this path, or NULL. */
+static struct hid_device_info **find_hotplug_device(hid_hotplug *hotplug, const char *path)
+{
+	struct hid_device_info **link;
+	for (link = &hotplug->devices; *link; link = &(*link)->next) {
+		if ((*link)->path && strcmp((*link)->path, path) == 0)
+			return link;
+	}
+	return NULL;
+}
+
+hid_hotplug * HID_API_EXPORT hid_hotplug_create(unsigned short vendor_id, unsigned short product_id)
+{
+	hid_hotplug *hotplug = calloc(1, sizeof(hid_hotplug));
+	if (!hotplug)
+		return NULL;
+	HID_BACKEND_INIT(hotplug);
+	hotplug->vendor_id = vendor_id;
+	hotplug->product_id = product_id;
+
+	/* Events from udev rather than the kernel, so that the node has
+	   its permissions by the time it is reported. */
+	hotplug->udev = udev_new();
+	if (hotplug->udev)
+		hotplug->monitor = udev_monitor_new_from_netlink(hotplug->udev, "udev");
+	if (!hotplug->monitor ||
+	    udev_monitor_filter_add_match_subsystem_devtype(hotplug->monitor, "hidraw", NULL) < 0 ||
+	    udev_monitor_enable_receiving(hotplug->monitor) < 0) {
+		hid_hotplug_destroy(hotplug);
+		return NULL;
+	}
+
+	/* Listed once the monitor is receiving, so no device is missed in
+	   between. One seen by both is only reported once. */
+	hotplug->devices = hid_enumerate(vendor_id, product_id);
+
+	return hotplug;
+}
+
+int HID_API_EXPORT hid_hotplug_wait(hid_hotplug *hotplug, struct hid_device_info **device, int milliseconds)
+{
+	unsigned long long deadline = monotonic_ns() + milliseconds * 1000000ULL;
+	int event = 0;
+
+	*device = NULL;
+	while (!event) {
+		struct pollfd fds;
+		struct udev_device *raw_dev;
+		struct hid_device_info **link;
+		const char *action;
+		const char *path;
+		int timeout = milliseconds;
+		int res;
+
+		if (milliseconds > 0) {
+			unsigned long long now = monotonic_ns();
+			timeout = (now < deadline)? (int) ((deadline - now + 999999) / 1000000): 0;
+		}
+
+		fds.fd = udev_monitor_get_fd(hotplug->monitor);
+		fds.events = POLLIN;
+		fds.revents = 0;
+		res = poll(&fds, 1, timeout);
+		if (res < 0)
+			return (errno == EINTR)? 0: -1;
+		if (res == 0)
+			return 0;
+
+		raw_dev = udev_monitor_receive_device(hotplug->monitor);
+		if (!raw_dev)
+			continue;
+
+		action = udev_device_get_action(raw_dev);
+		path = udev_device_get_devnode(raw_dev);
+		if (action && path) {
+			link = find_hotplug_device(hotplug, path);
+			if (strcmp(action, "add") == 0 && !link) {
+				struct hid_device_info *info = create_device_info(raw_dev, hotplug->vendor_id, hotplug->product_id);
+				if (info) {
+					*device = copy_device_info(info);
+					info->next = hotplug->devices;
+					hotplug->devices = info;
+					event = HID_HOTPLUG_ARRIVED;
+				}
+			}
+			else if (strcmp(action, "remove") == 0 && link) {
+				/* The node is gone from sysfs, so it is described
+				   from the list. */
+				*device = *link;
+				*link = (*device)->next;
+				(*device)->next = NULL;
+				event = HID_HOTPLUG_LEFT;
+			}
+		}
+		udev_device_unref(raw_dev);
+	}
+
+	return (*device)? event: -1;
+}
+
+void HID_API_EXPORT hid_hotplug_destroy(hid_hotplug *hotplug)
+{
+	if (!hotplug)
+		return;
+	hid_free_enumeration(hotplug->devices);
+	if (hotplug->monitor)
+		udev_monitor_unref(hotplug->monitor);
+	if (hotplug->udev)
+		udev_unref(hotplug->udev);
+	free(hotplug);
+}
+
+int HID_API_EXPORT hid_read(hid_device *dev, unsigned char *data, size_t length)
 {
 	return hid_read_timeout(dev, data, length, (dev->blocking)? -1: 0);
 }
@@ -711,6 +2172,12 @@ int HID_API_EXPORT hid_set_nonblocking(hid_device *dev, int nonblock)
 {
 	int flags, res;
 
+	/* The ring reads the device; hid_read() waits on its queue. */
+	if (dev->uring) {
+		dev->blocking = !nonblock;
+		return 0;
+	}
+
 	flags = fcntl(dev->device_handle, F_GETFL, 0);
 	if (flags >= 0) {
 		if (nonblock)
@@ -731,13 +2198,161 @@ int HID_API_EXPORT hid_set_nonblocking(hid_device *dev, int nonblock)
 }
 
 
+int HID_API_EXPORT hid_set_input_queue(hid_device *dev, int capacity, int policy)
+{
+	/* The kernel queues hidraw reports itself; its buffer is not tunable. */
+	return -1;
+}
+
+int HID_API_EXPORT hid_set_input_transfers(hid_device *dev, int count)
+{
+	/* Not supported on this platform. */
+	return -1;
+}
+
+/* Moves the reports of a device which has an input ring, and isn't
+   read by the io_uring engine, into the ring until ring_stop_fd
+   becomes readable. */
+static void *ring_thread(void *param)
+{
+	hid_device *dev = param;
+	struct hid_input_ring *ring = dev->shared_ring;
+	unsigned char buf[RING_READ_SIZE];
+	struct pollfd fds[2];
+	int res;
+
+	fds[0].fd = dev->device_handle;
+	fds[0].events = POLLIN;
+	fds[1].fd = dev->ring_stop_fd;
+	fds[1].events = POLLIN;
+
+	for (;;) {
+		res = poll(fds, 2, -1);
+		if (res < 0 && errno == EINTR)
+			continue;
+		if (res < 0 || fds[1].revents)
+			break;
+
+		res = read_report(dev, buf, sizeof(buf));
+		if (res >= 0) {
+			count_received(dev, res);
+			if (ring_push(ring, buf, res, take_sequence(dev), monotonic_ns()) < 0)
+				count_dropped(dev);
+		}
+		else if (errno != EAGAIN && errno != EINTR) {
+			/* This means the device has been disconnected. */
+			STAT_ADD(dev, transfer_errors, 1);
+			ring_fail(ring);
+			break;
+		}
+	}
+
+	return NULL;
+}
+
+/* Stop writing to the device's input ring, if it has one. */
+static void detach_ring(hid_device *dev)
+{
+	struct hid_input_ring *ring = dev->shared_ring;
+
+	if (!ring)
+		return;
+
+#ifdef HAVE_IO_URING
+	if (dev->uring) {
+		pthread_mutex_lock(&dev->uring->mutex);
+		dev->shared_ring = NULL;
+		pthread_mutex_unlock(&dev->uring->mutex);
+		ring_fail(ring);
+		return;
+	}
+#endif
+
+	eventfd_write(dev->ring_stop_fd, 1);
+	pthread_join(dev->ring_thread, NULL);
+	close(dev->ring_stop_fd);
+	dev->shared_ring = NULL;
+	ring_fail(ring);
+}
+
+int HID_API_EXPORT hid_set_input_ring(hid_device *dev, struct hid_input_ring *ring, size_t size)
+{
+	size_t capacity = 0;
+
+	if (ring && (capacity = ring_capacity(ring, size)) == 0)
+		return -1;
+
+	detach_ring(dev);
+	if (!ring)
+		return 0;
+	ring_init(ring, capacity);
+
+#ifdef HAVE_IO_URING
+	if (dev->uring) {
+		/* The engine thread writes the ring. The reports already
+		   queued go first. */
+		struct uring_input *in = dev->uring;
+
+		pthread_mutex_lock(&in->mutex);
+		dev->shared_ring = ring;
+		while (in->count > 0) {
+			if (ring_push(ring, in->reports[in->head], in->report_len[in->head], in->report_seq[in->head], in->report_time[in->head]) < 0)
+				count_dropped(dev);
+			in->head = (in->head + 1) % URING_QUEUE_SIZE;
+			in->count--;
+		}
+		if (in->shutdown)
+			ring_fail(ring);
+		uring_update_ready(dev);
+		pthread_mutex_unlock(&in->mutex);
+		return 0;
+	}
+#endif
+
+	dev->ring_stop_fd = eventfd(0, EFD_CLOEXEC);
+	if (dev->ring_stop_fd < 0)
+		return -1;
+	dev->shared_ring = ring;
+	if (pthread_create(&dev->ring_thread, NULL, ring_thread, dev) != 0) {
+		dev->shared_ring = NULL;
+		close(dev->ring_stop_fd);
+		return -1;
+	}
+
+	return 0;
+}
+
+int HID_API_EXPORT hid_input_ring_wait(hid_device *dev, int milliseconds)
+{
+	struct hid_input_ring *ring = dev->shared_ring;
+
+	if (!ring)
+		return -1;
+	return ring_wait(ring, milliseconds);
+}
+
+int HID_API_EXPORT hid_input_ring_read(hid_device *dev, unsigned char *data, size_t length, unsigned long long *timestamp, int milliseconds)
+{
+	struct hid_input_ring *ring = dev->shared_ring;
+
+	if (!ring)
+		return -1;
+	return ring_read(ring, data, length, timestamp, milliseconds);
+}
+
 int HID_API_EXPORT hid_send_feature_report(hid_device *dev, const unsigned char *data, size_t length)
 {
 	int res;
+	unsigned long long start;
 
+	HID_PROBE3(send_feature_entry, dev, data[0], length);
+	start = monotonic_ns();
 	res = ioctl(dev->device_handle, HIDIOCSFEATURE(length), data);
+	HID_PROBE2(send_feature_return, dev, res);
 	if (res < 0)
 		perror("ioctl (SFEATURE)");
+	else
+		record_latency(dev, HID_LATENCY_FEATURE, monotonic_ns() - start);
 
 	return res;
 }
@@ -745,10 +2360,16 @@ int HID_API_EXPORT hid_send_feature_report(hid_device *dev, const unsigned char
 int HID_API_EXPORT hid_get_feature_report(hid_device *dev, unsigned char *data, size_t length)
 {
 	int res;
+	unsigned long long start;
 
+	HID_PROBE3(get_feature_entry, dev, data[0], length);
+	start = monotonic_ns();
 	res = ioctl(dev->device_handle, HIDIOCGFEATURE(length), data);
+	HID_PROBE2(get_feature_return, dev, res);
 	if (res < 0)
 		perror("ioctl (GFEATURE)");
+	else
+		record_latency(dev, HID_LATENCY_FEATURE, monotonic_ns() - start);
 
 
 	return res;
@@ -759,6 +2380,12 @@ void HID_API_EXPORT hid_close(hid_device *dev)
 {
 	if (!dev)
 		return;
+	HID_PROBE1(device_close, dev);
+	detach_ring(dev);
+#ifdef HAVE_IO_URING
+	if (dev->uring)
+		uring_close(dev);
+#endif
 	close(dev->device_handle);
 	free(dev);
 }
@@ -789,3 +2416,5 @@ HID_API_EXPORT const wchar_t * HID_API_CALL  hid_error(hid_device *dev)
 {
 	return NULL;
 }
+
+HID_BACKEND_TABLE();
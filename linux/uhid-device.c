@@ -0,0 +1,446 @@
+/*******************************************************
+ HIDAPI - Multi-Platform library for
+ communication with HID devices.
+
+ uhid-device - virtual HID devices made through /dev/uhid,
+ for testing and benchmarking without hardware.
+
+ At the discretion of the user of this library,
+ this software may be licensed under the terms of the
+ GNU Public License v3, a BSD-Style license, or the
+ original HIDAPI license as outlined in the LICENSE.txt,
+ LICENSE-gpl3.txt, LICENSE-bsd.txt, and LICENSE-orig.txt
+ files located at the root of the source distribution.
+ These files may also be found in the public source
+ code repository located at:
+        http://github.com/signal11/hidapi .
+********************************************************/
+
+/* The kernel treats the devices like any other HID device and gives
+   each a hidraw node, so hid.c sees them as it would real ones. They
+   are on the virtual bus; hid-libusb.c, which only talks to USB, can't
+   see them.
+
+   Each device behaves the same on every run, like the ones in mock/:
+
+   - While its hidraw node is open, it sends Input reports at the
+     given rate. Byte i of report n is (n + i) & 0xff.
+   - With -e, each Output report is sent back as an Input report.
+   - With -f, a Feature report reads back the last one sent, which
+     starts as the report ID followed by 1, 2, 3... Without it,
+     Feature report requests fail.
+   - The product string is "Virtual HID n" and the serial number n as
+     4 digits.
+
+   The devices go away when the program exits. It needs write access
+   to /dev/uhid, which is usually only root's. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <stdint.h>
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/timerfd.h>
+#include <linux/input.h>
+#include <linux/uhid.h>
+
+#define MAX_DEVICES 1024
+/* Reports sent at once when the program fell behind the rate. */
+#define MAX_BURST 64
+
+struct vdev {
+	int fd;
+	int index;
+	int opened;
+	unsigned long long sequence;
+	unsigned char feature[UHID_DATA_MAX];
+	size_t feature_len;
+};
+
+static int num_devices = 1;
+static unsigned int vendor_id = 0x1209;
+static unsigned int product_id = 0x0001;
+static int report_size = 64;
+static int rate = 0;
+static int echo = 0;
+static int feature = 0;
+static int hotplug_ms = 0;
+
+static unsigned char descriptor[HID_MAX_DESCRIPTOR_SIZE];
+static size_t descriptor_len;
+/* Whether the descriptor declares Report IDs. */
+static int numbered;
+
+static volatile sig_atomic_t done;
+
+static void stop(int sig)
+{
+	done = 1;
+}
+
+/* A vendor-defined collection with an Input, an Output and a Feature
+   report of report_size bytes each, without report IDs. */
+static void default_descriptor(void)
+{
+	unsigned char d[] = {
+		0x06, 0x00, 0xff,	/* Usage Page (Vendor Defined 0xFF00) */
+		0x09, 0x01,		/* Usage (0x01) */
+		0xa1, 0x01,		/* Collection (Application) */
+		0x15, 0x00,		/*   Logical Minimum (0) */
+		0x26, 0xff, 0x00,	/*   Logical Maximum (255) */
+		0x75, 0x08,		/*   Report Size (8) */
+		0x96, 0, 0,		/*   Report Count (report_size) */
+		0x09, 0x01,		/*   Usage (0x01) */
+		0x81, 0x02,		/*   Input (Data,Var,Abs) */
+		0x96, 0, 0,		/*   Report Count (report_size) */
+		0x09, 0x01,		/*   Usage (0x01) */
+		0x91, 0x02,		/*   Output (Data,Var,Abs) */
+		0x96, 0, 0,		/*   Report Count (report_size) */
+		0x09, 0x01,		/*   Usage (0x01) */
+		0xb1, 0x02,		/*   Feature (Data,Var,Abs) */
+		0xc0,			/* End Collection */
+	};
+	size_t i;
+
+	for (i = 0; i + 2 < sizeof(d); i++) {
+		if (d[i] == 0x96) {
+			d[i+1] = report_size & 0xff;
+			d[i+2] = report_size >> 8;
+		}
+	}
+	memcpy(descriptor, d, sizeof(d));
+	descriptor_len = sizeof(d);
+}
+
+/* Reads a descriptor written as hex bytes, such as the output of
+   "hexdump -C" without the offsets, or of usbhid-dump. */
+static int read_descriptor(const char *filename)
+{
+	FILE *f = fopen(filename, "r");
+	unsigned int b;
+
+	if (!f) {
+		perror(filename);
+		return -1;
+	}
+	descriptor_len = 0;
+	while (fscanf(f, "%x", &b) == 1) {
+		if (descriptor_len == sizeof(descriptor) || b > 0xff) {
+			fprintf(stderr, "%s: not a report descriptor\n", filename);
+			fclose(f);
+			return -1;
+		}
+		descriptor[descriptor_len++] = b;
+	}
+	fclose(f);
+	return descriptor_len > 0? 0: -1;
+}
+
+/* Walks the items of the descriptor looking for a Report ID. */
+static int has_report_ids(void)
+{
+	size_t i = 0;
+
+	while (i < descriptor_len) {
+		unsigned char prefix = descriptor[i];
+		if (prefix == 0xfe) {
+			/* Long item */
+			if (i + 1 >= descriptor_len)
+				break;
+			i += 3 + descriptor[i+1];
+			continue;
+		}
+		if ((prefix & 0xfc) == 0x84)
+			return 1;
+		i += 1 + ((prefix & 3) == 3? 4: (prefix & 3));
+	}
+	return 0;
+}
+
+static int send_event(struct vdev *dev, struct uhid_event *ev)
+{
+	ssize_t res = write(dev->fd, ev, sizeof(*ev));
+	if (res != sizeof(*ev)) {
+		fprintf(stderr, "uhid-device: writing to device %d: %s\n",
+			dev->index, res < 0? strerror(errno): "short write");
+		return -1;
+	}
+	return 0;
+}
+
+static int create(struct vdev *dev)
+{
+	struct uhid_event ev;
+	int i;
+
+	memset(&ev, 0, sizeof(ev));
+	ev.type = UHID_CREATE2;
+	snprintf((char *) ev.u.create2.name, sizeof(ev.u.create2.name), "Virtual HID %d", dev->index);
+	snprintf((char *) ev.u.create2.phys, sizeof(ev.u.create2.phys), "uhid-device/%d", dev->index);
+	snprintf((char *) ev.u.create2.uniq, sizeof(ev.u.create2.uniq), "%04d", dev->index);
+	ev.u.create2.rd_size = descriptor_len;
+	ev.u.create2.bus = BUS_VIRTUAL;
+	ev.u.create2.vendor = vendor_id;
+	ev.u.create2.product = product_id + dev->index;
+	ev.u.create2.version = 0x100;
+	memcpy(ev.u.create2.rd_data, descriptor, descriptor_len);
+
+	dev->opened = 0;
+	dev->sequence = 0;
+	dev->feature[0] = 0;
+	for (i = 1; i <= report_size; i++)
+		dev->feature[i] = i;
+	dev->feature_len = report_size + 1;
+
+	return send_event(dev, &ev);
+}
+
+static int destroy(struct vdev *dev)
+{
+	struct uhid_event ev;
+
+	memset(&ev, 0, sizeof(ev));
+	ev.type = UHID_DESTROY;
+	return send_event(dev, &ev);
+}
+
+static int send_input(struct vdev *dev, const unsigned char *data, size_t len)
+{
+	struct uhid_event ev;
+
+	memset(&ev, 0, sizeof(ev));
+	ev.type = UHID_INPUT2;
+	ev.u.input2.size = len;
+	memcpy(ev.u.input2.data, data, len);
+	return send_event(dev, &ev);
+}
+
+static int send_report(struct vdev *dev)
+{
+	unsigned char data[UHID_DATA_MAX];
+	int i;
+
+	for (i = 0; i < report_size; i++)
+		data[i] = (dev->sequence + i) & 0xff;
+	dev->sequence++;
+	return send_input(dev, data, report_size);
+}
+
+static int handle_event(struct vdev *dev)
+{
+	struct uhid_event ev, reply;
+	ssize_t res;
+
+	res = read(dev->fd, &ev, sizeof(ev));
+	if (res < 0)
+		return (errno == EINTR || errno == EAGAIN)? 0: -1;
+
+	memset(&reply, 0, sizeof(reply));
+	switch (ev.type) {
+	case UHID_OPEN:
+		dev->opened = 1;
+		break;
+	case UHID_CLOSE:
+		dev->opened = 0;
+		break;
+	case UHID_OUTPUT:
+		if (echo && ev.u.output.size > 0) {
+			/* The Output report starts with its report ID, which an
+			   unnumbered Input report doesn't have. */
+			if (numbered)
+				return send_input(dev, ev.u.output.data, ev.u.output.size);
+			if (ev.u.output.size > 1)
+				return send_input(dev, ev.u.output.data + 1, ev.u.output.size - 1);
+		}
+		break;
+	case UHID_GET_REPORT:
+		reply.type = UHID_GET_REPORT_REPLY;
+		reply.u.get_report_reply.id = ev.u.get_report.id;
+		if (feature && ev.u.get_report.rtype == UHID_FEATURE_REPORT) {
+			reply.u.get_report_reply.size = dev->feature_len;
+			memcpy(reply.u.get_report_reply.data, dev->feature, dev->feature_len);
+		}
+		else
+			reply.u.get_report_reply.err = EIO;
+		return send_event(dev, &reply);
+	case UHID_SET_REPORT:
+		reply.type = UHID_SET_REPORT_REPLY;
+		reply.u.set_report_reply.id = ev.u.set_report.id;
+		if (feature && ev.u.set_report.rtype == UHID_FEATURE_REPORT) {
+			dev->feature_len = ev.u.set_report.size;
+			memcpy(dev->feature, ev.u.set_report.data, dev->feature_len);
+		}
+		else
+			reply.u.set_report_reply.err = EIO;
+		return send_event(dev, &reply);
+	default:
+		/* UHID_START and UHID_STOP need no answer. */
+		break;
+	}
+	return 0;
+}
+
+static int make_timer(int interval_ns)
+{
+	struct itimerspec spec;
+	int fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+
+	if (fd < 0) {
+		perror("timerfd_create");
+		exit(1);
+	}
+	spec.it_interval.tv_sec = interval_ns / 1000000000;
+	spec.it_interval.tv_nsec = interval_ns % 1000000000;
+	spec.it_value = spec.it_interval;
+	timerfd_settime(fd, 0, &spec, NULL);
+	return fd;
+}
+
+static unsigned long long expirations(int fd)
+{
+	uint64_t count = 0;
+	if (read(fd, &count, sizeof(count)) != sizeof(count))
+		return 0;
+	return count;
+}
+
+static void usage(const char *name)
+{
+	fprintf(stderr,
+		"usage: %s [options]\n"
+		"  -n COUNT    devices to make (default 1)\n"
+		"  -i VID:PID  IDs of the first device, in hex; each next device\n"
+		"              has the next product ID (default 1209:0001)\n"
+		"  -s SIZE     Input, Output and Feature report size (default 64)\n"
+		"  -D FILE     a report descriptor as hex bytes, in place of the\n"
+		"              default one with reports of SIZE bytes\n"
+		"  -r RATE     Input reports per second from each device (default 0)\n"
+		"  -e          send each Output report back as an Input report\n"
+		"  -f          answer Feature report requests\n"
+		"  -H MS       remove and add back every device each MS milliseconds\n"
+		"  -t SECONDS  exit after this long (default: on SIGINT or SIGTERM)\n",
+		name);
+	exit(2);
+}
+
+int main(int argc, char* argv[])
+{
+	const char *descriptor_file = NULL;
+	struct vdev *devs;
+	struct pollfd *fds;
+	struct sigaction sa;
+	int rate_fd = -1, hotplug_fd = -1;
+	int nfds, seconds = 0, failed = 0;
+	int c, i;
+
+	while ((c = getopt(argc, argv, "n:i:s:D:r:efH:t:")) != -1) {
+		switch (c) {
+		case 'n': num_devices = atoi(optarg); break;
+		case 'i':
+			if (sscanf(optarg, "%x:%x", &vendor_id, &product_id) != 2)
+				usage(argv[0]);
+			break;
+		case 's': report_size = atoi(optarg); break;
+		case 'D': descriptor_file = optarg; break;
+		case 'r': rate = atoi(optarg); break;
+		case 'e': echo = 1; break;
+		case 'f': feature = 1; break;
+		case 'H': hotplug_ms = atoi(optarg); break;
+		case 't': seconds = atoi(optarg); break;
+		default: usage(argv[0]);
+		}
+	}
+	if (num_devices < 1 || num_devices > MAX_DEVICES ||
+	    report_size < 1 || report_size >= UHID_DATA_MAX ||
+	    rate < 0 || rate > 1000000000 || hotplug_ms < 0 || seconds < 0)
+		usage(argv[0]);
+
+	if (descriptor_file) {
+		if (read_descriptor(descriptor_file) < 0)
+			return 1;
+	}
+	else
+		default_descriptor();
+	numbered = has_report_ids();
+
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = stop;
+	sigaction(SIGINT, &sa, NULL);
+	sigaction(SIGTERM, &sa, NULL);
+	sigaction(SIGALRM, &sa, NULL);
+
+	devs = calloc(num_devices, sizeof(struct vdev));
+	fds = calloc(num_devices + 2, sizeof(struct pollfd));
+	for (i = 0; i < num_devices; i++) {
+		devs[i].index = i;
+		devs[i].fd = open("/dev/uhid", O_RDWR | O_CLOEXEC);
+		if (devs[i].fd < 0) {
+			perror("/dev/uhid");
+			return 1;
+		}
+		if (create(&devs[i]) < 0)
+			return 1;
+		fds[i].fd = devs[i].fd;
+		fds[i].events = POLLIN;
+	}
+	nfds = num_devices;
+	if (rate > 0) {
+		rate_fd = make_timer(1000000000 / rate);
+		fds[nfds].fd = rate_fd;
+		fds[nfds++].events = POLLIN;
+	}
+	if (hotplug_ms > 0) {
+		hotplug_fd = make_timer(hotplug_ms * 1000000);
+		fds[nfds].fd = hotplug_fd;
+		fds[nfds++].events = POLLIN;
+	}
+	if (seconds > 0)
+		alarm(seconds);
+
+	fprintf(stderr, "uhid-device: %d device(s) %04x:%04x to %04x:%04x\n",
+		num_devices, vendor_id, product_id, vendor_id, product_id + num_devices - 1);
+
+	while (!done && !failed) {
+		if (poll(fds, nfds, -1) < 0) {
+			if (errno == EINTR)
+				continue;
+			perror("poll");
+			break;
+		}
+
+		for (i = 0; i < num_devices; i++) {
+			if (fds[i].revents & POLLIN)
+				failed |= handle_event(&devs[i]) < 0;
+		}
+
+		if (rate_fd >= 0 && (fds[num_devices].revents & POLLIN)) {
+			unsigned long long n = expirations(rate_fd);
+			if (n > MAX_BURST)
+				n = MAX_BURST;
+			for (i = 0; i < num_devices; i++) {
+				unsigned long long j;
+				for (j = 0; devs[i].opened && j < n; j++)
+					failed |= send_report(&devs[i]) < 0;
+			}
+		}
+
+		if (hotplug_fd >= 0 && (fds[nfds - 1].revents & POLLIN)) {
+			expirations(hotplug_fd);
+			for (i = 0; i < num_devices; i++)
+				failed |= destroy(&devs[i]) < 0 || create(&devs[i]) < 0;
+		}
+	}
+
+	for (i = 0; i < num_devices; i++) {
+		destroy(&devs[i]);
+		close(devs[i].fd);
+	}
+	free(devs);
+	free(fds);
+	return failed;
+}
@@ -428,6 +428,51 @@ int HID_API_EXPORT hid_exit(void)
 	return 0;
 }
 
+int HID_API_EXPORT hid_set_io_engine(int engine)
+{
+	/* Only the default engine on this platform. */
+	return (engine == HID_IO_ENGINE_DEFAULT)? 0: -1;
+}
+
+int HID_API_EXPORT hid_set_backend(const char *name)
+{
+	/* This is the only implementation in the library. */
+	return (name && strcmp(name, "mac") == 0)? 0: -1;
+}
+
+HID_API_EXPORT const char * HID_API_CALL hid_get_backend(void)
+{
+	return "mac";
+}
+
+int HID_API_EXPORT hid_enumerate_backend(const char *backend, unsigned short vendor_id, unsigned short product_id, struct hid_device_info **devs)
+{
+	*devs = NULL;
+	if (backend && strcmp(backend, hid_get_backend()) != 0)
+		return -1;
+	*devs = hid_enumerate(vendor_id, product_id);
+	return 0;
+}
+
+hid_device * HID_API_EXPORT hid_open_path_backend(const char *backend, const char *path)
+{
+	if (backend && strcmp(backend, hid_get_backend()) != 0)
+		return NULL;
+	return hid_open_path(path);
+}
+
+HID_API_EXPORT const char * HID_API_CALL hid_get_device_backend(hid_device *dev)
+{
+	return hid_get_backend();
+}
+
+hid_reactor * HID_API_EXPORT hid_reactor_create_backend(const char *backend)
+{
+	if (backend && strcmp(backend, hid_get_backend()) != 0)
+		return NULL;
+	return hid_reactor_create();
+}
+
 static void process_pending_events() {
 	SInt32 res;
 	do {
@@ -488,6 +533,7 @@ struct hid_device_info  HID_API_EXPORT *hid_enumerate(unsigned short vendor_id,
 				root = tmp;
 			}
 			cur_dev = tmp;
+			cur_dev->backend = hid_get_backend();
 
 			// Get the Usage Page and Usage for this device.
 			cur_dev->usage_page = get_int_property(dev, CFSTR(kIOHIDPrimaryUsagePageKey));
@@ -964,11 +1010,127 @@ ret:
 	return bytes_read;
 }
 
+int HID_API_EXPORT hid_read_timestamped(hid_device *dev, unsigned char *data, size_t length, unsigned long long *timestamp, int milliseconds)
+{
+	/* Not supported on this platform. */
+	return -1;
+}
+
+int HID_API_EXPORT hid_read_sequenced(hid_device *dev, unsigned char *data, size_t length, unsigned long long *sequence, unsigned long long *timestamp, int milliseconds)
+{
+	/* Not supported on this platform. */
+	return -1;
+}
+
+int HID_API_EXPORT hid_get_dropped_count(hid_device *dev, unsigned long long *count)
+{
+	/* Not supported on this platform. */
+	return -1;
+}
+
+int HID_API_EXPORT hid_get_stats(hid_device *dev, struct hid_device_stats *stats)
+{
+	/* Not supported on this platform. */
+	return -1;
+}
+
+int HID_API_EXPORT hid_get_latency_histogram(hid_device *dev, int kind, struct hid_histogram *histogram, int reset)
+{
+	/* Not supported on this platform. */
+	return -1;
+}
+
+int HID_API_EXPORT hid_read_many(hid_device *dev, unsigned char *data, size_t *length, int max_reports, int milliseconds)
+{
+	size_t used = 0;
+	int count = 0;
+	int res;
+
+	if (*length < 3 || max_reports < 1)
+		return -1;
+
+	/* Wait for the first report. It's copied out below together with
+	   any reports that arrived behind it. */
+	res = hid_read_timeout(dev, data + 2, *length - 2, milliseconds);
+	if (res <= 0) {
+		*length = 0;
+		return res;
+	}
+	data[0] = res & 0xff;
+	data[1] = (res >> 8) & 0xff;
+	used = 2 + res;
+	count = 1;
+
+	/* Take the rest of the queue under a single lock. */
+	pthread_mutex_lock(&dev->mutex);
+	while (dev->input_reports && count < max_reports) {
+		size_t len = dev->input_reports->len;
+		if (used + 2 + len > *length)
+			break;
+		return_data(dev, data + used + 2, len);
+		data[used] = len & 0xff;
+		data[used+1] = (len >> 8) & 0xff;
+		used += 2 + len;
+		count++;
+	}
+	pthread_mutex_unlock(&dev->mutex);
+
+	*length = used;
+	return count;
+}
+
 int HID_API_EXPORT hid_read(hid_device *dev, unsigned char *data, size_t length)
 {
 	return hid_read_timeout(dev, data, length, (dev->blocking)? -1: 0);
 }
 
+int HID_API_EXPORT hid_get_poll_fd(hid_device *dev)
+{
+	/* Not supported on this platform. */
+	return -1;
+}
+
+hid_reactor * HID_API_EXPORT hid_reactor_create(void)
+{
+	/* Not supported on this platform. */
+	return NULL;
+}
+
+int HID_API_EXPORT hid_reactor_add(hid_reactor *reactor, hid_device *dev)
+{
+	return -1;
+}
+
+int HID_API_EXPORT hid_reactor_remove(hid_reactor *reactor, hid_device *dev)
+{
+	return -1;
+}
+
+int HID_API_EXPORT hid_reactor_wait(hid_reactor *reactor, hid_device **ready, int max_ready, int milliseconds)
+{
+	return -1;
+}
+
+void HID_API_EXPORT hid_reactor_destroy(hid_reactor *reactor)
+{
+}
+
+hid_hotplug * HID_API_EXPORT hid_hotplug_create(unsigned short vendor_id, unsigned short product_id)
+{
+	/* Not supported on this platform. */
+	return NULL;
+}
+
+int HID_API_EXPORT hid_hotplug_wait(hid_hotplug *hotplug, struct hid_device_info **device, int milliseconds)
+{
+	*device = NULL;
+	return -1;
+}
+
+void HID_API_EXPORT hid_hotplug_destroy(hid_hotplug *hotplug)
+{
+}
+
 int HID_API_EXPORT hid_set_nonblocking(hid_device *dev, int nonblock)
 {
 	/* All Nonblocking operation is handled by the library. */
@@ -977,6 +1139,36 @@ int HID_API_EXPORT hid_set_nonblocking(hid_device *dev, int nonblock)
 	return 0;
 }
 
+int HID_API_EXPORT hid_set_input_queue(hid_device *dev, int capacity, int policy)
+{
+	/* Not supported on this platform. */
+	return -1;
+}
+
+int HID_API_EXPORT hid_set_input_transfers(hid_device *dev, int count)
+{
+	/* Not supported on this platform. */
+	return -1;
+}
+
+int HID_API_EXPORT hid_set_input_ring(hid_device *dev, struct hid_input_ring *ring, size_t size)
+{
+	/* Not supported on this platform. */
+	return -1;
+}
+
+int HID_API_EXPORT hid_input_ring_wait(hid_device *dev, int milliseconds)
+{
+	/* Not supported on this platform. */
+	return -1;
+}
+
+int HID_API_EXPORT hid_input_ring_read(hid_device *dev, unsigned char *data, size_t length, unsigned long long *timestamp, int milliseconds)
+{
+	/* Not supported on this platform. */
+	return -1;
+}
+
 int HID_API_EXPORT hid_send_feature_report(hid_device *dev, const unsigned char *data, size_t length)
 {
 	return set_report(dev, kIOHIDReportTypeFeature, data, length);
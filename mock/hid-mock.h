@@ -0,0 +1,37 @@
+/*******************************************************
+ HIDAPI - Multi-Platform library for
+ communication with HID devices.
+
+ Settings of the in-memory implementation, see hid.c.
+
+ At the discretion of the user of this library,
+ this software may be licensed under the terms of the
+ GNU Public License v3, a BSD-Style license, or the
+ original HIDAPI license as outlined in the LICENSE.txt,
+ LICENSE-gpl3.txt, LICENSE-bsd.txt, and LICENSE-orig.txt
+ files located at the root of the source distribution.
+ These files may also be found in the public source
+ code repository located at:
+        http://github.com/signal11/hidapi .
+********************************************************/
+
+#ifndef HID_MOCK_H__
+#define HID_MOCK_H__
+
+#include "hidapi.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Set the number of devices hid_enumerate() lists, the size of their
+   Input reports and the number of reports a second each sends, 0 for
+   as many as are read. Pass -1 to keep a setting. Devices already
+   open keep working, at the rate they were opened with. */
+void HID_API_EXPORT hid_mock_configure(int devices, int report_size, int rate);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
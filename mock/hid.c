@@ -0,0 +1,667 @@
+/*******************************************************
+ HIDAPI - Multi-Platform library for
+ communication with HID devices.
+
+ In-memory implementation, for benchmarks and tests which
+ have to run without any devices attached.
+
+ At the discretion of the user of this library,
+ this software may be licensed under the terms of the
+ GNU Public License v3, a BSD-Style license, or the
+ original HIDAPI license as outlined in the LICENSE.txt,
+ LICENSE-gpl3.txt, LICENSE-bsd.txt, and LICENSE-orig.txt
+ files located at the root of the source distribution.
+ These files may also be found in the public source
+ code repository located at:
+        http://github.com/signal11/hidapi .
+********************************************************/
+
+/* The mock devices behave the same on every run:
+
+   - hid_enumerate() lists HIDAPI_MOCK_DEVICES devices (4 by default),
+     with paths "mock:0", "mock:1" and so on, vendor ID 0x1209 and
+     product IDs from 0x0001.
+   - An Input report of HIDAPI_MOCK_REPORT_SIZE bytes (64 by default)
+     is always ready, so reads never wait. Byte i of report n is
+     (n + i) & 0xff.
+   - Unless HIDAPI_MOCK_RATE is set: then report n arrives (n + 1) /
+     rate seconds after the device was opened, reads wait for it, and
+     its timestamp is that time. Up to 30 reports are queued, after
+     which the oldest are dropped, as by hid-libusb.c.
+   - Writes and Feature reports succeed and are discarded, except
+     empty ones, which fail. hid_get_feature_report() returns the
+     report ID followed by 1, 2, 3...
+   - The strings are fixed: "Codeminders", "Mock Device n" and a
+     serial number of n as 4 digits.
+   - A hotplug monitor follows the number of devices: raising it with
+     hid_mock_configure() connects devices, and lowering it disconnects
+     the last ones.
+
+   The environment variables are read by hid_init(); hid_mock_configure()
+   changes the settings while running. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wchar.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "hid-backend.h"
+#include "hid-mock.h"
+
+#define MOCK_VENDOR_ID 0x1209
+#define MOCK_MAX_REPORT_SIZE 4096
+#define MOCK_QUEUE_SIZE 30
+
+struct hid_device_ {
+	HID_BACKEND_HEADER
+	int index;
+	int blocking;
+	/* Reports per second, or 0 when they are always ready. */
+	int rate;
+	unsigned long long opened;
+	unsigned long long next_sequence;
+	struct hid_device_stats stats;
+};
+
+struct hid_hotplug_ {
+	HID_BACKEND_HEADER
+	unsigned short vendor_id;
+	unsigned short product_id;
+	/* The number of devices it has reported connected. */
+	int devices;
+};
+
+static pthread_mutex_t config_mutex = PTHREAD_MUTEX_INITIALIZER;
+/* Signalled when the settings change, for hotplug monitors. */
+static pthread_cond_t config_cond = PTHREAD_COND_INITIALIZER;
+static int initialized = 0;
+static int num_devices = 4;
+static int report_size = 64;
+static int report_rate = 0;
+
+static unsigned long long monotonic_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long long) ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static int env_int(const char *name, int value)
+{
+	const char *s = getenv(name);
+	return s? atoi(s): value;
+}
+
+void HID_API_EXPORT hid_mock_configure(int devices, int size, int rate)
+{
+	pthread_mutex_lock(&config_mutex);
+	if (devices >= 0)
+		num_devices = devices;
+	if (size > 0)
+		report_size = (size < MOCK_MAX_REPORT_SIZE)? size: MOCK_MAX_REPORT_SIZE;
+	if (rate >= 0)
+		report_rate = rate;
+	initialized = 1;
+	pthread_cond_broadcast(&config_cond);
+	pthread_mutex_unlock(&config_mutex);
+}
+
+static wchar_t *mock_string(const wchar_t *format, int index)
+{
+	wchar_t buf[64];
+	swprintf(buf, sizeof(buf)/sizeof(buf[0]), format, index);
+	return wcsdup(buf);
+}
+
+static int copy_string(const wchar_t *format, int index, wchar_t *string, size_t maxlen)
+{
+	if (maxlen == 0)
+		return -1;
+	swprintf(string, maxlen, format, index);
+	string[maxlen-1] = L'\0';
+	return 0;
+}
+
+/* When report n arrives, on a device with a rate. Rounded up, so
+   queued() counts it from then on. */
+static unsigned long long arrival(hid_device *dev, unsigned long long n)
+{
+	return dev->opened + ((n + 1) * 1000000000ull + dev->rate - 1) / dev->rate;
+}
+
+/* The number of reports queued, after dropping the oldest ones which
+   don't fit. */
+static unsigned long long queued(hid_device *dev)
+{
+	unsigned long long elapsed = monotonic_ns() - dev->opened;
+	unsigned long long arrived = elapsed / 1000000000ull * dev->rate +
+		elapsed % 1000000000ull * dev->rate / 1000000000ull;
+	if (arrived <= dev->next_sequence)
+		return 0;
+	if (arrived - dev->next_sequence > MOCK_QUEUE_SIZE) {
+		dev->stats.reports_dropped += arrived - dev->next_sequence - MOCK_QUEUE_SIZE;
+		dev->next_sequence = arrived - MOCK_QUEUE_SIZE;
+	}
+	return arrived - dev->next_sequence;
+}
+
+/* Wait for the next Input report like hid_read_timeout(). Returns 1 if
+   there is one, 0 on timeout. */
+static int wait_report(hid_device *dev, int milliseconds)
+{
+	unsigned long long due;
+	struct timespec ts;
+
+	if (dev->rate == 0 || queued(dev) > 0)
+		return 1;
+	if (milliseconds == 0) {
+		dev->stats.read_timeouts++;
+		return 0;
+	}
+
+	due = arrival(dev, dev->next_sequence);
+	if (milliseconds > 0 && due > monotonic_ns() + milliseconds * 1000000ull) {
+		due = monotonic_ns() + milliseconds * 1000000ull;
+		dev->stats.read_timeouts++;
+		ts.tv_sec = due / 1000000000ull;
+		ts.tv_nsec = due % 1000000000ull;
+		while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) != 0)
+			;
+		return 0;
+	}
+	ts.tv_sec = due / 1000000000ull;
+	ts.tv_nsec = due % 1000000000ull;
+	while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) != 0)
+		;
+	dev->stats.read_wakeups++;
+	return 1;
+}
+
+/* Fill data with the device's next Input report. */
+static int make_report(hid_device *dev, unsigned char *data, size_t length, unsigned long long *sequence, unsigned long long *timestamp)
+{
+	unsigned long long n = dev->next_sequence++;
+	size_t len = (length < (size_t) report_size)? length: (size_t) report_size;
+	size_t i;
+
+	for (i = 0; i < len; i++)
+		data[i] = (unsigned char) (n + i);
+	dev->stats.reports_received++;
+	dev->stats.bytes_in += len;
+	if (sequence)
+		*sequence = n;
+	if (timestamp)
+		*timestamp = dev->rate? arrival(dev, n): monotonic_ns();
+	return len;
+}
+
+int HID_API_EXPORT hid_init(void)
+{
+	pthread_mutex_lock(&config_mutex);
+	if (!initialized) {
+		num_devices = env_int("HIDAPI_MOCK_DEVICES", num_devices);
+		report_size = env_int("HIDAPI_MOCK_REPORT_SIZE", report_size);
+		if (report_size < 1 || report_size > MOCK_MAX_REPORT_SIZE)
+			report_size = 64;
+		report_rate = env_int("HIDAPI_MOCK_RATE", report_rate);
+		if (report_rate < 0)
+			report_rate = 0;
+		initialized = 1;
+	}
+	pthread_mutex_unlock(&config_mutex);
+	return 0;
+}
+
+int HID_API_EXPORT hid_exit(void)
+{
+	return 0;
+}
+
+int HID_API_EXPORT hid_set_io_engine(int engine)
+{
+	/* Only the default engine on this platform. */
+	return (engine == HID_IO_ENGINE_DEFAULT)? 0: -1;
+}
+
+int HID_API_EXPORT hid_set_backend(const char *name)
+{
+	/* This is the only implementation in the library. */
+	return (name && strcmp(name, "mock") == 0)? 0: -1;
+}
+
+HID_API_EXPORT const char * HID_API_CALL hid_get_backend(void)
+{
+	return "mock";
+}
+
+int HID_API_EXPORT hid_enumerate_backend(const char *backend, unsigned short vendor_id, unsigned short product_id, struct hid_device_info **devs)
+{
+	*devs = NULL;
+	if (backend && strcmp(backend, hid_get_backend()) != 0)
+		return -1;
+	*devs = hid_enumerate(vendor_id, product_id);
+	return 0;
+}
+
+hid_device * HID_API_EXPORT hid_open_path_backend(const char *backend, const char *path)
+{
+	if (backend && strcmp(backend, hid_get_backend()) != 0)
+		return NULL;
+	return hid_open_path(path);
+}
+
+HID_API_EXPORT const char * HID_API_CALL hid_get_device_backend(hid_device *dev)
+{
+	return hid_get_backend();
+}
+
+hid_reactor * HID_API_EXPORT hid_reactor_create_backend(const char *backend)
+{
+	if (backend && strcmp(backend, hid_get_backend()) != 0)
+		return NULL;
+	return hid_reactor_create();
+}
+
+static int matches(int index, unsigned short vendor_id, unsigned short product_id)
+{
+	return (vendor_id == 0x0 || vendor_id == MOCK_VENDOR_ID) &&
+	       (product_id == 0x0 || product_id == index + 1);
+}
+
+static struct hid_device_info *create_device_info(int index)
+{
+	struct hid_device_info *info = calloc(1, sizeof(struct hid_device_info));
+	char path[32];
+
+	if (!info)
+		return NULL;
+	info->backend = hid_get_backend();
+
+	snprintf(path, sizeof(path), "mock:%d", index);
+	info->path = strdup(path);
+	info->vendor_id = MOCK_VENDOR_ID;
+	info->product_id = index + 1;
+	info->serial_number = mock_string(L"%04d", index);
+	info->release_number = 0x0100;
+	info->manufacturer_string = mock_string(L"Codeminders", index);
+	info->product_string = mock_string(L"Mock Device %d", index);
+	info->usage_page = 0xff00;
+	info->usage = 0x0001;
+	info->interface_number = 0;
+
+	return info;
+}
+
+struct hid_device_info  HID_API_EXPORT *hid_enumerate(unsigned short vendor_id, unsigned short product_id)
+{
+	struct hid_device_info *root = NULL;
+	struct hid_device_info *cur_dev = NULL;
+	int i, count;
+
+	hid_init();
+	pthread_mutex_lock(&config_mutex);
+	count = num_devices;
+	pthread_mutex_unlock(&config_mutex);
+
+	for (i = 0; i < count; i++) {
+		struct hid_device_info *tmp;
+
+		if (!matches(i, vendor_id, product_id))
+			continue;
+
+		tmp = create_device_info(i);
+		if (cur_dev)
+			cur_dev->next = tmp;
+		else
+			root = tmp;
+		cur_dev = tmp;
+	}
+
+	return root;
+}
+
+void  HID_API_EXPORT hid_free_enumeration(struct hid_device_info *devs)
+{
+	struct hid_device_info *d = devs;
+	while (d) {
+		struct hid_device_info *next = d->next;
+		free(d->path);
+		free(d->serial_number);
+		free(d->manufacturer_string);
+		free(d->product_string);
+		free(d);
+		d = next;
+	}
+}
+
+hid_device * HID_API_EXPORT hid_open(unsigned short vendor_id, unsigned short product_id, const wchar_t *serial_number)
+{
+	struct hid_device_info *devs, *cur_dev;
+	const char *path_to_open = NULL;
+	hid_device *handle = NULL;
+
+	devs = hid_enumerate(vendor_id, product_id);
+	for (cur_dev = devs; cur_dev; cur_dev = cur_dev->next) {
+		if (!serial_number || wcscmp(serial_number, cur_dev->serial_number) == 0) {
+			path_to_open = cur_dev->path;
+			break;
+		}
+	}
+
+	if (path_to_open)
+		handle = hid_open_path(path_to_open);
+
+	hid_free_enumeration(devs);
+
+	return handle;
+}
+
+hid_device * HID_API_EXPORT hid_open_path(const char *path)
+{
+	hid_device *dev;
+	int index, count, rate;
+	char end;
+
+	hid_init();
+	if (sscanf(path, "mock:%d%c", &index, &end) != 1)
+		return NULL;
+	pthread_mutex_lock(&config_mutex);
+	count = num_devices;
+	rate = report_rate;
+	pthread_mutex_unlock(&config_mutex);
+	if (index < 0 || index >= count)
+		return NULL;
+
+	dev = calloc(1, sizeof(hid_device));
+	if (!dev)
+		return NULL;
+	HID_BACKEND_INIT(dev);
+	dev->index = index;
+	dev->blocking = 1;
+	dev->rate = rate;
+	dev->opened = monotonic_ns();
+	return dev;
+}
+
+int HID_API_EXPORT hid_write(hid_device *dev, const unsigned char *data, size_t length)
+{
+	if (length == 0) {
+		dev->stats.transfer_errors++;
+		return -1;
+	}
+	dev->stats.writes++;
+	dev->stats.bytes_out += length;
+	return length;
+}
+
+int HID_API_EXPORT hid_read_timeout(hid_device *dev, unsigned char *data, size_t length, int milliseconds)
+{
+	if (!wait_report(dev, milliseconds))
+		return 0;
+	return make_report(dev, data, length, NULL, NULL);
+}
+
+int HID_API_EXPORT hid_read_timestamped(hid_device *dev, unsigned char *data, size_t length, unsigned long long *timestamp, int milliseconds)
+{
+	if (!wait_report(dev, milliseconds))
+		return 0;
+	return make_report(dev, data, length, NULL, timestamp);
+}
+
+int HID_API_EXPORT hid_read_sequenced(hid_device *dev, unsigned char *data, size_t length, unsigned long long *sequence, unsigned long long *timestamp, int milliseconds)
+{
+	if (!wait_report(dev, milliseconds))
+		return 0;
+	return make_report(dev, data, length, sequence, timestamp);
+}
+
+int HID_API_EXPORT hid_get_dropped_count(hid_device *dev, unsigned long long *count)
+{
+	if (dev->rate)
+		queued(dev);
+	*count = dev->stats.reports_dropped;
+	return 0;
+}
+
+int HID_API_EXPORT hid_get_stats(hid_device *dev, struct hid_device_stats *stats)
+{
+	*stats = dev->stats;
+	return 0;
+}
+
+int HID_API_EXPORT hid_get_latency_histogram(hid_device *dev, int kind, struct hid_histogram *histogram, int reset)
+{
+	/* Not supported on this platform. */
+	return -1;
+}
+
+int HID_API_EXPORT hid_read_many(hid_device *dev, unsigned char *data, size_t *length, int max_reports, int milliseconds)
+{
+	size_t used = 0;
+	int count = 0;
+
+	if (*length < 3 || max_reports < 1)
+		return -1;
+	if (!wait_report(dev, milliseconds)) {
+		*length = 0;
+		return 0;
+	}
+
+	/* Take as many reports as are queued and fit; without a rate,
+	   that is as many as fit. */
+	if (dev->rate) {
+		unsigned long long n = queued(dev);
+		if ((unsigned long long) max_reports > n)
+			max_reports = n;
+	}
+	while (count < max_reports && used + 2 + (size_t) report_size <= *length) {
+		int res = make_report(dev, data + used + 2, report_size, NULL, NULL);
+		data[used] = res & 0xff;
+		data[used+1] = (res >> 8) & 0xff;
+		used += 2 + res;
+		count++;
+	}
+	if (count == 0) {
+		/* The first report is truncated, as by hid_read(). */
+		int res = make_report(dev, data + 2, *length - 2, NULL, NULL);
+		data[0] = res & 0xff;
+		data[1] = (res >> 8) & 0xff;
+		used = 2 + res;
+		count = 1;
+	}
+
+	*length = used;
+	return count;
+}
+
+int HID_API_EXPORT hid_read(hid_device *dev, unsigned char *data, size_t length)
+{
+	return hid_read_timeout(dev, data, length, (dev->blocking)? -1: 0);
+}
+
+int HID_API_EXPORT hid_get_poll_fd(hid_device *dev)
+{
+	/* Not supported on this platform. */
+	return -1;
+}
+
+hid_reactor * HID_API_EXPORT hid_reactor_create(void)
+{
+	/* Not supported on this platform. */
+	return NULL;
+}
+
+int HID_API_EXPORT hid_reactor_add(hid_reactor *reactor, hid_device *dev)
+{
+	return -1;
+}
+
+int HID_API_EXPORT hid_reactor_remove(hid_reactor *reactor, hid_device *dev)
+{
+	return -1;
+}
+
+int HID_API_EXPORT hid_reactor_wait(hid_reactor *reactor, hid_device **ready, int max_ready, int milliseconds)
+{
+	return -1;
+}
+
+void HID_API_EXPORT hid_reactor_destroy(hid_reactor *reactor)
+{
+}
+
+hid_hotplug * HID_API_EXPORT hid_hotplug_create(unsigned short vendor_id, unsigned short product_id)
+{
+	hid_hotplug *hotplug = calloc(1, sizeof(hid_hotplug));
+	if (!hotplug)
+		return NULL;
+	HID_BACKEND_INIT(hotplug);
+	hotplug->vendor_id = vendor_id;
+	hotplug->product_id = product_id;
+
+	hid_init();
+	pthread_mutex_lock(&config_mutex);
+	hotplug->devices = num_devices;
+	pthread_mutex_unlock(&config_mutex);
+
+	return hotplug;
+}
+
+int HID_API_EXPORT hid_hotplug_wait(hid_hotplug *hotplug, struct hid_device_info **device, int milliseconds)
+{
+	struct timespec ts;
+	int event = 0, index = 0, res = 0;
+
+	*device = NULL;
+	if (milliseconds > 0) {
+		clock_gettime(CLOCK_REALTIME, &ts);
+		ts.tv_sec += milliseconds / 1000;
+		ts.tv_nsec += (milliseconds % 1000) * 1000000;
+		if (ts.tv_nsec >= 1000000000L) {
+			ts.tv_sec++;
+			ts.tv_nsec -= 1000000000L;
+		}
+	}
+
+	pthread_mutex_lock(&config_mutex);
+	while (res == 0) {
+		/* One device at a time, passing over those not asked for. */
+		while (!event && hotplug->devices != num_devices) {
+			if (hotplug->devices < num_devices) {
+				index = hotplug->devices++;
+				event = HID_HOTPLUG_ARRIVED;
+			}
+			else {
+				index = --hotplug->devices;
+				event = HID_HOTPLUG_LEFT;
+			}
+			if (!matches(index, hotplug->vendor_id, hotplug->product_id))
+				event = 0;
+		}
+		if (event || milliseconds == 0)
+			break;
+		if (milliseconds < 0)
+			res = pthread_cond_wait(&config_cond, &config_mutex);
+		else
+			res = pthread_cond_timedwait(&config_cond, &config_mutex, &ts);
+	}
+	pthread_mutex_unlock(&config_mutex);
+
+	if (event)
+		*device = create_device_info(index);
+	return event;
+}
+
+void HID_API_EXPORT hid_hotplug_destroy(hid_hotplug *hotplug)
+{
+	free(hotplug);
+}
+
+int HID_API_EXPORT hid_set_nonblocking(hid_device *dev, int nonblock)
+{
+	dev->blocking = !nonblock;
+	return 0;
+}
+
+int HID_API_EXPORT hid_set_input_queue(hid_device *dev, int capacity, int policy)
+{
+	/* Not supported on this platform. */
+	return -1;
+}
+
+int HID_API_EXPORT hid_set_input_transfers(hid_device *dev, int count)
+{
+	/* Not supported on this platform. */
+	return -1;
+}
+
+int HID_API_EXPORT hid_set_input_ring(hid_device *dev, struct hid_input_ring *ring, size_t size)
+{
+	/* Not supported on this platform. */
+	return -1;
+}
+
+int HID_API_EXPORT hid_input_ring_wait(hid_device *dev, int milliseconds)
+{
+	/* Not supported on this platform. */
+	return -1;
+}
+
+int HID_API_EXPORT hid_input_ring_read(hid_device *dev, unsigned char *data, size_t length, unsigned long long *timestamp, int milliseconds)
+{
+	/* Not supported on this platform. */
+	return -1;
+}
+
+int HID_API_EXPORT hid_send_feature_report(hid_device *dev, const unsigned char *data, size_t length)
+{
+	if (length == 0)
+		return -1;
+	return length;
+}
+
+int HID_API_EXPORT hid_get_feature_report(hid_device *dev, unsigned char *data, size_t length)
+{
+	size_t i;
+
+	if (length == 0)
+		return -1;
+	/* data[0] holds the report ID already. */
+	for (i = 1; i < length; i++)
+		data[i] = (unsigned char) i;
+	return length;
+}
+
+void HID_API_EXPORT hid_close(hid_device *dev)
+{
+	free(dev);
+}
+
+int HID_API_EXPORT_CALL hid_get_manufacturer_string(hid_device *dev, wchar_t *string, size_t maxlen)
+{
+	return copy_string(L"Codeminders", dev->index, string, maxlen);
+}
+
+int HID_API_EXPORT_CALL hid_get_product_string(hid_device *dev, wchar_t *string, size_t maxlen)
+{
+	return copy_string(L"Mock Device %d", dev->index, string, maxlen);
+}
+
+int HID_API_EXPORT_CALL hid_get_serial_number_string(hid_device *dev, wchar_t *string, size_t maxlen)
+{
+	return copy_string(L"%04d", dev->index, string, maxlen);
+}
+
+int HID_API_EXPORT_CALL hid_get_indexed_string(hid_device *dev, int string_index, wchar_t *string, size_t maxlen)
+{
+	return copy_string(L"String %d", string_index, string, maxlen);
+}
+
+HID_API_EXPORT const wchar_t * HID_API_CALL  hid_error(hid_device *dev)
+{
+	return L"Empty report";
+}
+
+HID_BACKEND_TABLE();
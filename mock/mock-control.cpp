@@ -0,0 +1,31 @@
+/*******************************************************
+ HIDAPI - Multi-Platform library for
+ communication with HID devices.
+
+ Lets the benchmarks configure the in-memory implementation.
+
+ At the discretion of the user of this library,
+ this software may be licensed under the terms of the
+ GNU Public License v3, a BSD-Style license, or the
+ original HIDAPI license as outlined in the LICENSE.txt,
+ LICENSE-gpl3.txt, LICENSE-bsd.txt, and LICENSE-orig.txt
+ files located at the root of the source distribution.
+ These files may also be found in the public source
+ code repository located at:
+        http://github.com/signal11/hidapi .
+********************************************************/
+
+#include <jni.h>
+
+#include "hid-mock.h"
+
+/*
+ * Class:     com_codeminders_hidapi_bench_MockBackend
+ * Method:    configure
+ * Signature: (III)V
+ */
+extern "C" JNIEXPORT void JNICALL Java_com_codeminders_hidapi_bench_MockBackend_configure
+  (JNIEnv *env, jclass cls, jint devices, jint report_size, jint rate)
+{
+    hid_mock_configure(devices, report_size, rate);
+}
@@ -0,0 +1,209 @@
+package com.codeminders.hidapi;
+
+import java.io.IOException;
+import java.util.ArrayList;
+import java.util.List;
+import java.util.Map;
+import java.util.WeakHashMap;
+
+import jdk.jfr.Event;
+import jdk.jfr.FlightRecorder;
+
+/**
+ * Records HID operations as Flight Recorder events, see
+ * {@link HIDEvents}. Loaded by name when the JVM has Flight Recorder.
+ * <p>
+ * Dropped reports are counted by the native library, so instead of an
+ * event per report, {@link HidQueueOverflow} is a periodic event which
+ * reports each open device whose count went up since the last period.
+ */
+final class FlightRecorderEvents extends HIDEvents
+{
+    /* Only asked whether their type is enabled, which is a check of a
+       flag the JIT can inline. They are never committed. */
+    private static final HidRead READ_TYPE = new HidRead();
+    private static final HidWrite WRITE_TYPE = new HidWrite();
+    private static final HidFeatureReport FEATURE_REPORT_TYPE = new HidFeatureReport();
+    private static final HidEnumerate ENUMERATE_TYPE = new HidEnumerate();
+    private static final HidOpen OPEN_TYPE = new HidOpen();
+
+    /* Each open device and its dropped count at the last period */
+    private final Map<HIDDevice, Long> devices = new WeakHashMap<HIDDevice, Long>();
+
+    public FlightRecorderEvents()
+    {
+        FlightRecorder.addPeriodicEvent(HidQueueOverflow.class, new Runnable()
+        {
+            public void run()
+            {
+                checkOverflow();
+            }
+        });
+    }
+
+    @Override
+    Object begin(int type)
+    {
+        Event event;
+        switch(type)
+        {
+        case READ:
+            if(!READ_TYPE.isEnabled())
+                return null;
+            event = new HidRead();
+            break;
+        case WRITE:
+            if(!WRITE_TYPE.isEnabled())
+                return null;
+            event = new HidWrite();
+            break;
+        case FEATURE_REPORT:
+            if(!FEATURE_REPORT_TYPE.isEnabled())
+                return null;
+            event = new HidFeatureReport();
+            break;
+        case ENUMERATE:
+            if(!ENUMERATE_TYPE.isEnabled())
+                return null;
+            event = new HidEnumerate();
+            break;
+        case OPEN:
+            if(!OPEN_TYPE.isEnabled())
+                return null;
+            event = new HidOpen();
+            break;
+        default:
+            return null;
+        }
+        event.begin();
+        return event;
+    }
+
+    @Override
+    void endRead(Object event, HIDDevice device, int bytes, int reports, int timeout)
+    {
+        HidRead e = (HidRead) event;
+        e.end();
+        if(e.shouldCommit())
+        {
+            e.path = device.getPath();
+            e.bytes = bytes;
+            e.reports = reports;
+            e.timeout = timeout;
+            e.commit();
+        }
+    }
+
+    @Override
+    void endWrite(Object event, HIDDevice device, int bytes)
+    {
+        HidWrite e = (HidWrite) event;
+        e.end();
+        if(e.shouldCommit())
+        {
+            e.path = device.getPath();
+            e.bytes = bytes;
+            e.commit();
+        }
+    }
+
+    @Override
+    void endFeatureReport(Object event, HIDDevice device, boolean get, int bytes)
+    {
+        HidFeatureReport e = (HidFeatureReport) event;
+        e.end();
+        if(e.shouldCommit())
+        {
+            e.path = device.getPath();
+            e.get = get;
+            e.bytes = bytes;
+            e.commit();
+        }
+    }
+
+    @Override
+    void endEnumerate(Object event, int devices)
+    {
+        HidEnumerate e = (HidEnumerate) event;
+        e.end();
+        if(e.shouldCommit())
+        {
+            e.devices = devices;
+            e.commit();
+        }
+    }
+
+    @Override
+    void endOpen(Object event, String path, HIDDevice device)
+    {
+        HidOpen e = (HidOpen) event;
+        e.end();
+        if(e.shouldCommit())
+        {
+            e.path = path;
+            e.success = device != null;
+            e.commit();
+        }
+    }
+
+    @Override
+    void opened(HIDDevice device)
+    {
+        synchronized(devices)
+        {
+            devices.put(device, 0L);
+        }
+    }
+
+    @Override
+    void closed(HIDDevice device)
+    {
+        synchronized(devices)
+        {
+            devices.remove(device);
+        }
+    }
+
+    /* Called by Flight Recorder once a period while HidQueueOverflow
+       is enabled. */
+    private void checkOverflow()
+    {
+        List<HIDDevice> open;
+        synchronized(devices)
+        {
+            open = new ArrayList<HIDDevice>(devices.keySet());
+        }
+
+        for(HIDDevice device : open)
+        {
+            long total;
+            try
+            {
+                total = device.getDroppedCount();
+            } catch(IOException e)
+            {
+                // Closed meanwhile, or not counted on this platform.
+                continue;
+            }
+
+            long last;
+            synchronized(devices)
+            {
+                Long previous = devices.get(device);
+                if(previous == null)
+                    continue;
+                last = previous;
+                devices.put(device, total);
+            }
+
+            if(total > last)
+            {
+                HidQueueOverflow e = new HidQueueOverflow();
+                e.path = device.getPath();
+                e.dropped = total - last;
+                e.totalDropped = total;
+                e.commit();
+            }
+        }
+    }
+}
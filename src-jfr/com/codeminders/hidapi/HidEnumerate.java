@@ -0,0 +1,17 @@
+package com.codeminders.hidapi;
+
+import jdk.jfr.Category;
+import jdk.jfr.Description;
+import jdk.jfr.Label;
+import jdk.jfr.Name;
+
+@Name("com.codeminders.hidapi.HidEnumerate")
+@Label("HID Enumerate")
+@Category("HID")
+@Description("A listing of the HID devices attached to the system")
+class HidEnumerate extends jdk.jfr.Event
+{
+    @Label("Devices")
+    @Description("Devices found, or -1 on failure")
+    int devices;
+}
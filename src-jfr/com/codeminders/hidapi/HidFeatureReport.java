@@ -0,0 +1,26 @@
+package com.codeminders.hidapi;
+
+import jdk.jfr.Category;
+import jdk.jfr.DataAmount;
+import jdk.jfr.Description;
+import jdk.jfr.Label;
+import jdk.jfr.Name;
+
+@Name("com.codeminders.hidapi.HidFeatureReport")
+@Label("HID Feature Report")
+@Category("HID")
+@Description("A Feature report sent to or received from a HID device")
+class HidFeatureReport extends jdk.jfr.Event
+{
+    @Label("Path")
+    String path;
+
+    @Label("Get")
+    @Description("True if the report was received, false if it was sent")
+    boolean get;
+
+    @Label("Bytes")
+    @Description("Bytes transferred, or -1 on failure")
+    @DataAmount
+    int bytes;
+}
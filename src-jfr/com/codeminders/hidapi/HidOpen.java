@@ -0,0 +1,19 @@
+package com.codeminders.hidapi;
+
+import jdk.jfr.Category;
+import jdk.jfr.Description;
+import jdk.jfr.Label;
+import jdk.jfr.Name;
+
+@Name("com.codeminders.hidapi.HidOpen")
+@Label("HID Open")
+@Category("HID")
+@Description("A HID device being opened")
+class HidOpen extends jdk.jfr.Event
+{
+    @Label("Path")
+    String path;
+
+    @Label("Success")
+    boolean success;
+}
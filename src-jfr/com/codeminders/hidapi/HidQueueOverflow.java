@@ -0,0 +1,26 @@
+package com.codeminders.hidapi;
+
+import jdk.jfr.Category;
+import jdk.jfr.Description;
+import jdk.jfr.Label;
+import jdk.jfr.Name;
+import jdk.jfr.Period;
+
+@Name("com.codeminders.hidapi.HidQueueOverflow")
+@Label("HID Queue Overflow")
+@Category("HID")
+@Description("Input reports dropped by an open HID device since the last check, because its queue or input ring was full")
+@Period("1 s")
+class HidQueueOverflow extends jdk.jfr.Event
+{
+    @Label("Path")
+    String path;
+
+    @Label("Dropped")
+    @Description("Reports dropped since the last event for this device")
+    long dropped;
+
+    @Label("Total Dropped")
+    @Description("Reports dropped since the device was opened")
+    long totalDropped;
+}
@@ -0,0 +1,31 @@
+package com.codeminders.hidapi;
+
+import jdk.jfr.Category;
+import jdk.jfr.DataAmount;
+import jdk.jfr.Description;
+import jdk.jfr.Label;
+import jdk.jfr.Name;
+import jdk.jfr.Timespan;
+
+@Name("com.codeminders.hidapi.HidRead")
+@Label("HID Read")
+@Category("HID")
+@Description("Input reports read from a HID device, including the time spent waiting for them")
+class HidRead extends jdk.jfr.Event
+{
+    @Label("Path")
+    String path;
+
+    @Label("Bytes")
+    @Description("Bytes read, 0 on timeout or -1 on failure")
+    @DataAmount
+    int bytes;
+
+    @Label("Reports")
+    int reports;
+
+    @Label("Timeout")
+    @Description("The timeout given, or -1 to wait until a report arrives")
+    @Timespan(Timespan.MILLISECONDS)
+    long timeout;
+}
@@ -0,0 +1,22 @@
+package com.codeminders.hidapi;
+
+import jdk.jfr.Category;
+import jdk.jfr.DataAmount;
+import jdk.jfr.Description;
+import jdk.jfr.Label;
+import jdk.jfr.Name;
+
+@Name("com.codeminders.hidapi.HidWrite")
+@Label("HID Write")
+@Category("HID")
+@Description("An Output report written to a HID device")
+class HidWrite extends jdk.jfr.Event
+{
+    @Label("Path")
+    String path;
+
+    @Label("Bytes")
+    @Description("Bytes written, or -1 on failure")
+    @DataAmount
+    int bytes;
+}
@@ -2,6 +2,10 @@
 package com.codeminders.hidapi;
 
 import java.io.IOException;
+import java.nio.ByteBuffer;
+import java.util.concurrent.Executor;
+
+import javax.management.ObjectName;
 
 /**
  * Instance of this class represents an open HID device.
@@ -11,6 +15,12 @@ import java.io.IOException;
 public class HIDDevice
 {
     protected long peer;
+
+    private volatile InputReportListener inputListener;
+    private volatile Executor inputExecutor;
+    private InputRing inputRing;
+    private volatile ObjectName mbeanName;
+    private String path;
    
     /**
      * Set peer to object.
@@ -98,7 +108,350 @@ public class HIDDevice
      * the report number.
      */
     public native int readTimeout(byte[] buf, int milliseconds);
+
+    /**
+     * Write an Output Report taken from a region of an array. Only
+     * <code>len</code> bytes starting at <code>off</code> are copied
+     * out of the array.
+     *
+     * @param data the array holding the data to send, including the report number as the first byte
+     * @param off the offset of the report in <code>data</code>
+     * @param len the number of bytes to send
+     * @return the actual number of bytes written
+     * @throws IOException if write error occured
+     */
+    public int write(byte[] data, int off, int len) throws IOException
+    {
+        checkRegion(data, off, len);
+        Object event = HIDEvents.events.begin(HIDEvents.WRITE);
+        int n = -1;
+        try
+        {
+            n = writeRegion(data, off, len);
+            return n;
+        } finally
+        {
+            endWrite(event, n);
+        }
+    }
+
+    /**
+     * Read an Input Report into a region of an array. Only the bytes
+     * actually received are copied into the array, so a single large
+     * array can be reused for reports of any size.
+     *
+     * @param buf the array to put the read data into
+     * @param off the offset in <code>buf</code> at which to store the report
+     * @param len the maximum number of bytes to read
+     * @return the actual number of bytes read
+     * @throws IOException if read error occured
+     */
+    public int read(byte[] buf, int off, int len) throws IOException
+    {
+        checkRegion(buf, off, len);
+        Object event = HIDEvents.events.begin(HIDEvents.READ);
+        int n = -1;
+        try
+        {
+            n = readRegion(buf, off, len);
+            return n;
+        } finally
+        {
+            endRead(event, n, -1);
+        }
+    }
+
+    /**
+     * Read an Input report into a region of an array with timeout.
+     * See {@link #read(byte[], int, int)}.
+     *
+     * @param buf the array to put the read data into
+     * @param off the offset in <code>buf</code> at which to store the report
+     * @param len the maximum number of bytes to read
+     * @param milliseconds a timeout in milliseconds or -1 for blocking wait.
+     * @return the number of bytes read, or 0 on timeout
+     * @throws IOException if read error occured
+     */
+    public int readTimeout(byte[] buf, int off, int len, int milliseconds) throws IOException
+    {
+        checkRegion(buf, off, len);
+        Object event = HIDEvents.events.begin(HIDEvents.READ);
+        int n = -1;
+        try
+        {
+            n = readTimeoutRegion(buf, off, len, milliseconds);
+            return n;
+        } finally
+        {
+            endRead(event, n, milliseconds);
+        }
+    }
     
+    /**
+     * Write an Output Report to a HID device from a buffer. The
+     * bytes between the buffer's position and limit are sent and the
+     * position is advanced by the number of bytes written. Direct
+     * buffers are passed to the device without copying.
+     *
+     * @param data the data to send, including the report number as the first byte
+     * @return the actual number of bytes written
+     * @throws IOException if write error occured
+     */
+    public int write(ByteBuffer data) throws IOException
+    {
+        Object event = HIDEvents.events.begin(HIDEvents.WRITE);
+        int pos = data.position();
+        int n = -1;
+        try
+        {
+            if(data.isDirect())
+                n = writeDirect(data, pos, data.remaining());
+            else if(data.hasArray())
+                n = writeRegion(data.array(), data.arrayOffset() + pos, data.remaining());
+            else
+            {
+                byte[] tmp = new byte[data.remaining()];
+                data.duplicate().get(tmp);
+                n = writeRegion(tmp, 0, tmp.length);
+            }
+        } finally
+        {
+            endWrite(event, n);
+        }
+        data.position(pos + n);
+        return n;
+    }
+
+    /**
+     * Read an Input Report from a HID device into a buffer. At most
+     * <code>buf.remaining()</code> bytes are stored starting at the
+     * buffer's position, and the position is advanced by the number
+     * of bytes read. Direct buffers are filled without copying.
+     *
+     * @param buf a buffer to put the read data into
+     * @return the actual number of bytes read
+     * @throws IOException if read error occured
+     */
+    public int read(ByteBuffer buf) throws IOException
+    {
+        Object event = HIDEvents.events.begin(HIDEvents.READ);
+        int pos = buf.position();
+        int n = -1;
+        try
+        {
+            if(buf.isDirect())
+                n = readDirect(buf, pos, buf.remaining());
+            else
+                n = readRegion(buf.array(), buf.arrayOffset() + pos, buf.remaining());
+        } finally
+        {
+            endRead(event, n, -1);
+        }
+        buf.position(pos + n);
+        return n;
+    }
+
+    /**
+     * Read an Input report from a HID device into a buffer with
+     * timeout. See {@link #read(ByteBuffer)} for how the buffer's
+     * position and limit are used.
+     *
+     * @param buf a buffer to put the read data into.
+     * @param milliseconds a timeout in milliseconds or -1 for blocking wait.
+     * @return the number of bytes read, or 0 on timeout
+     * @throws IOException if read error occured
+     */
+    public int readTimeout(ByteBuffer buf, int milliseconds) throws IOException
+    {
+        Object event = HIDEvents.events.begin(HIDEvents.READ);
+        int pos = buf.position();
+        int n = -1;
+        try
+        {
+            if(buf.isDirect())
+                n = readTimeoutDirect(buf, pos, buf.remaining(), milliseconds);
+            else
+                n = readTimeoutRegion(buf.array(), buf.arrayOffset() + pos, buf.remaining(), milliseconds);
+        } finally
+        {
+            endRead(event, n, milliseconds);
+        }
+        buf.position(pos + n);
+        return n;
+    }
+
+    /**
+     * Read a burst of Input reports in one call. Waits up to
+     * <code>milliseconds</code> for the first report and then takes
+     * every report that has already arrived, without blocking again,
+     * up to <code>maxReports</code>. Each report is stored from the
+     * buffer's position on as a 16-bit little-endian length followed
+     * by the report bytes, and the position is advanced past the
+     * last report stored.
+     *
+     * @param dst a direct buffer to put the reports into
+     * @param maxReports the maximum number of reports to read
+     * @param milliseconds a timeout in milliseconds or -1 for blocking wait.
+     * @return the number of reports read, or 0 on timeout
+     * @throws IOException if read error occured
+     * @throws IllegalArgumentException if <code>dst</code> is not a direct buffer
+     */
+    public int readMany(ByteBuffer dst, int maxReports, int milliseconds) throws IOException
+    {
+        if(!dst.isDirect())
+            throw new IllegalArgumentException("readMany() requires a direct buffer");
+        Object event = HIDEvents.events.begin(HIDEvents.READ);
+        int start = dst.position();
+        int pos = start;
+        int n = -1;
+        try
+        {
+            n = readManyDirect(dst, pos, dst.remaining(), maxReports, milliseconds);
+            for(int i=0; i<n; i++)
+                pos += 2 + ((dst.get(pos) & 0xff) | (dst.get(pos + 1) & 0xff) << 8);
+        } finally
+        {
+            if(event != null)
+                HIDEvents.events.endRead(event, this, n < 0 ? -1 : pos - start - 2 * n, Math.max(n, 0), milliseconds);
+        }
+        dst.position(pos);
+        return n;
+    }
+
+    /**
+     * Read an Input report from a HID device with timeout, along with
+     * the time it arrived. On Linux the time is on the same clock as
+     * <code>System.nanoTime()</code>; with the hidraw backend it is
+     * when the report was read unless the io_uring engine is used.
+     *
+     * @param buf a buffer to put the read data into.
+     * @param timestamp an array whose first element is set to the
+     *        arrival time in nanoseconds, if a report was read
+     * @param milliseconds a timeout in milliseconds or -1 for blocking wait.
+     * @return the number of bytes read, or 0 on timeout
+     * @throws IOException if read error occured, or arrival times
+     *         are not recorded on this platform
+     */
+    public int readTimestamped(byte[] buf, long[] timestamp, int milliseconds) throws IOException
+    {
+        if(timestamp.length < 1)
+            throw new IllegalArgumentException("timestamp must have room for one element");
+        Object event = HIDEvents.events.begin(HIDEvents.READ);
+        int n = -1;
+        try
+        {
+            n = readSequencedNative(buf, null, timestamp, milliseconds);
+            return n;
+        } finally
+        {
+            endRead(event, n, milliseconds);
+        }
+    }
+
+    /**
+     * Read an Input report from a HID device with timeout, along with
+     * its sequence number. Every report received is numbered, from 0
+     * when the device is opened, so a gap between the numbers of two
+     * reports read in turn is the number lost in between. See
+     * {@link #getDroppedCount()}.
+     *
+     * @param buf a buffer to put the read data into.
+     * @param sequence an array whose first element is set to the
+     *        sequence number, if a report was read
+     * @param timestamp an array whose first element is set to the
+     *        arrival time in nanoseconds, as for
+     *        {@link #readTimestamped(byte[], long[], int)}, or <code>null</code>
+     * @param milliseconds a timeout in milliseconds or -1 for blocking wait.
+     * @return the number of bytes read, or 0 on timeout
+     * @throws IOException if read error occured, or reports are not
+     *         numbered on this platform
+     */
+    public int readSequenced(byte[] buf, long[] sequence, long[] timestamp, int milliseconds) throws IOException
+    {
+        if(sequence.length < 1 || (timestamp != null && timestamp.length < 1))
+            throw new IllegalArgumentException("sequence and timestamp must have room for one element");
+        Object event = HIDEvents.events.begin(HIDEvents.READ);
+        int n = -1;
+        try
+        {
+            n = readSequencedNative(buf, sequence, timestamp, milliseconds);
+            return n;
+        } finally
+        {
+            endRead(event, n, milliseconds);
+        }
+    }
+
+    /**
+     * Get the counters the native library keeps for this device:
+     * reports and bytes transferred, drops, queue depth, read wake-ups
+     * and timeouts, write latency and errors. They are also published
+     * over JMX while the device is open, see {@link HIDDeviceStatsMBean}.
+     *
+     * @return a snapshot of the counters
+     * @throws IOException if counters are not kept on this platform
+     */
+    public HIDDeviceStats getStats() throws IOException
+    {
+        long[] values = new long[HIDDeviceStats.COUNTERS];
+        getStatsNative(values);
+        return new HIDDeviceStats(values);
+    }
+
+    /**
+     * Get one of this device's latency histograms. Recording a value
+     * takes a few atomic increments and no allocation, so histograms
+     * are always kept, from when the device is opened.
+     *
+     * @param kind which latency
+     * @param reset <code>true</code> to empty the histogram as it is
+     *        copied, so the next snapshot only covers what follows
+     * @return a snapshot of the histogram
+     * @throws IOException if histograms are not kept on this platform
+     */
+    public LatencyHistogram getLatencyHistogram(LatencyKind kind, boolean reset) throws IOException
+    {
+        long[] values = new long[LatencyHistogram.HEADER + LatencyHistogram.BUCKETS];
+        getLatencyHistogramNative(kind.ordinal(), values, reset);
+        return new LatencyHistogram(values);
+    }
+
+    /* Called by the native HIDDeviceInfo.open() */
+    void opened(String path)
+    {
+        this.path = path;
+        mbeanName = HIDDeviceMonitor.register(this, path);
+        HIDEvents.events.opened(this);
+    }
+
+    /* Called by the native close() before the device is freed */
+    private void closing()
+    {
+        ObjectName name = mbeanName;
+        if(name != null)
+        {
+            mbeanName = null;
+            HIDDeviceMonitor.unregister(name);
+        }
+        HIDEvents.events.closed(this);
+    }
+
+    /* The path this device was opened with */
+    String getPath()
+    {
+        return path;
+    }
+
+    /**
+     * Get the number of Input reports received but dropped, because
+     * the queue was full (see {@link #setInputQueue(int, OverflowPolicy)})
+     * or an input ring was full.
+     *
+     * @return the number of reports dropped since the device was opened
+     * @throws IOException if dropped reports are not counted on this platform
+     */
+    public native long getDroppedCount() throws IOException;
+
     /** 
      * Enable blocking reads for this <code>HIDDevice</code> object.
      */
@@ -109,6 +462,189 @@ public class HIDDevice
      */
     public native void disableBlocking() throws IOException;
 
+    /**
+     * Configure the queue that buffers Input reports until they are read.
+     * By default up to 30 reports are queued and the oldest is dropped
+     * when another arrives. Reports already queued are kept, apart from
+     * the oldest ones if the new capacity is smaller.
+     * <p>
+     * Only supported by the libusb backend; the other backends leave
+     * buffering to the operating system and throw <code>IOException</code>.
+     *
+     * @param capacity the maximum number of reports to queue, at least 1
+     * @param policy what to do with a report that arrives when the queue is full
+     * @throws IOException if the queue could not be configured
+     */
+    public void setInputQueue(int capacity, OverflowPolicy policy) throws IOException
+    {
+        if(capacity < 1)
+            throw new IllegalArgumentException("capacity must be at least 1");
+        setInputQueueNative(capacity, policy.ordinal());
+    }
+
+    /**
+     * Set how many Input transfers are kept in flight. With more than
+     * one, the device can be polled again while a completed transfer
+     * is being handled, so fast devices don't have to hold reports back.
+     * Reports are still delivered in the order they arrived. The
+     * default is 1.
+     * <p>
+     * Only supported by the libusb backend; the other backends throw
+     * <code>IOException</code>.
+     *
+     * @param count the number of transfers, from 1 to 8
+     * @throws IOException if the number could not be changed
+     */
+    public native void setInputTransfers(int count) throws IOException;
+
+    /**
+     * Get a file descriptor which becomes readable when Input reports
+     * are available, or once the device is disconnected, for use in an
+     * external event loop. Wait on it only; read the reports with
+     * <code>readTimeout(buf, 0)</code>. It stays valid until the device
+     * is closed.
+     * <p>
+     * Only supported on Linux.
+     *
+     * @return a file descriptor
+     * @throws IOException if the platform has no such descriptor
+     */
+    public native int getPollFd() throws IOException;
+
+    /**
+     * Have Input reports delivered to a listener as they arrive instead
+     * of reading them. One native thread waits on all devices with a
+     * listener and passes on every report queued since the last call
+     * at once. Don't read the device while a listener is set.
+     * <p>
+     * The listener is called on that thread when <code>executor</code>
+     * is <code>null</code>, and must then return quickly, or else from
+     * a task given to the executor. Use a single-threaded executor to
+     * keep the reports in order. The device is not garbage collected
+     * while it has a listener. A listener can't be set while an input
+     * ring is open, since the ring then takes the reports.
+     * <p>
+     * Not supported on Windows and Mac OS X.
+     *
+     * @param listener the listener, or <code>null</code> to stop delivery
+     * @param executor runs the listener, or <code>null</code>
+     * @throws IOException if reports can't be delivered for this device
+     * @throws IllegalStateException if an input ring is open
+     */
+    public synchronized void setInputListener(InputReportListener listener, Executor executor) throws IOException
+    {
+        if(listener != null && inputRing != null)
+            throw new IllegalStateException("an input ring is open");
+        if(listener == null)
+        {
+            stopInput();
+            inputListener = null;
+            inputExecutor = null;
+            return;
+        }
+        boolean started = inputListener != null;
+        inputExecutor = executor;
+        inputListener = listener;
+        if(!started)
+        {
+            try
+            {
+                startInput();
+            } catch(IOException e)
+            {
+                inputListener = null;
+                inputExecutor = null;
+                throw e;
+            }
+        }
+    }
+
+    /**
+     * Have Input reports written into a ring in a direct buffer as they
+     * arrive instead of being queued for <code>read()</code>. Taking a
+     * report out of the ring needs no JNI call, which makes this the
+     * cheapest way to receive reports from a fast device. Reports which
+     * don't fit are dropped and counted. A ring opened before is
+     * closed. A ring can't be opened while an input listener is set.
+     * <p>
+     * Only supported on Linux, with a JVM that has
+     * <code>sun.misc.Unsafe</code>.
+     *
+     * @param size the space for reports in bytes, rounded up to a power
+     *        of two. Each report takes its length plus 16 bytes, rounded
+     *        up to a multiple of 8.
+     * @return the ring
+     * @throws IOException if the ring could not be set up
+     * @throws IllegalStateException if an input listener is set
+     */
+    public synchronized InputRing openInputRing(int size) throws IOException
+    {
+        if(inputListener != null)
+            throw new IllegalStateException("an input listener is set");
+        if(inputRing != null)
+            closeInputRing(inputRing);
+        inputRing = new InputRing(this, size);
+        return inputRing;
+    }
+
+    synchronized void closeInputRing(InputRing ring) throws IOException
+    {
+        if(ring != inputRing)
+            return;
+        detachInputRing();
+        inputRing = null;
+    }
+
+    /* Called by the native reader thread; these mustn't lock this
+       object, which setInputListener() holds while waiting for them. */
+
+    private void deliverInputReports(byte[] packed, int count)
+    {
+        final InputReportListener listener = inputListener;
+        if(listener == null)
+            return;
+        final byte[][] reports = new byte[count][];
+        int pos = 0;
+        for(int i=0; i<count; i++)
+        {
+            int len = (packed[pos] & 0xff) | (packed[pos + 1] & 0xff) << 8;
+            reports[i] = new byte[len];
+            System.arraycopy(packed, pos + 2, reports[i], 0, len);
+            pos += 2 + len;
+        }
+        runInput(new Runnable()
+        {
+            public void run()
+            {
+                listener.inputReportsReceived(HIDDevice.this, reports);
+            }
+        });
+    }
+
+    private void inputFailed()
+    {
+        final InputReportListener listener = inputListener;
+        if(listener == null)
+            return;
+        final IOException e = new IOException("Reading Input reports failed");
+        runInput(new Runnable()
+        {
+            public void run()
+            {
+                listener.inputFailed(HIDDevice.this, e);
+            }
+        });
+    }
+
+    private void runInput(Runnable task)
+    {
+        Executor executor = inputExecutor;
+        if(executor == null)
+            task.run();
+        else
+            executor.execute(task);
+    }
+
     /**
      * Send a Feature Report to the HID device.
      * @param data The data to send, including the report number as the first byte
@@ -116,6 +652,40 @@ public class HIDDevice
      * @throws IOException
      */
     public native int sendFeatureReport(byte[] data) throws IOException;
+
+    /**
+     * Send a Feature Report to the HID device from a buffer. The bytes
+     * between the buffer's position and limit are sent and the
+     * position is advanced by the number of bytes written.
+     * @param data The data to send, including the report number as the first byte
+     * @return the actual number of bytes written
+     * @throws IOException
+     */
+    public int sendFeatureReport(ByteBuffer data) throws IOException
+    {
+        int pos = data.position();
+        int n = -1;
+        if(data.isDirect())
+        {
+            Object event = HIDEvents.events.begin(HIDEvents.FEATURE_REPORT);
+            try
+            {
+                n = sendFeatureReportDirect(data, pos, data.remaining());
+            } finally
+            {
+                endFeatureReport(event, false, n);
+            }
+        }
+        else
+        {
+            // The native method records the event.
+            byte[] tmp = new byte[data.remaining()];
+            data.duplicate().get(tmp);
+            n = sendFeatureReport(tmp);
+        }
+        data.position(pos + n);
+        return n;
+    }
     
     /** 
      * Get a Feature Report from a HID device.
@@ -124,6 +694,42 @@ public class HIDDevice
      * @throws IOException
      */
     public native int getFeatureReport(byte[] buf) throws IOException;
+
+    /** 
+     * Get a Feature Report from a HID device into a buffer. The byte
+     * at the buffer's position must hold the report number; the
+     * report is stored from there and the position is advanced by
+     * the number of bytes read.
+     * @param buf a buffer to put the read data into
+     * @return the actual number of bytes read
+     * @throws IOException
+     */
+    public int getFeatureReport(ByteBuffer buf) throws IOException
+    {
+        int pos = buf.position();
+        int n = -1;
+        if(buf.isDirect())
+        {
+            Object event = HIDEvents.events.begin(HIDEvents.FEATURE_REPORT);
+            try
+            {
+                n = getFeatureReportDirect(buf, pos, buf.remaining());
+            } finally
+            {
+                endFeatureReport(event, true, n);
+            }
+        }
+        else
+        {
+            // The native method records the event.
+            byte[] tmp = new byte[buf.remaining()];
+            buf.duplicate().get(tmp);
+            n = getFeatureReport(tmp);
+            buf.duplicate().put(tmp, 0, n);
+        }
+        buf.position(pos + n);
+        return n;
+    }
     
     /**
      * Get The Manufacturer String from a HID device.
@@ -153,5 +759,49 @@ public class HIDDevice
      * @throws IOException
      */
     public native String getIndexedString(int string_index) throws IOException;
+
+    private static void checkRegion(byte[] b, int off, int len)
+    {
+        if(off < 0 || len < 0 || len > b.length - off)
+            throw new IndexOutOfBoundsException();
+    }
+
+    /* End the Flight Recorder event of a read of one report, if one was begun. */
+    private void endRead(Object event, int bytes, int milliseconds)
+    {
+        if(event != null)
+            HIDEvents.events.endRead(event, this, bytes, bytes > 0 ? 1 : 0, milliseconds);
+    }
+
+    private void endWrite(Object event, int bytes)
+    {
+        if(event != null)
+            HIDEvents.events.endWrite(event, this, bytes);
+    }
+
+    private void endFeatureReport(Object event, boolean get, int bytes)
+    {
+        if(event != null)
+            HIDEvents.events.endFeatureReport(event, this, get, bytes);
+    }
+
+    private native int writeRegion(byte[] data, int off, int len) throws IOException;
+    private native int readRegion(byte[] buf, int off, int len) throws IOException;
+    private native int readTimeoutRegion(byte[] buf, int off, int len, int milliseconds) throws IOException;
+    private native int writeDirect(ByteBuffer data, int offset, int length) throws IOException;
+    private native int readDirect(ByteBuffer buf, int offset, int length) throws IOException;
+    private native int readTimeoutDirect(ByteBuffer buf, int offset, int length, int milliseconds) throws IOException;
+    private native int readManyDirect(ByteBuffer dst, int offset, int length, int maxReports, int milliseconds) throws IOException;
+    private native int sendFeatureReportDirect(ByteBuffer data, int offset, int length) throws IOException;
+    private native int getFeatureReportDirect(ByteBuffer buf, int offset, int length) throws IOException;
+    private native void setInputQueueNative(int capacity, int policy) throws IOException;
+    private native void startInput() throws IOException;
+    private native void stopInput() throws IOException;
+    native void attachInputRing(ByteBuffer ring, int offset, int length) throws IOException;
+    private native void detachInputRing() throws IOException;
+    native int waitInputRing(int milliseconds) throws IOException;
+    private native void getStatsNative(long[] values) throws IOException;
+    private native void getLatencyHistogramNative(int kind, long[] values, boolean reset) throws IOException;
+    private native int readSequencedNative(byte[] buf, long[] sequence, long[] timestamp, int milliseconds) throws IOException;
     
 }
@@ -0,0 +1,49 @@
+package com.codeminders.hidapi;
+
+/**
+ * Selects HID devices by their vendor and product IDs. Override
+ * {@link #matches(HIDDeviceInfo)} to select them otherwise.
+ */
+public class HIDDeviceFilter
+{
+    private final int vendor_id;
+    private final int product_id;
+
+    /**
+     * Select every device.
+     */
+    public HIDDeviceFilter()
+    {
+        this(0, 0);
+    }
+
+    /**
+     * Select devices by their IDs.
+     *
+     * @param vendor_id USB vendor ID, or 0 for any
+     * @param product_id USB product ID, or 0 for any
+     */
+    public HIDDeviceFilter(int vendor_id, int product_id)
+    {
+        this.vendor_id = vendor_id;
+        this.product_id = product_id;
+    }
+
+    /**
+     * Check whether a device is selected.
+     *
+     * @param device the device
+     * @return <code>true</code> if it is
+     */
+    public boolean matches(HIDDeviceInfo device)
+    {
+        return (vendor_id == 0 || device.getVendor_id() == vendor_id)
+                && (product_id == 0 || device.getProduct_id() == product_id);
+    }
+
+    @Override
+    public String toString()
+    {
+        return "HIDDeviceFilter [vendor_id=" + vendor_id + ", product_id=" + product_id + "]";
+    }
+}
@@ -20,6 +20,7 @@ public class HIDDeviceInfo
     private int    usage_page;
     private int    usage;
     private int    interface_number;
+    private String backend;
 
     /**
      * Protected constructor, used from JNI Allocates a new
@@ -123,9 +124,21 @@ public class HIDDeviceInfo
         return interface_number;
     }
     
+    /**
+     * Get the name of the implementation which found the device, see
+     * {@link HIDManager#setBackend(String)}. The device is opened
+     * through it, whichever is selected.
+     * @return the string value
+     */
+    public String getBackend()
+    {
+        return backend;
+    }
+    
     /**
      *  Open a HID device using a path name from this class.  
-     *  Used from JNI.
+     *  Its counters are registered over JMX until it is closed,
+     *  see {@link HIDDeviceStatsMBean}.
      *
      * @return return a reference to the <code>HIDDevice<code> object
      * @throws IOException
@@ -161,6 +174,8 @@ public class HIDDeviceInfo
         builder.append(usage);
         builder.append(", interface_number=");
         builder.append(interface_number);
+        builder.append(", backend=");
+        builder.append(backend);
         builder.append("]");
         return builder.toString();
     }
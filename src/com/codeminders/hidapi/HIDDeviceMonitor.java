@@ -0,0 +1,140 @@
+package com.codeminders.hidapi;
+
+import java.io.IOException;
+import java.lang.management.ManagementFactory;
+import java.lang.ref.WeakReference;
+import java.util.concurrent.atomic.AtomicLong;
+
+import javax.management.MBeanServer;
+import javax.management.ObjectName;
+import javax.management.StandardMBean;
+
+/**
+ * Registers an open device's counters with the platform MBean server,
+ * see {@link HIDDeviceStatsMBean}. Each attribute is read from the
+ * native library when it is asked for. The device is only weakly
+ * referenced, so one that is never closed can still be finalized,
+ * which unregisters it.
+ */
+class HIDDeviceMonitor implements HIDDeviceStatsMBean
+{
+    private static final AtomicLong nextId = new AtomicLong();
+    private static final HIDDeviceStats EMPTY = new HIDDeviceStats(new long[HIDDeviceStats.COUNTERS]);
+
+    private final WeakReference<HIDDevice> device;
+
+    private HIDDeviceMonitor(HIDDevice device)
+    {
+        this.device = new WeakReference<HIDDevice>(device);
+    }
+
+    /**
+     * Register a device which has just been opened.
+     *
+     * @param device the device
+     * @param path the path it was opened with
+     * @return the name it was registered under, or <code>null</code>
+     *         if it could not be registered
+     */
+    static ObjectName register(HIDDevice device, String path)
+    {
+        try
+        {
+            ObjectName name = new ObjectName("com.codeminders.hidapi:type=HIDDevice,id="
+                    + nextId.incrementAndGet() + ",path=" + ObjectName.quote(path));
+            MBeanServer server = ManagementFactory.getPlatformMBeanServer();
+            server.registerMBean(new StandardMBean(new HIDDeviceMonitor(device), HIDDeviceStatsMBean.class), name);
+            return name;
+        } catch(Exception e)
+        {
+            // Monitoring is optional; the device is still usable.
+            return null;
+        }
+    }
+
+    /**
+     * Unregister a device which is being closed.
+     *
+     * @param name the name returned by {@link #register(HIDDevice, String)}
+     */
+    static void unregister(ObjectName name)
+    {
+        try
+        {
+            ManagementFactory.getPlatformMBeanServer().unregisterMBean(name);
+        } catch(Exception e)
+        {
+            // Already gone.
+        }
+    }
+
+    private HIDDeviceStats stats()
+    {
+        HIDDevice dev = device.get();
+        if(dev == null)
+            return EMPTY;
+        try
+        {
+            return dev.getStats();
+        } catch(IOException e)
+        {
+            // Closed while being read.
+            return EMPTY;
+        }
+    }
+
+    public long getReportsReceived()
+    {
+        return stats().getReportsReceived();
+    }
+
+    public long getBytesIn()
+    {
+        return stats().getBytesIn();
+    }
+
+    public long getBytesOut()
+    {
+        return stats().getBytesOut();
+    }
+
+    public long getReportsDropped()
+    {
+        return stats().getReportsDropped();
+    }
+
+    public long getQueueHighWater()
+    {
+        return stats().getQueueHighWater();
+    }
+
+    public long getReadWakeups()
+    {
+        return stats().getReadWakeups();
+    }
+
+    public long getReadTimeouts()
+    {
+        return stats().getReadTimeouts();
+    }
+
+    public long getWrites()
+    {
+        return stats().getWrites();
+    }
+
+    public long getWriteTimeTotal()
+    {
+        return stats().getWriteTimeTotal();
+    }
+
+    public long getWriteTimeMax()
+    {
+        return stats().getWriteTimeMax();
+    }
+
+    public long getTransferErrors()
+    {
+        return stats().getTransferErrors();
+    }
+}
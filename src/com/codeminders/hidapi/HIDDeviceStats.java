@@ -0,0 +1,146 @@
+package com.codeminders.hidapi;
+
+/**
+ * A snapshot of the counters the native library keeps for an open
+ * device, see {@link HIDDevice#getStats()}. The counters start at 0
+ * when the device is opened.
+ * <p>
+ * The fields match <code>struct hid_device_stats</code> in hidapi.h.
+ */
+public final class HIDDeviceStats implements HIDDeviceStatsMBean
+{
+    /* The number of counters, in the order of struct hid_device_stats */
+    static final int COUNTERS = 11;
+
+    private final long[] values;
+
+    HIDDeviceStats(long[] values)
+    {
+        this.values = values;
+    }
+
+    /**
+     * @return the number of Input reports received from the device
+     */
+    public long getReportsReceived()
+    {
+        return values[0];
+    }
+
+    /**
+     * @return the number of bytes of Input reports received
+     */
+    public long getBytesIn()
+    {
+        return values[1];
+    }
+
+    /**
+     * @return the number of bytes of Output reports written
+     */
+    public long getBytesOut()
+    {
+        return values[2];
+    }
+
+    /**
+     * @return the number of Input reports dropped, see
+     *         {@link HIDDevice#getDroppedCount()}
+     */
+    public long getReportsDropped()
+    {
+        return values[3];
+    }
+
+    /**
+     * @return the most Input reports that have been queued at once
+     */
+    public long getQueueHighWater()
+    {
+        return values[4];
+    }
+
+    /**
+     * @return how many times a reader waiting for an Input report woke up
+     */
+    public long getReadWakeups()
+    {
+        return values[5];
+    }
+
+    /**
+     * @return the number of reads that returned 0 because their timeout expired
+     */
+    public long getReadTimeouts()
+    {
+        return values[6];
+    }
+
+    /**
+     * @return the number of successful writes
+     */
+    public long getWrites()
+    {
+        return values[7];
+    }
+
+    /**
+     * @return the total time spent in successful writes, in nanoseconds
+     */
+    public long getWriteTimeTotal()
+    {
+        return values[8];
+    }
+
+    /**
+     * @return the longest time spent in a successful write, in nanoseconds
+     */
+    public long getWriteTimeMax()
+    {
+        return values[9];
+    }
+
+    /**
+     * @return the number of reads and writes that failed, including
+     *         when the device was disconnected
+     */
+    public long getTransferErrors()
+    {
+        return values[10];
+    }
+
+    /**
+     *  Override method for conversion this object to <code>String<code> object.
+     *
+     * @return return a reference to the <code>String<code> object
+     */
+    @Override
+    public String toString()
+    {
+        StringBuilder builder = new StringBuilder();
+        builder.append("HIDDeviceStats [reportsReceived=");
+        builder.append(values[0]);
+        builder.append(", bytesIn=");
+        builder.append(values[1]);
+        builder.append(", bytesOut=");
+        builder.append(values[2]);
+        builder.append(", reportsDropped=");
+        builder.append(values[3]);
+        builder.append(", queueHighWater=");
+        builder.append(values[4]);
+        builder.append(", readWakeups=");
+        builder.append(values[5]);
+        builder.append(", readTimeouts=");
+        builder.append(values[6]);
+        builder.append(", writes=");
+        builder.append(values[7]);
+        builder.append(", writeTimeTotal=");
+        builder.append(values[8]);
+        builder.append(", writeTimeMax=");
+        builder.append(values[9]);
+        builder.append(", transferErrors=");
+        builder.append(values[10]);
+        builder.append("]");
+        return builder.toString();
+    }
+}
@@ -0,0 +1,32 @@
+package com.codeminders.hidapi;
+
+/**
+ * The counters of an open device, as seen over JMX. Every open device
+ * is registered with the platform MBean server under
+ * <code>com.codeminders.hidapi:type=HIDDevice,id=<i>n</i>,path=<i>path</i></code>
+ * until it is closed. See {@link HIDDeviceStats} for what each one counts.
+ */
+public interface HIDDeviceStatsMBean
+{
+    long getReportsReceived();
+
+    long getBytesIn();
+
+    long getBytesOut();
+
+    long getReportsDropped();
+
+    long getQueueHighWater();
+
+    long getReadWakeups();
+
+    long getReadTimeouts();
+
+    long getWrites();
+
+    long getWriteTimeTotal();
+
+    long getWriteTimeMax();
+
+    long getTransferErrors();
+}
@@ -0,0 +1,104 @@
+package com.codeminders.hidapi;
+
+/**
+ * Emits Java Flight Recorder events for HID operations. The events
+ * themselves are in <code>src-jfr</code>, which is only compiled by a
+ * JDK that has Flight Recorder; on older JVMs, or when it wasn't
+ * compiled, this class is used as is and every method does nothing.
+ * <p>
+ * An operation is bracketed by {@link #begin(int)} and one of the
+ * <code>end</code> methods, which must only be called with a non-null
+ * event. While an event type is disabled, <code>begin()</code> is an
+ * inlined check of a flag and allocates nothing.
+ * <p>
+ * Methods which have always been native, such as
+ * <code>HIDDevice.write(byte[])</code> and
+ * <code>HIDManager.listDevices()</code>, keep their names so that the
+ * prebuilt libraries still bind to them, and call these methods from
+ * native code (see hid-java.cpp). That code skips the calls when
+ * this class is used as is.
+ */
+class HIDEvents
+{
+    static final int READ = 0;
+    static final int WRITE = 1;
+    static final int FEATURE_REPORT = 2;
+    static final int ENUMERATE = 3;
+    static final int OPEN = 4;
+
+    static final HIDEvents events = load();
+
+    /**
+     * Start timing an operation.
+     *
+     * @param type one of the constants above
+     * @return the event to end, or <code>null</code> if this type of
+     *         event is not being recorded
+     */
+    Object begin(int type)
+    {
+        return null;
+    }
+
+    /**
+     * @param bytes the number of bytes read, 0 on timeout or -1 if
+     *        the read failed
+     * @param reports the number of reports read
+     * @param timeout the timeout in milliseconds, or -1 for none
+     */
+    void endRead(Object event, HIDDevice device, int bytes, int reports, int timeout)
+    {
+    }
+
+    /**
+     * @param bytes the number of bytes written, or -1 if the write failed
+     */
+    void endWrite(Object event, HIDDevice device, int bytes)
+    {
+    }
+
+    /**
+     * @param get <code>true</code> for getFeatureReport()
+     * @param bytes the number of bytes transferred, or -1 on failure
+     */
+    void endFeatureReport(Object event, HIDDevice device, boolean get, int bytes)
+    {
+    }
+
+    /**
+     * @param devices the number of devices found, or -1 on failure
+     */
+    void endEnumerate(Object event, int devices)
+    {
+    }
+
+    /**
+     * @param device the device opened, or <code>null</code> on failure
+     */
+    void endOpen(Object event, String path, HIDDevice device)
+    {
+    }
+
+    /* Open devices are watched for dropped reports. */
+
+    void opened(HIDDevice device)
+    {
+    }
+
+    void closed(HIDDevice device)
+    {
+    }
+
+    private static HIDEvents load()
+    {
+        try
+        {
+            Class.forName("jdk.jfr.Event");
+            return (HIDEvents) Class.forName("com.codeminders.hidapi.FlightRecorderEvents").newInstance();
+        } catch(Throwable e)
+        {
+            // No Flight Recorder, or the events weren't compiled in.
+            return new HIDEvents();
+        }
+    }
+}
@@ -2,6 +2,8 @@
 package com.codeminders.hidapi;
 
 import java.io.IOException;
+import java.util.List;
+import java.util.concurrent.CopyOnWriteArrayList;
 
 /**
  * HIDManager.java 
@@ -18,6 +20,24 @@ public class HIDManager
 	  
     protected long peer;
 
+    /* hid_hotplug_event values. */
+    private static final int HOTPLUG_ARRIVED = 1;
+    private static final int HOTPLUG_LEFT = 2;
+
+    private static class HotplugRegistration
+    {
+        final HIDDeviceFilter filter;
+        final HotplugListener listener;
+
+        HotplugRegistration(HIDDeviceFilter filter, HotplugListener listener)
+        {
+            this.filter = filter;
+            this.listener = listener;
+        }
+    }
+
+    private final List<HotplugRegistration> hotplugListeners = new CopyOnWriteArrayList<HotplugRegistration>();
+
     /**
      * Get list of all the HID devices attached to the system.
      *
@@ -26,6 +46,107 @@ public class HIDManager
      */
     public native HIDDeviceInfo[] listDevices() throws IOException;
 
+    /**
+     * Get list of the HID devices found by one implementation,
+     * whichever is selected with {@link #setBackend(String)}.
+     *
+     * @param backend the name of the implementation, or <code>null<code>
+     *        for the one selected
+     * @return list of devices
+     * @throws IOException if there is no such implementation
+     */
+    public HIDDeviceInfo[] listDevices(String backend) throws IOException
+    {
+        return listDevicesNative(backend);
+    }
+
+    private native HIDDeviceInfo[] listDevicesNative(String backend) throws IOException;
+
+    /**
+     * Select the implementation used from now on by
+     * {@link #listDevices()}, {@link #openByPath(String)} and
+     * {@link #openById(int, int, String)}. On Linux these are
+     * "hidraw", "libusb" and "mock", and the library starts with the
+     * one named by the HIDAPI_BACKEND environment variable, or
+     * "libusb". Devices already open keep their implementation.
+     *
+     * @param backend the name of the implementation
+     * @throws IOException if there is no such implementation
+     */
+    public native void setBackend(String backend) throws IOException;
+
+    /**
+     * Get the name of the implementation selected.
+     *
+     * @return the name, see {@link #setBackend(String)}
+     */
+    public native String getBackend();
+
+    /**
+     * Have a listener told when devices are connected and
+     * disconnected, instead of calling {@link #listDevices()} over and
+     * over. Devices already connected are not reported, so list them
+     * first.
+     * <p>
+     * One native thread watches all devices, through a udev monitor
+     * with the "hidraw" implementation and libusb's hotplug support
+     * with "libusb"; it uses the one selected when the first listener
+     * is added, see {@link #setBackend(String)}. It calls the
+     * listeners, which must return quickly, and must not call
+     * {@link #release()}. It stops when the last listener is removed.
+     * <p>
+     * Only supported on Linux.
+     *
+     * @param filter the devices to report, or <code>null<code> for all
+     * @param listener the listener
+     * @throws IOException if notifications are not supported
+     */
+    public synchronized void addHotplugListener(HIDDeviceFilter filter, HotplugListener listener) throws IOException
+    {
+        // Does nothing while the thread runs; starts it again if it
+        // stopped because the monitor failed.
+        startHotplug();
+        hotplugListeners.add(new HotplugRegistration(filter, listener));
+    }
+
+    /**
+     * Stop telling a listener about devices. It may still be told
+     * about one while this runs.
+     *
+     * @param listener a listener given to
+     *        {@link #addHotplugListener(HIDDeviceFilter, HotplugListener)}
+     */
+    public synchronized void removeHotplugListener(HotplugListener listener)
+    {
+        boolean removed = false;
+        for(HotplugRegistration r : hotplugListeners)
+        {
+            if(r.listener == listener)
+                removed |= hotplugListeners.remove(r);
+        }
+        if(removed && hotplugListeners.isEmpty())
+            stopHotplug();
+    }
+
+    private native void startHotplug() throws IOException;
+
+    private native void stopHotplug();
+
+    /* Called by the native hotplug thread; this mustn't lock this
+       object, which removeHotplugListener() holds while waiting for it. */
+    private void hotplugEvent(int event, HIDDeviceInfo device)
+    {
+        for(HotplugRegistration r : hotplugListeners)
+        {
+            if(r.filter != null && !r.filter.matches(device))
+                continue;
+            if(event == HOTPLUG_ARRIVED)
+                r.listener.deviceArrived(device);
+            else if(event == HOTPLUG_LEFT)
+                r.listener.deviceLeft(device);
+        }
+    }
+
     /**
      * Initializing the underlying HID layer.
      *
@@ -82,7 +203,26 @@ public class HIDManager
      */
     public HIDDevice openByPath(String path) throws IOException, HIDDeviceNotFoundException
     {
-        HIDDeviceInfo[] devs = listDevices();
+        return openByPath(path, null);
+    }
+
+    /**
+     * Convenience method to find and open device by path, through
+     * one implementation.
+     * 
+     * @param path device path, as the implementation gives it
+     * @param backend the name of the implementation, or <code>null<code>
+     *        for the one selected, see {@link #setBackend(String)}
+     * @return open device reference <code>HIDDevice<code> object
+     * @throws IOException in case of internal error, or if there is no
+     *         such implementation
+     * @throws HIDDeviceNotFoundException if devive was not found
+     */
+    public HIDDevice openByPath(String path, String backend) throws IOException, HIDDeviceNotFoundException
+    {
+        HIDDeviceInfo[] devs = listDevices(backend);
+        if(devs == null)
+            throw new HIDDeviceNotFoundException();
         for(HIDDeviceInfo d : devs)
         {
             if(d.getPath().equals(path))
@@ -104,7 +244,29 @@ public class HIDManager
      */
     public HIDDevice openById(int vendor_id, int product_id, String serial_number) throws IOException, HIDDeviceNotFoundException
     {
-        HIDDeviceInfo[] devs = listDevices();
+        return openById(vendor_id, product_id, serial_number, null);
+    }
+
+    /**
+     * Convenience method to open a HID device using a Vendor ID
+     * (VID), Product ID (PID) and optionally a serial number, through
+     * one implementation.
+     * 
+     * @param vendor_id USB vendor ID
+     * @param product_id USB product ID
+     * @param serial_number USB device serial number (could be <code>null<code>)
+     * @param backend the name of the implementation, or <code>null<code>
+     *        for the one selected, see {@link #setBackend(String)}
+     * @return open device
+     * @throws IOException in case of internal error, or if there is no
+     *         such implementation
+     * @throws HIDDeviceNotFoundException if devive was not found
+     */
+    public HIDDevice openById(int vendor_id, int product_id, String serial_number, String backend) throws IOException, HIDDeviceNotFoundException
+    {
+        HIDDeviceInfo[] devs = listDevices(backend);
+        if(devs == null)
+            throw new HIDDeviceNotFoundException();
         for(HIDDeviceInfo d : devs)
         {
             if(d.getVendor_id() == vendor_id && d.getProduct_id() == product_id
@@ -0,0 +1,129 @@
+package com.codeminders.hidapi;
+
+import java.io.IOException;
+import java.util.HashMap;
+import java.util.Map;
+
+/**
+ * Waits for Input reports from many open devices at once, so that one
+ * thread can service them all instead of blocking a thread per device
+ * in {@link HIDDevice#read(byte[])}.
+ * <p>
+ * Register devices, call {@link #select(HIDDevice[], int)} in a loop
+ * and read from the devices it returns, typically with
+ * <code>readTimeout(buf, 0)</code>. A device stays selected until
+ * everything queued for it has been read. A disconnected device is
+ * selected too, and reading from it throws <code>IOException</code>.
+ * <p>
+ * Only supported on Linux.
+ */
+public class HIDSelector
+{
+    protected long peer;
+
+    private final Map<Long, HIDDevice> devices = new HashMap<Long, HIDDevice>();
+    private long[] ready = new long[0];
+
+    /**
+     * Create a selector.
+     *
+     * @throws IOException if selectors are not supported on this
+     * platform or the selector could not be created
+     */
+    public HIDSelector() throws IOException
+    {
+        init();
+    }
+
+    /**
+     * Destructor to destroy the <code>HIDSelector</code> object.
+     * Calls the close() native method.
+     * @throws Throwable
+     */
+    protected void finalize() throws Throwable
+    {
+        try
+        {
+           close();
+        } finally
+        {
+           super.finalize();
+        }
+    }
+
+    /**
+     * Add a device to this selector. The device must be unregistered
+     * before it is closed.
+     * <p>
+     * A selector only takes devices of the implementation which was
+     * selected with {@link HIDManager#setBackend(String)} when it was
+     * created; a device opened through another one can't be added.
+     *
+     * @param device an open device
+     * @throws IOException if the device could not be added, or was
+     *         opened through another implementation
+     */
+    public void register(HIDDevice device) throws IOException
+    {
+        addDevice(device.peer);
+        synchronized(devices)
+        {
+            devices.put(device.peer, device);
+        }
+    }
+
+    /**
+     * Remove a device from this selector.
+     *
+     * @param device a device added with <code>register()</code>
+     * @throws IOException if the device could not be removed
+     */
+    public void unregister(HIDDevice device) throws IOException
+    {
+        synchronized(devices)
+        {
+            devices.remove(device.peer);
+        }
+        removeDevice(device.peer);
+    }
+
+    /**
+     * Wait for registered devices to have Input reports to read.
+     * Should be called from one thread at a time.
+     *
+     * @param selected an array to put the selected devices into
+     * @param milliseconds a timeout in milliseconds or -1 for blocking wait.
+     * @return the number of devices stored in <code>selected</code>,
+     * or 0 on timeout
+     * @throws IOException if waiting failed
+     */
+    public int select(HIDDevice[] selected, int milliseconds) throws IOException
+    {
+        if(ready.length < selected.length)
+            ready = new long[selected.length];
+        int n = waitDevices(ready, selected.length, milliseconds);
+        int count = 0;
+        synchronized(devices)
+        {
+            for(int i=0; i<n; i++)
+            {
+                // Skip devices unregistered by another thread meanwhile.
+                HIDDevice device = devices.get(ready[i]);
+                if(device != null)
+                    selected[count++] = device;
+            }
+        }
+        return count;
+    }
+
+    /**
+     * Destroy this selector. The registered devices are not closed.
+     * Multiple calls allowed.
+     */
+    public native void close();
+
+    private native void init() throws IOException;
+    private native void addDevice(long device) throws IOException;
+    private native void removeDevice(long device) throws IOException;
+    private native int waitDevices(long[] ready, int max, int milliseconds) throws IOException;
+}
@@ -0,0 +1,22 @@
+package com.codeminders.hidapi;
+
+/**
+ * Told when HID devices are connected and disconnected. See
+ * {@link HIDManager#addHotplugListener(HIDDeviceFilter, HotplugListener)}.
+ */
+public interface HotplugListener
+{
+    /**
+     * Called when a device has been connected.
+     *
+     * @param device the device, which can be opened
+     */
+    void deviceArrived(HIDDeviceInfo device);
+
+    /**
+     * Called when a device has been disconnected.
+     *
+     * @param device the device, as it was described when it arrived
+     */
+    void deviceLeft(HIDDeviceInfo device);
+}
@@ -0,0 +1,28 @@
+package com.codeminders.hidapi;
+
+import java.io.IOException;
+
+/**
+ * Receives Input reports from a device as they arrive. See
+ * {@link HIDDevice#setInputListener(InputReportListener, java.util.concurrent.Executor)}.
+ */
+public interface InputReportListener
+{
+    /**
+     * Called with the reports that arrived since the last call.
+     *
+     * @param device the device the reports came from
+     * @param reports the reports, oldest first; each array holds one
+     *        report as <code>read()</code> would return it
+     */
+    void inputReportsReceived(HIDDevice device, byte[][] reports);
+
+    /**
+     * Called once when reading fails, usually because the device was
+     * disconnected. No more reports are delivered after it.
+     *
+     * @param device the device that failed
+     * @param e the error
+     */
+    void inputFailed(HIDDevice device, IOException e);
+}
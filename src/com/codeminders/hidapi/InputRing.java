@@ -0,0 +1,207 @@
+package com.codeminders.hidapi;
+
+import java.io.IOException;
+import java.lang.reflect.Field;
+import java.nio.Buffer;
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+
+import sun.misc.Unsafe;
+
+/**
+ * A ring of Input reports in a direct buffer which the native library
+ * writes to as reports arrive, see {@link HIDDevice#openInputRing(int)}.
+ * Taking a report out is a few memory reads; there is no JNI call
+ * unless the ring is empty and {@link #take(byte[], int)} has to wait.
+ * <p>
+ * The layout is <code>struct hid_input_ring</code> in hidapi.h. The
+ * positions are read with acquire and written with release ordering.
+ * <p>
+ * Only one thread may take reports out of a ring.
+ */
+public class InputRing
+{
+    /* Offsets in struct hid_input_ring and struct hid_input_record,
+       checked at build time by linux/hid-ring.h */
+    private static final int HEAD = 0;
+    private static final int TAIL = 64;
+    private static final int CAPACITY = 128;
+    private static final int DROPPED = 140;
+    private static final int FAILED = 144;
+    private static final int HEADER_SIZE = 192;
+    private static final int RECORD_LENGTH = 0;
+    private static final int RECORD_SEQUENCE = 4;
+    private static final int RECORD_TIMESTAMP = 8;
+    private static final int RECORD_HEADER_SIZE = 16;
+
+    private static final int WRAP = 0xffffffff;
+    private static final int ALIGNMENT = 64;
+
+    private static final Unsafe UNSAFE;
+    private static final long ADDRESS_OFFSET;
+
+    static
+    {
+        Unsafe unsafe = null;
+        long offset = -1;
+        try
+        {
+            Field field = Unsafe.class.getDeclaredField("theUnsafe");
+            field.setAccessible(true);
+            unsafe = (Unsafe) field.get(null);
+            offset = unsafe.objectFieldOffset(Buffer.class.getDeclaredField("address"));
+        } catch(Exception e)
+        {
+            unsafe = null;
+        }
+        UNSAFE = unsafe;
+        ADDRESS_OFFSET = offset;
+    }
+
+    private final HIDDevice device;
+    private final ByteBuffer ring;
+    private final long address;
+    private final int mask;
+    private int head;
+    private long timestamp;
+    private int sequence;
+
+    InputRing(HIDDevice device, int size) throws IOException
+    {
+        if(UNSAFE == null)
+            throw new IOException("Input rings are not supported on this JVM");
+
+        int capacity = 256;
+        while(capacity < size)
+            capacity *= 2;
+
+        // Align the header to a cache line, which the JVM doesn't.
+        ByteBuffer buf = ByteBuffer.allocateDirect(HEADER_SIZE + capacity + ALIGNMENT);
+        long base = UNSAFE.getLong(buf, ADDRESS_OFFSET);
+        int shift = (int) (-base & (ALIGNMENT - 1));
+        buf.position(shift);
+        buf.limit(shift + HEADER_SIZE + capacity);
+
+        this.device = device;
+        this.ring = buf.slice().order(ByteOrder.nativeOrder());
+        this.address = base + shift;
+        device.attachInputRing(ring, 0, ring.capacity());
+        this.mask = ring.getInt(CAPACITY) - 1;
+    }
+
+    /**
+     * Take the oldest report out of the ring without waiting.
+     *
+     * @param data a buffer for the report, which is truncated if it doesn't fit
+     * @return the number of bytes copied, or 0 if the ring is empty
+     */
+    public int poll(byte[] data)
+    {
+        int tail = UNSAFE.getIntVolatile(null, address + TAIL);
+        if(tail == head)
+            return 0;
+
+        int pos = HEADER_SIZE + (head & mask);
+        int len = ring.getInt(pos + RECORD_LENGTH);
+        if(len == WRAP)
+        {
+            head += mask + 1 - (head & mask);
+            pos = HEADER_SIZE;
+            len = ring.getInt(pos + RECORD_LENGTH);
+        }
+
+        timestamp = ring.getLong(pos + RECORD_TIMESTAMP);
+        sequence = ring.getInt(pos + RECORD_SEQUENCE);
+        int n = Math.min(len, data.length);
+        ring.position(pos + RECORD_HEADER_SIZE);
+        ring.get(data, 0, n);
+
+        // Hand the space back to the producer.
+        head += (RECORD_HEADER_SIZE + len + 7) & ~7;
+        UNSAFE.putOrderedInt(null, address + HEAD, head);
+        return n;
+    }
+
+    /**
+     * Take the oldest report out of the ring, waiting for one if it is
+     * empty.
+     *
+     * @param data a buffer for the report, which is truncated if it doesn't fit
+     * @param milliseconds timeout in milliseconds, or -1 to wait until a report arrives
+     * @return the number of bytes copied, or 0 on timeout
+     * @throws IOException if the device failed or the ring was closed,
+     *         and no reports are left
+     */
+    public int take(byte[] data, int milliseconds) throws IOException
+    {
+        while(isEmpty())
+        {
+            if(device.waitInputRing(milliseconds) == 0)
+                return 0;
+        }
+        return poll(data);
+    }
+
+    /**
+     * @return <code>true</code> if the ring has no reports
+     */
+    public boolean isEmpty()
+    {
+        return UNSAFE.getIntVolatile(null, address + TAIL) == head;
+    }
+
+    /**
+     * Get the arrival time of the report last taken out of the ring.
+     *
+     * @return the time in nanoseconds, on the same clock as
+     *         <code>System.nanoTime()</code> on Linux
+     */
+    public long getTimestamp()
+    {
+        return timestamp;
+    }
+
+    /**
+     * Get the sequence number of the report last taken out of the ring,
+     * see {@link HIDDevice#readSequenced(byte[], long[], long[], int)}.
+     * Only the low 32 bits are kept, so compare them with wrap-around:
+     * <code>getSequence() - last - 1</code> reports were lost in between.
+     *
+     * @return the low 32 bits of the sequence number
+     */
+    public int getSequence()
+    {
+        return sequence;
+    }
+
+    /**
+     * Get the number of reports which were dropped because the ring was
+     * full.
+     *
+     * @return the number of dropped reports
+     */
+    public int getDroppedCount()
+    {
+        return UNSAFE.getIntVolatile(null, address + DROPPED);
+    }
+
+    /**
+     * @return <code>true</code> once no more reports will be written to
+     *         the ring, because the device failed or the ring was closed
+     */
+    public boolean isFailed()
+    {
+        return UNSAFE.getIntVolatile(null, address + FAILED) != 0;
+    }
+
+    /**
+     * Stop writing reports to this ring. They are queued for
+     * <code>read()</code> again.
+     *
+     * @throws IOException
+     */
+    public void close() throws IOException
+    {
+        device.closeInputRing(this);
+    }
+}
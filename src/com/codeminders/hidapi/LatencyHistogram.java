@@ -0,0 +1,130 @@
+package com.codeminders.hidapi;
+
+/**
+ * A snapshot of a log-linear histogram of latencies in nanoseconds, see
+ * {@link HIDDevice#getLatencyHistogram(LatencyKind, boolean)}. Values
+ * below 64 ns are counted exactly; above, every power of two is split
+ * into 32 buckets, so a value is reported within about 3%.
+ * <p>
+ * The layout matches <code>struct hid_histogram</code> in hidapi.h.
+ */
+public final class LatencyHistogram
+{
+    /* The count, total and max come before the buckets. */
+    static final int HEADER = 3;
+    static final int BUCKETS = 1152;
+    private static final int SUB_BUCKETS = 32;
+
+    private final long[] values;
+
+    LatencyHistogram(long[] values)
+    {
+        this.values = values;
+    }
+
+    /**
+     * @return the number of values recorded
+     */
+    public long getCount()
+    {
+        return values[0];
+    }
+
+    /**
+     * @return the largest value recorded, in nanoseconds
+     */
+    public long getMax()
+    {
+        return values[2];
+    }
+
+    /**
+     * @return the mean of the values recorded, in nanoseconds, or 0
+     *         if there are none
+     */
+    public double getMean()
+    {
+        return getCount() == 0 ? 0 : (double) values[1] / getCount();
+    }
+
+    /**
+     * Get the value below which a given percentage of the values
+     * recorded fall.
+     *
+     * @param percentile the percentage, from 0 to 100
+     * @return the lowest value of the bucket holding that percentile,
+     *         in nanoseconds, or 0 if no values were recorded
+     */
+    public long getValueAtPercentile(double percentile)
+    {
+        long count = getCount();
+        if(count == 0)
+            return 0;
+        long rank = (long) Math.ceil(percentile / 100 * count);
+        if(rank < 1)
+            rank = 1;
+
+        long seen = 0;
+        for(int i=0; i<BUCKETS; i++)
+        {
+            seen += values[HEADER + i];
+            if(seen >= rank)
+                return Math.min(getBucketValue(i), getMax());
+        }
+        return getMax();
+    }
+
+    /**
+     * @return the number of buckets
+     */
+    public int getNumberOfBuckets()
+    {
+        return BUCKETS;
+    }
+
+    /**
+     * @param bucket a bucket index
+     * @return the number of values counted in the bucket
+     */
+    public long getBucketCount(int bucket)
+    {
+        return values[HEADER + bucket];
+    }
+
+    /**
+     * @param bucket a bucket index
+     * @return the lowest value counted in the bucket, in nanoseconds
+     */
+    public static long getBucketValue(int bucket)
+    {
+        if(bucket < 2 * SUB_BUCKETS)
+            return bucket;
+        int e = bucket / SUB_BUCKETS - 1;
+        return (long) (bucket - e * SUB_BUCKETS) << e;
+    }
+
+    /**
+     *  Override method for conversion this object to <code>String<code> object.
+     *
+     * @return return a reference to the <code>String<code> object
+     */
+    @Override
+    public String toString()
+    {
+        StringBuilder builder = new StringBuilder();
+        builder.append("LatencyHistogram [count=");
+        builder.append(getCount());
+        builder.append(", mean=");
+        builder.append((long) getMean());
+        builder.append(", p50=");
+        builder.append(getValueAtPercentile(50));
+        builder.append(", p99=");
+        builder.append(getValueAtPercentile(99));
+        builder.append(", p99.9=");
+        builder.append(getValueAtPercentile(99.9));
+        builder.append(", max=");
+        builder.append(getMax());
+        builder.append("]");
+        return builder.toString();
+    }
+}
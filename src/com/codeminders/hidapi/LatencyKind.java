@@ -0,0 +1,23 @@
+package com.codeminders.hidapi;
+
+/**
+ * The latencies a device keeps histograms of. See
+ * {@link HIDDevice#getLatencyHistogram(LatencyKind, boolean)}.
+ * <p>
+ * The ordinals match the <code>hid_latency</code> values in hidapi.h.
+ */
+public enum LatencyKind
+{
+    /**
+     * From an Input report's arrival until it is read. Only recorded
+     * by the libusb backend and the hidraw io_uring engine, and not
+     * for reports taken from an {@link InputRing}.
+     */
+    INPUT,
+
+    /** The duration of successful writes. */
+    WRITE,
+
+    /** The duration of successful Feature report transfers, in either direction. */
+    FEATURE
+}
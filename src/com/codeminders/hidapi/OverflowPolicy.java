@@ -0,0 +1,31 @@
+package com.codeminders.hidapi;
+
+/**
+ * What a device's input report queue does when a report arrives and
+ * the queue is full. See {@link HIDDevice#setInputQueue(int, OverflowPolicy)}.
+ * <p>
+ * The ordinals match the <code>hid_queue_policy</code> values in hidapi.h.
+ */
+public enum OverflowPolicy
+{
+    /** Discard the oldest queued report to make room. This is the default. */
+    DROP_OLDEST,
+
+    /** Discard the report that just arrived. */
+    DROP_NEWEST,
+
+    /**
+     * Keep only the latest report for each Report ID: a new report
+     * replaces a queued one with the same ID, in its place in the
+     * queue. Otherwise behaves like <code>DROP_OLDEST</code>. For a
+     * device whose report descriptor has no Report IDs, every report
+     * has the same ID, so only the latest one is queued.
+     */
+    KEEP_LATEST_PER_REPORT_ID,
+
+    /**
+     * Grow the queue as needed up to the capacity given, then behave
+     * like <code>DROP_OLDEST</code>.
+     */
+    GROW_TO_LIMIT
+}
@@ -251,6 +251,51 @@ int HID_API_EXPORT hid_exit(void)
 	return 0;
 }
 
+int HID_API_EXPORT HID_API_CALL hid_set_io_engine(int engine)
+{
+	/* Only the default engine on this platform. */
+	return (engine == HID_IO_ENGINE_DEFAULT)? 0: -1;
+}
+
+int HID_API_EXPORT HID_API_CALL hid_set_backend(const char *name)
+{
+	/* This is the only implementation in the library. */
+	return (name && strcmp(name, "windows") == 0)? 0: -1;
+}
+
+HID_API_EXPORT const char * HID_API_CALL hid_get_backend(void)
+{
+	return "windows";
+}
+
+int HID_API_EXPORT HID_API_CALL hid_enumerate_backend(const char *backend, unsigned short vendor_id, unsigned short product_id, struct hid_device_info **devs)
+{
+	*devs = NULL;
+	if (backend && strcmp(backend, hid_get_backend()) != 0)
+		return -1;
+	*devs = hid_enumerate(vendor_id, product_id);
+	return 0;
+}
+
+hid_device * HID_API_EXPORT HID_API_CALL hid_open_path_backend(const char *backend, const char *path)
+{
+	if (backend && strcmp(backend, hid_get_backend()) != 0)
+		return NULL;
+	return hid_open_path(path);
+}
+
+HID_API_EXPORT const char * HID_API_CALL hid_get_device_backend(hid_device *dev)
+{
+	return hid_get_backend();
+}
+
+hid_reactor * HID_API_EXPORT HID_API_CALL hid_reactor_create_backend(const char *backend)
+{
+	if (backend && strcmp(backend, hid_get_backend()) != 0)
+		return NULL;
+	return hid_reactor_create();
+}
+
 struct hid_device_info HID_API_EXPORT * HID_API_CALL hid_enumerate(unsigned short vendor_id, unsigned short product_id)
 {
 	BOOL res;
@@ -393,6 +438,7 @@ struct hid_device_info HID_API_EXPORT * HID_API_CALL hid_enumerate(unsigned shor
 				root = tmp;
 			}
 			cur_dev = tmp;
+			cur_dev->backend = hid_get_backend();
 
 			// Get the Usage Page and Usage for this device.
 			res = HidD_GetPreparsedData(write_handle, &pp_data);
@@ -713,17 +759,156 @@ end_of_function:
 	return bytes_read;
 }
 
+int HID_API_EXPORT HID_API_CALL hid_read_timestamped(hid_device *dev, unsigned char *data, size_t length, unsigned long long *timestamp, int milliseconds)
+{
+	/* Not supported on this platform. */
+	return -1;
+}
+
+int HID_API_EXPORT HID_API_CALL hid_read_sequenced(hid_device *dev, unsigned char *data, size_t length, unsigned long long *sequence, unsigned long long *timestamp, int milliseconds)
+{
+	/* Not supported on this platform. */
+	return -1;
+}
+
+int HID_API_EXPORT HID_API_CALL hid_get_dropped_count(hid_device *dev, unsigned long long *count)
+{
+	/* Not supported on this platform. */
+	return -1;
+}
+
+int HID_API_EXPORT HID_API_CALL hid_get_stats(hid_device *dev, struct hid_device_stats *stats)
+{
+	/* Not supported on this platform. */
+	return -1;
+}
+
+int HID_API_EXPORT HID_API_CALL hid_get_latency_histogram(hid_device *dev, int kind, struct hid_histogram *histogram, int reset)
+{
+	/* Not supported on this platform. */
+	return -1;
+}
+
+int HID_API_EXPORT HID_API_CALL hid_read_many(hid_device *dev, unsigned char *data, size_t *length, int max_reports, int milliseconds)
+{
+	size_t used = 0;
+	int count = 0;
+	int res;
+
+	if (*length < 3 || max_reports < 1)
+		return -1;
+
+	res = hid_read_timeout(dev, data + 2, *length - 2, milliseconds);
+	while (res > 0) {
+		// hid_read_timeout() reports the full length even if it
+		// had to truncate the copy.
+		if ((size_t) res > *length - used - 2)
+			res = *length - used - 2;
+		data[used] = res & 0xff;
+		data[used+1] = (res >> 8) & 0xff;
+		used += 2 + res;
+		count++;
+
+		// Stop once another full-size report might not fit.
+		if (count == max_reports || used + 2 + dev->input_report_length > *length)
+			break;
+
+		// Take only reports that have already completed.
+		res = hid_read_timeout(dev, data + used + 2, *length - used - 2, 0);
+	}
+
+	*length = used;
+	return count > 0? count: res;
+}
+
 int HID_API_EXPORT HID_API_CALL hid_read(hid_device *dev, unsigned char *data, size_t length)
 {
 	return hid_read_timeout(dev, data, length, (dev->blocking)? -1: 0);
 }
 
+int HID_API_EXPORT HID_API_CALL hid_get_poll_fd(hid_device *dev)
+{
+	/* Not supported on this platform. */
+	return -1;
+}
+
+hid_reactor * HID_API_EXPORT HID_API_CALL hid_reactor_create(void)
+{
+	/* Not supported on this platform. */
+	return NULL;
+}
+
+int HID_API_EXPORT HID_API_CALL hid_reactor_add(hid_reactor *reactor, hid_device *dev)
+{
+	return -1;
+}
+
+int HID_API_EXPORT HID_API_CALL hid_reactor_remove(hid_reactor *reactor, hid_device *dev)
+{
+	return -1;
+}
+
+int HID_API_EXPORT HID_API_CALL hid_reactor_wait(hid_reactor *reactor, hid_device **ready, int max_ready, int milliseconds)
+{
+	return -1;
+}
+
+void HID_API_EXPORT HID_API_CALL hid_reactor_destroy(hid_reactor *reactor)
+{
+}
+
+hid_hotplug * HID_API_EXPORT HID_API_CALL hid_hotplug_create(unsigned short vendor_id, unsigned short product_id)
+{
+	/* Not supported on this platform. */
+	return NULL;
+}
+
+int HID_API_EXPORT HID_API_CALL hid_hotplug_wait(hid_hotplug *hotplug, struct hid_device_info **device, int milliseconds)
+{
+	*device = NULL;
+	return -1;
+}
+
+void HID_API_EXPORT HID_API_CALL hid_hotplug_destroy(hid_hotplug *hotplug)
+{
+}
+
 int HID_API_EXPORT HID_API_CALL hid_set_nonblocking(hid_device *dev, int nonblock)
 {
 	dev->blocking = !nonblock;
 	return 0; /* Success */
 }
 
+int HID_API_EXPORT HID_API_CALL hid_set_input_queue(hid_device *dev, int capacity, int policy)
+{
+	/* Reports are buffered by the HID class driver (see HidD_SetNumInputBuffers()). Not supported here. */
+	return -1;
+}
+
+int HID_API_EXPORT HID_API_CALL hid_set_input_transfers(hid_device *dev, int count)
+{
+	/* Not supported on this platform. */
+	return -1;
+}
+
+int HID_API_EXPORT HID_API_CALL hid_set_input_ring(hid_device *dev, struct hid_input_ring *ring, size_t size)
+{
+	/* Not supported on this platform. */
+	return -1;
+}
+
+int HID_API_EXPORT HID_API_CALL hid_input_ring_wait(hid_device *dev, int milliseconds)
+{
+	/* Not supported on this platform. */
+	return -1;
+}
+
+int HID_API_EXPORT HID_API_CALL hid_input_ring_read(hid_device *dev, unsigned char *data, size_t length, unsigned long long *timestamp, int milliseconds)
+{
+	/* Not supported on this platform. */
+	return -1;
+}
+
 int HID_API_EXPORT HID_API_CALL hid_send_feature_report(hid_device *dev, const unsigned char *data, size_t length)
 {
 	BOOL res = HidD_SetFeature(dev->device_handle, (PVOID)data, length);